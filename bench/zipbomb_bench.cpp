@@ -0,0 +1,588 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 基准测试
+ *
+ * 功能: 测量各核心环节（CRC-32、模式生成、DEFLATE压缩、常量流直接编码、
+ *       DEFLATE解压、条目写出、归档检查、一致性扫描）在不同输入大小和内容模式下的
+ *       吞吐量，以及按目标大小和条目数组合的端到端生成速度；结果输出为JSON
+ * 用法: zipbomb_bench [--quick] [--output 文件] [--filter 子串]
+ *                     [--baseline 文件 [--threshold 百分比]]
+ *       指定--baseline时与之前保存的结果比较，任一项吞吐量下降超过
+ *       阈值（默认10%）即以状态1退出
+ * 说明: 每项至少运行到最短时间后取各次迭代的中位数；内存分配次数通过
+ *       替换全局operator new统计（不含C代码中的malloc）；峰值RSS是
+ *       进程到该项结束为止的最大值，因此各项按规模从小到大排列
+ * ============================================================================
+ */
+
+#include "zipbomb.h"
+#include "zipbomb_inspect.h"
+#include "crc32.h"
+#include "deflate.h"
+#include "inflate.h"
+#include "output_sink.h"
+#include "pattern_source.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+// ============================================================================
+// 内存分配计数
+// ============================================================================
+
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace ZipBombGenerator;
+
+// ============================================================================
+// 测量
+// ============================================================================
+
+/**
+ * 一项基准测试的结果
+ */
+struct BenchResult {
+    std::string name;
+    std::string group;              // "kernel"或"e2e"
+    uint64_t bytes = 0;             // 每次迭代处理的字节数
+    uint64_t iterations = 0;
+    double ns_per_byte = 0.0;       // 各次迭代的中位数
+    double mb_per_sec = 0.0;
+    double allocations = 0.0;       // 每次迭代的operator new次数
+    uint64_t peak_rss_bytes = 0;
+};
+
+struct BenchOptions {
+    bool quick = false;
+    std::string output;
+    std::string filter;
+    std::string baseline;
+    double threshold = 10.0;        // 允许的吞吐量下降(%)
+};
+
+/** 进程的峰值常驻内存(字节) */
+uint64_t peak_rss_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options) : options_(options) {}
+
+    /**
+     * 运行一项测试：至少min_iterations次，且累计时间达到最短时间
+     *
+     * @param bytes 每次迭代处理的字节数，用于换算吞吐量
+     * @param body 一次迭代
+     */
+    void run(const std::string& group, const std::string& name, uint64_t bytes,
+             const std::function<void()>& body, uint64_t min_iterations = 3) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+
+        const double min_seconds = options_.quick ? 0.05 : 0.3;
+        body();  // 预热：建立缓存、页表和码表
+
+        std::vector<double> samples;
+        double total = 0.0;
+        const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+        while (samples.size() < min_iterations || total < min_seconds) {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            samples.push_back(seconds);
+            total += seconds;
+        }
+        const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+        std::sort(samples.begin(), samples.end());
+        const double median = samples[samples.size() / 2];
+
+        BenchResult result;
+        result.name = name;
+        result.group = group;
+        result.bytes = bytes;
+        result.iterations = samples.size();
+        result.ns_per_byte = median * 1e9 / static_cast<double>(bytes);
+        result.mb_per_sec = static_cast<double>(bytes) / (1024.0 * 1024.0) / median;
+        result.allocations = static_cast<double>(allocations) / static_cast<double>(samples.size());
+        result.peak_rss_bytes = peak_rss_bytes();
+        results_.push_back(result);
+
+        std::cerr << std::left << std::setw(44) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << result.mb_per_sec << " MB/s"
+                  << std::setprecision(3) << std::setw(10) << result.ns_per_byte << " ns/B"
+                  << std::setprecision(1) << std::setw(10) << result.allocations << " allocs" << std::endl;
+    }
+
+    bool quick() const { return options_.quick; }
+    const std::vector<BenchResult>& results() const { return results_; }
+
+private:
+    const BenchOptions& options_;
+    std::vector<BenchResult> results_;
+};
+
+/** 丢弃所有输出的压缩器目标 */
+class NullByteSink : public ByteSink {
+public:
+    bool write(const uint8_t* data, size_t len) override {
+        (void)data;
+        total_ += len;
+        return true;
+    }
+    uint64_t total() const { return total_; }
+
+private:
+    uint64_t total_ = 0;
+};
+
+/** 把输出收集到内存的压缩器目标 */
+class BufferByteSink : public ByteSink {
+public:
+    bool write(const uint8_t* data, size_t len) override {
+        data_.insert(data_.end(), data, data + len);
+        return true;
+    }
+    const std::vector<uint8_t>& data() const { return data_; }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+/** 丢弃所有输出的生成回调 */
+int discard_output(const uint8_t* data, size_t len, void* user_data) {
+    (void)data;
+    *static_cast<uint64_t*>(user_data) += len;
+    return 0;
+}
+
+struct PatternKind {
+    int kind;
+    const char* name;
+};
+
+const PatternKind PATTERN_KINDS[] = {
+    {ZIPBOMB_PATTERN_MARKED, "marked"},
+    {ZIPBOMB_PATTERN_CONSTANT, "constant"},
+    {ZIPBOMB_PATTERN_PERIODIC, "periodic"},
+    {ZIPBOMB_PATTERN_RANDOM, "random"},
+    {ZIPBOMB_PATTERN_MIXED, "mixed"},
+};
+
+/** 以KB/MB/GB为单位的大小标签 */
+std::string size_label(uint64_t bytes) {
+    if (bytes >= (1ULL << 30) && bytes % (1ULL << 30) == 0) return std::to_string(bytes >> 30) + "G";
+    if (bytes >= (1ULL << 20) && bytes % (1ULL << 20) == 0) return std::to_string(bytes >> 20) + "M";
+    return std::to_string(bytes >> 10) + "K";
+}
+
+// ============================================================================
+// 核心环节
+// ============================================================================
+
+void bench_crc32(BenchRunner& runner) {
+    const std::vector<uint64_t> sizes = runner.quick() ? std::vector<uint64_t>{4096, 1 << 20}
+                                                       : std::vector<uint64_t>{4096, 64 << 10, 1 << 20, 16 << 20};
+    for (uint64_t size : sizes) {
+        std::vector<uint8_t> data(static_cast<size_t>(size));
+        for (size_t i = 0; i < data.size(); i++) data[i] = static_cast<uint8_t>(i * 131 + (i >> 8));
+        volatile uint32_t sink = 0;
+        runner.run("kernel", "crc32/" + size_label(size), size, [&] {
+            sink = crc32_update(0, data.data(), data.size());
+        });
+    }
+}
+
+void bench_pattern_fill(BenchRunner& runner) {
+    const uint64_t size = runner.quick() ? (1 << 20) : (16 << 20);
+    std::vector<uint8_t> buffer(64 * 1024);
+    for (const PatternKind& kind : PATTERN_KINDS) {
+        zipbomb_config_t config = get_default_config();
+        config.pattern_kind = kind.kind;
+        const std::unique_ptr<PatternSource> source = make_pattern_source(config, size, 1);
+        runner.run("kernel", std::string("pattern_fill/") + kind.name + "/" + size_label(size), size, [&] {
+            for (uint64_t pos = 0; pos < size; pos += buffer.size()) {
+                source->fill(pos, buffer.data(), static_cast<size_t>(std::min<uint64_t>(buffer.size(), size - pos)));
+            }
+        });
+    }
+}
+
+void bench_deflate(BenchRunner& runner) {
+    const std::vector<uint64_t> sizes = runner.quick() ? std::vector<uint64_t>{64 << 10, 1 << 20}
+                                                       : std::vector<uint64_t>{64 << 10, 1 << 20, 4 << 20};
+    const std::vector<int> levels = runner.quick() ? std::vector<int>{6} : std::vector<int>{1, 6, 9};
+    for (const PatternKind& kind : PATTERN_KINDS) {
+        for (uint64_t size : sizes) {
+            // 内容预先生成，只测量压缩本身
+            zipbomb_config_t config = get_default_config();
+            config.pattern_kind = kind.kind;
+            std::vector<uint8_t> data(static_cast<size_t>(size));
+            make_pattern_source(config, size, 1)->fill(0, data.data(), data.size());
+            for (int level : levels) {
+                runner.run("kernel", std::string("deflate/") + kind.name + "/" + size_label(size) +
+                           "/level" + std::to_string(level), size, [&] {
+                    NullByteSink out;
+                    DeflateEncoder encoder(out, level);
+                    encoder.write(data.data(), data.size());
+                    encoder.finish();
+                }, 1);
+            }
+        }
+    }
+}
+
+void bench_constant_run(BenchRunner& runner) {
+    const std::vector<uint64_t> sizes = runner.quick() ? std::vector<uint64_t>{1ULL << 30}
+                                                       : std::vector<uint64_t>{1 << 20, 1ULL << 30, 64ULL << 30};
+    for (uint64_t size : sizes) {
+        runner.run("kernel", "deflate_constant_run/" + size_label(size), size, [&] {
+            NullByteSink out;
+            deflate_constant_run(out, 'A', size);
+        });
+    }
+}
+
+/**
+ * DEFLATE解压：解压本项目压缩器的输出和常量流，吞吐量按解压出的字节计算
+ */
+void bench_inflate(BenchRunner& runner) {
+    const uint64_t size = runner.quick() ? (1 << 20) : (4 << 20);
+    InflateDecoder decoder;
+    for (const PatternKind& kind : PATTERN_KINDS) {
+        zipbomb_config_t config = get_default_config();
+        config.pattern_kind = kind.kind;
+        std::vector<uint8_t> data(static_cast<size_t>(size));
+        make_pattern_source(config, size, 1)->fill(0, data.data(), data.size());
+        BufferByteSink compressed;
+        DeflateEncoder encoder(compressed, 6);
+        encoder.write(data.data(), data.size());
+        encoder.finish();
+        runner.run("kernel", std::string("inflate/") + kind.name + "/" + size_label(size), size, [&] {
+            NullByteSink out;
+            decoder.inflate(compressed.data().data(), compressed.data().size(), out);
+        });
+    }
+
+    const uint64_t run_size = 1ULL << 30;
+    BufferByteSink run;
+    deflate_constant_run(run, 'A', run_size);
+    runner.run("kernel", "inflate/constant_run/" + size_label(run_size), run_size, [&] {
+        NullByteSink out;
+        decoder.inflate(run.data().data(), run.data().size(), out);
+    });
+}
+
+/**
+ * 条目写出：本地头按值写、压缩数据按引用写，与生成器写条目的方式相同，
+ * 输出到/dev/null，测量输出端聚集和系统调用的开销
+ */
+void bench_entry_write(BenchRunner& runner) {
+    const std::vector<uint64_t> payload_sizes = runner.quick() ? std::vector<uint64_t>{2838}
+                                                               : std::vector<uint64_t>{64, 2838, 1 << 20};
+    const uint64_t total = runner.quick() ? (64 << 20) : (256 << 20);
+    for (uint64_t payload_size : payload_sizes) {
+        const std::vector<uint8_t> payload(static_cast<size_t>(payload_size), 0x5A);
+        uint8_t header[30 + 16] = {};
+        const uint64_t entries = std::max<uint64_t>(1, total / (payload_size + sizeof(header)));
+        const uint64_t bytes = entries * (payload_size + sizeof(header));
+        runner.run("kernel", "entry_write/" + std::to_string(payload_size) + "B", bytes, [&] {
+            const int fd = open("/dev/null", O_WRONLY);
+            FdSink sink(fd, true);
+            for (uint64_t i = 0; i < entries; i++) {
+                sink.write(header, sizeof(header));
+                sink.write_ref(payload.data(), payload.size());
+            }
+            sink.close();
+        });
+    }
+}
+
+/**
+ * 归档快速检查：对本工具生成的归档只解析中央目录，吞吐量按归档大小计算
+ */
+void bench_inspect(BenchRunner& runner) {
+    struct Fixture {
+        uint64_t target;
+        uint64_t entries;
+    };
+    std::vector<Fixture> fixtures = {{64ULL << 20, 64}, {64ULL << 20, 65536}};
+    if (!runner.quick()) fixtures.push_back({1ULL << 30, 100000});
+
+    for (const Fixture& f : fixtures) {
+        zipbomb_config_t config = get_default_config();
+        config.target_size_bytes = static_cast<int64_t>(f.target);
+        config.max_entries = 0;
+        config.pattern_kind = ZIPBOMB_PATTERN_CONSTANT;
+        config.pattern_size = static_cast<int>(f.target / f.entries);
+        zipbomb_buffer_t archive = {};
+        if (create_zipbomb_to_buffer(&config, &archive) != ZIPBOMB_SUCCESS) {
+            std::cerr << "生成检查用归档失败" << std::endl;
+            std::exit(2);
+        }
+        const uint64_t size = static_cast<uint64_t>(archive.size);
+        runner.run("kernel", "inspect/" + std::to_string(f.entries) + "_entries", size, [&] {
+            zipbomb_inspect_report_t report;
+            if (zipbomb_inspect_buffer(archive.data, static_cast<size_t>(size), nullptr, &report) != ZIPBOMB_SUCCESS) {
+                std::cerr << "检查失败" << std::endl;
+                std::exit(2);
+            }
+        });
+        zipbomb_buffer_free(&archive);
+    }
+}
+
+/**
+ * 一致性扫描：内容不可压缩的归档，数据全部要读一遍，吞吐量按归档大小计算
+ */
+void bench_scan(BenchRunner& runner) {
+    const uint64_t target = runner.quick() ? (16ULL << 20) : (256ULL << 20);
+    zipbomb_config_t config = get_default_config();
+    config.target_size_bytes = static_cast<int64_t>(target);
+    config.max_entries = 0;
+    config.pattern_kind = ZIPBOMB_PATTERN_RANDOM;
+    config.pattern_size = static_cast<int>(target / 64);
+    zipbomb_buffer_t archive = {};
+    if (create_zipbomb_to_buffer(&config, &archive) != ZIPBOMB_SUCCESS) {
+        std::cerr << "生成扫描用归档失败" << std::endl;
+        std::exit(2);
+    }
+    const uint64_t size = static_cast<uint64_t>(archive.size);
+    runner.run("kernel", std::string("scan/") + zipbomb_scan_implementation() + "/" + size_label(target), size, [&] {
+        zipbomb_scan_report_t report;
+        if (zipbomb_scan_buffer(archive.data, static_cast<size_t>(size), &report) != ZIPBOMB_SUCCESS ||
+            report.findings) {
+            std::cerr << "扫描失败" << std::endl;
+            std::exit(2);
+        }
+    });
+    zipbomb_buffer_free(&archive);
+}
+
+// ============================================================================
+// 端到端
+// ============================================================================
+
+/**
+ * 按目标大小和条目数组合生成完整归档，输出交给丢弃数据的回调，
+ * 不受磁盘速度影响；吞吐量按目标解压大小计算
+ */
+void bench_end_to_end(BenchRunner& runner) {
+    struct Case {
+        uint64_t target;
+        uint64_t entries;
+        int kind;
+        const char* kind_name;
+    };
+    std::vector<Case> cases = {
+        {64ULL << 20, 1, ZIPBOMB_PATTERN_MARKED, "marked"},
+        {64ULL << 20, 1000, ZIPBOMB_PATTERN_MARKED, "marked"},
+        {64ULL << 20, 65536, ZIPBOMB_PATTERN_MARKED, "marked"},
+        {64ULL << 20, 1000, ZIPBOMB_PATTERN_CONSTANT, "constant"},
+    };
+    if (!runner.quick()) {
+        cases.push_back({1ULL << 30, 1, ZIPBOMB_PATTERN_MARKED, "marked"});
+        cases.push_back({1ULL << 30, 1000, ZIPBOMB_PATTERN_MARKED, "marked"});
+        cases.push_back({1ULL << 30, 65536, ZIPBOMB_PATTERN_MARKED, "marked"});
+        cases.push_back({16ULL << 30, 1, ZIPBOMB_PATTERN_CONSTANT, "constant"});
+        cases.push_back({16ULL << 30, 65536, ZIPBOMB_PATTERN_CONSTANT, "constant"});
+    }
+
+    zipbomb_ctx_t* ctx = zipbomb_ctx_create();
+    if (!ctx) return;
+    for (const Case& c : cases) {
+        zipbomb_config_t config = get_default_config();
+        config.target_size_bytes = static_cast<int64_t>(c.target);
+        config.max_entries = 0;
+        config.pattern_kind = c.kind;
+        config.pattern_size = static_cast<int>(std::min<uint64_t>(c.target / c.entries, INT32_MAX));
+        zipbomb_ctx_configure(ctx, &config);
+
+        runner.run("e2e", std::string("e2e/") + c.kind_name + "/" + size_label(c.target) + "/" +
+                   std::to_string(c.entries) + "_entries", c.target, [&] {
+            uint64_t written = 0;
+            if (zipbomb_ctx_generate_to_callback(ctx, discard_output, &written) != ZIPBOMB_SUCCESS) {
+                std::cerr << "生成失败" << std::endl;
+                std::exit(2);
+            }
+        }, 1);
+    }
+    zipbomb_ctx_destroy(ctx);
+}
+
+// ============================================================================
+// 结果输出与比较
+// ============================================================================
+
+/** 每项结果占一行，比较模式按行读回 */
+std::string format_results(const std::vector<BenchResult>& results, bool quick) {
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "{\n  \"schema\": 1,\n  \"quick\": " << (quick ? "true" : "false") << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"group\": \"" << r.group << "\""
+            << ", \"bytes\": " << r.bytes
+            << ", \"iterations\": " << r.iterations
+            << ", \"mb_per_sec\": " << r.mb_per_sec
+            << ", \"ns_per_byte\": " << r.ns_per_byte
+            << ", \"allocations\": " << r.allocations
+            << ", \"peak_rss_bytes\": " << r.peak_rss_bytes << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+/**
+ * 读取之前保存的结果，返回名称到吞吐量(MB/s)的映射
+ */
+bool load_baseline(const std::string& filename, std::map<std::string, double>& throughput) {
+    std::ifstream in(filename);
+    if (!in) return false;
+    const std::string name_key = "\"name\": \"";
+    const std::string rate_key = "\"mb_per_sec\": ";
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t name_pos = line.find(name_key);
+        const size_t rate_pos = line.find(rate_key);
+        if (name_pos == std::string::npos || rate_pos == std::string::npos) continue;
+        const size_t name_start = name_pos + name_key.size();
+        const size_t name_end = line.find('"', name_start);
+        if (name_end == std::string::npos) continue;
+        throughput[line.substr(name_start, name_end - name_start)] =
+            std::strtod(line.c_str() + rate_pos + rate_key.size(), nullptr);
+    }
+    return true;
+}
+
+/**
+ * 与基准结果比较
+ *
+ * @return 有退化项时返回false
+ */
+bool compare_with_baseline(const std::vector<BenchResult>& results, const std::string& filename,
+                           double threshold) {
+    std::map<std::string, double> baseline;
+    if (!load_baseline(filename, baseline)) {
+        std::cerr << "无法读取基准结果: " << filename << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    std::cerr << std::endl << "=== 与基准比较 (阈值 " << threshold << "%) ===" << std::endl;
+    for (const BenchResult& r : results) {
+        const auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0.0) continue;
+        const double change = (r.mb_per_sec / it->second - 1.0) * 100.0;
+        const bool regressed = change < -threshold;
+        if (regressed) ok = false;
+        std::cerr << (regressed ? "退化 " : "     ") << std::left << std::setw(44) << r.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(12) << it->second << " -> "
+                  << std::setw(12) << r.mb_per_sec << " MB/s (" << std::showpos << change
+                  << std::noshowpos << "%)" << std::endl;
+    }
+    return ok;
+}
+
+void print_usage(const char* program) {
+    std::cerr << "用法: " << program
+              << " [--quick] [--output 文件] [--filter 子串] [--baseline 文件 [--threshold 百分比]]"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            options.baseline = argv[++i];
+        } else if (arg == "--threshold" && has_value) {
+            options.threshold = std::strtod(argv[++i], nullptr);
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::cerr << "CRC-32实现: " << crc32_implementation()
+              << ", 模式生成实现: " << pattern_implementation() << std::endl;
+
+    BenchRunner runner(options);
+    bench_crc32(runner);
+    bench_pattern_fill(runner);
+    bench_deflate(runner);
+    bench_constant_run(runner);
+    bench_inflate(runner);
+    bench_entry_write(runner);
+    bench_inspect(runner);
+    bench_scan(runner);
+    bench_end_to_end(runner);
+
+    const std::string json = format_results(runner.results(), options.quick);
+    if (options.output.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(options.output);
+        out << json;
+        if (!out.flush()) {
+            std::cerr << "无法写入结果文件: " << options.output << std::endl;
+            return 2;
+        }
+    }
+
+    if (!options.baseline.empty() && !compare_with_baseline(runner.results(), options.baseline,
+                                                            options.threshold)) {
+        return 1;
+    }
+    return 0;
+}
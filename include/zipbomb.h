@@ -12,6 +12,7 @@
 #define ZIPBOMB_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 #include <iostream>
@@ -26,9 +27,42 @@ extern "C" {
 
 /** 默认压缩配置 */
 #define DEFAULT_TARGET_SIZE_MB      10240    // 默认目标大小: 10GB
+#define DEFAULT_TARGET_SIZE_BYTES   ((int64_t)DEFAULT_TARGET_SIZE_MB * 1024 * 1024)
+#define MAX_TARGET_SIZE_BYTES       ((int64_t)1 << 50)  // 目标大小上限: 1PB
 #define DEFAULT_COMPRESSION_LEVEL   6        // 默认压缩级别: 中等
 #define DEFAULT_PATTERN_SIZE        1048576  // 默认模式大小: 1MB
+#define DEFAULT_MAX_ENTRIES         1000     // 默认条目数上限
+#define MAX_NESTED_LEVELS           32       // 嵌套层数上限
 #define MAX_FILENAME_LENGTH         512      // 最大文件名长度
+#define DEFAULT_PATTERN_PERIOD      4096     // 周期文本的默认周期(字节)
+#define MIN_DEFLATE_CHUNK_SIZE      65536    // 分块并行压缩的最小块大小(字节)
+#define MAX_IO_QUEUE_DEPTH          256      // I/O队列深度上限
+#define MAX_THREAD_COUNT            256      // 工作线程数上限
+
+/** 输出模式 */
+#define ZIPBOMB_OUTPUT_SYNC         0        // 同步聚集写(writev/pwritev)
+#define ZIPBOMB_OUTPUT_ASYNC        1        // 异步写，优先io_uring，不可用时使用线程池
+#define ZIPBOMB_OUTPUT_ASYNC_THREADS 2       // 异步写，强制使用线程池+pwrite
+#define ZIPBOMB_OUTPUT_MMAP         3        // 按规划大小映射文件，多线程直接写入
+
+/** 条目内容模式 */
+#define ZIPBOMB_PATTERN_MARKED      0        // 重复字符，每1KB一个"ZIP"标记
+#define ZIPBOMB_PATTERN_CONSTANT    1        // 全部为同一字节
+#define ZIPBOMB_PATTERN_PERIODIC    2        // 以pattern_period字节为周期重复的伪随机文本
+#define ZIPBOMB_PATTERN_RANDOM      3        // 由pattern_seed决定的伪随机可压缩文本(约4比特/字节)
+#define ZIPBOMB_PATTERN_MIXED       4        // 重复短语中夹杂少量随机字节的低熵数据
+
+/** 生成阶段(zipbomb_stats_t.phases的下标) */
+#define ZIPBOMB_PHASE_PATTERN       0        // 模式源生成条目内容
+#define ZIPBOMB_PHASE_COMPRESS      1        // DEFLATE压缩
+#define ZIPBOMB_PHASE_CRC           2        // CRC-32计算
+#define ZIPBOMB_PHASE_WRITE         3        // 写入输出端（含系统调用）
+#define ZIPBOMB_PHASE_CENTRAL_DIR   4        // 构建和序列化中央目录
+#define ZIPBOMB_PHASE_COUNT         5
+
+/** 统计导出格式 */
+#define ZIPBOMB_STATS_JSON          0        // JSON对象
+#define ZIPBOMB_STATS_PROMETHEUS    1        // Prometheus文本格式
 
 /** 错误代码 */
 #define ZIPBOMB_SUCCESS             0        // 成功
@@ -37,6 +71,9 @@ extern "C" {
 #define ZIPBOMB_ERROR_COMPRESS_FAIL -3       // 压缩失败
 #define ZIPBOMB_ERROR_INVALID_PARAM -4       // 参数无效
 #define ZIPBOMB_ERROR_MEMORY_ALLOC  -5       // 内存分配失败
+#define ZIPBOMB_ERROR_BUFFER_TOO_SMALL -6    // 调用方提供的缓冲区放不下归档
+#define ZIPBOMB_ERROR_FILE_READ     -7       // 文件无法打开或读取
+#define ZIPBOMB_ERROR_MALFORMED     -8       // 归档结构损坏或不受支持
 
 // ============================================================================
 // 结构体定义
@@ -46,14 +83,115 @@ extern "C" {
  * ZIP炸弹配置结构体
  */
 typedef struct {
-    int target_size_mb;           // 目标解压大小(MB)
+    int64_t target_size_bytes;    // 目标解压大小(字节)，超过4GB时自动使用ZIP64
     int compression_level;        // 压缩级别(1-9)
     int pattern_size;             // 重复模式大小(字节)
     char pattern_char;            // 重复字符
     bool use_nested_compression;  // 是否使用嵌套压缩
-    int nested_levels;            // 嵌套层数
+    int nested_levels;            // 嵌套层数(含最内层)，每多一层外面再包一个只含内层归档的ZIP
+    int64_t max_entries;          // 条目数上限，超出时增大每个条目；0表示不限制
+    int output_mode;              // 输出模式(ZIPBOMB_OUTPUT_*)
+    int io_queue_depth;           // 异步模式下在途缓冲区个数，0使用默认值(8)
+    bool use_direct_io;           // 异步模式下尝试O_DIRECT绕过页缓存
+    int thread_count;             // 工作线程数，0表示使用全部硬件线程
+    int64_t pattern_variants;     // 不同条目内容的份数，条目循环使用；1表示全部相同，0表示每个条目都不同
+    int pattern_kind;             // 条目内容模式(ZIPBOMB_PATTERN_*)
+    int64_t pattern_period;       // 周期文本的周期(字节)，0使用默认值；可以超过32KB的DEFLATE窗口
+    uint64_t pattern_seed;        // 伪随机模式的种子
+    int64_t deflate_chunk_size;   // 单个条目按此大小(字节)分块并行压缩，0表示不分块
+    bool use_data_descriptor;     // 流式输出：本地头不含CRC和大小，改在数据之后写数据描述符(通用标志第3位)
 } zipbomb_config_t;
 
+/**
+ * 内存输出缓冲区(create_zipbomb_to_buffer使用)
+ *
+ * data为NULL时由库分配并按需增长，owned随之置为true，用完后调用
+ * zipbomb_buffer_free()释放；owned的缓冲区可以直接用于下一次生成。
+ * 调用方提供的缓冲区(owned为false)容量固定为capacity
+ */
+typedef struct {
+    uint8_t* data;                // 缓冲区
+    int64_t size;                 // 归档字节数，可能超过capacity
+    int64_t capacity;             // 缓冲区容量
+    bool owned;                   // 是否由库分配
+} zipbomb_buffer_t;
+
+/**
+ * 流式输出回调
+ *
+ * @param data 归档的下一段数据，回调返回后即失效
+ * @param len 字节数
+ * @param user_data 调用方传入的指针
+ * @return 0继续，非0中止生成
+ */
+typedef int (*zipbomb_write_callback_t)(const uint8_t* data, size_t len, void* user_data);
+
+/**
+ * 输出I/O统计
+ */
+typedef struct {
+    char backend[16];             // "sync"、"io_uring"、"threads"、"mmap"、"memory" 或 "callback"
+    uint64_t writes_submitted;    // 提交的写请求数（mmap模式为回写窗口数）
+    uint64_t bytes_written;       // 写入字节数
+    uint32_t max_queue_depth;     // 观察到的最大在途请求数
+    uint64_t stall_ns;            // 生成线程等待I/O的总时间(纳秒)
+    bool direct_io;               // 是否实际启用了O_DIRECT
+} zipbomb_io_stats_t;
+
+/**
+ * 生成上下文（不透明句柄）
+ *
+ * 每个上下文有自己的配置、日志开关和统计，不同上下文可以在不同线程上
+ * 同时生成；同一个上下文同一时刻只能由一个线程使用。
+ * 不带上下文的接口共用一个进程级的默认上下文，不能并发调用
+ */
+typedef struct zipbomb_ctx zipbomb_ctx_t;
+
+/**
+ * 单个生成阶段的统计
+ *
+ * 压缩、模式生成和CRC在多个线程上并发执行时，耗时是各线程之和
+ */
+typedef struct {
+    uint64_t time_ns;             // 耗时(纳秒)
+    uint64_t bytes_in;            // 读入字节数
+    uint64_t bytes_out;           // 产出字节数
+    uint64_t calls;               // 调用次数；写入阶段为系统调用（mmap模式为回写窗口）数
+    double mb_in_per_sec;         // 输入吞吐量(MB/s)，耗时为0时为0
+    double mb_out_per_sec;        // 输出吞吐量(MB/s)
+} zipbomb_phase_stats_t;
+
+/**
+ * 一次生成的统计
+ */
+typedef struct {
+    double processing_time;       // 生成耗时(秒)
+    double compression_ratio;     // 归档大小/目标解压大小
+    int64_t archive_size;         // 归档字节数
+    zipbomb_io_stats_t io;        // 输出I/O统计
+    uint64_t wall_time_ns;        // 生成耗时(纳秒)
+    uint64_t peak_buffer_bytes;   // 模式块、压缩结果和中央目录缓冲区同时占用的峰值(字节)
+    zipbomb_phase_stats_t phases[ZIPBOMB_PHASE_COUNT];  // 按ZIPBOMB_PHASE_*索引
+} zipbomb_stats_t;
+
+/**
+ * 归档规划结果，所有大小均为精确值
+ */
+typedef struct {
+    int64_t num_entries;              // 条目数
+    int64_t distinct_payloads;        // 不同条目内容的份数
+    int64_t entry_uncompressed_size;  // 每个条目的原始大小
+    int64_t entry_compressed_size;    // 第一个条目的压缩后大小（内容全部相同时即每个条目）
+    uint32_t entry_crc32;             // 第一个条目的CRC-32
+    bool zip64;                       // 是否使用ZIP64
+    int64_t total_uncompressed_size;  // 解压后总大小
+    int64_t central_dir_offset;       // 中央目录偏移
+    int64_t central_dir_size;         // 中央目录大小(不含结束记录)
+    int64_t total_size;               // 归档文件大小
+    double expansion_ratio;           // 膨胀倍数 (解压后总大小/归档大小)
+    bool data_descriptors;            // 条目是否带数据描述符
+} zipbomb_plan_t;
+
 /**
  * 文件信息结构体
  */
@@ -79,12 +217,111 @@ void create_zipbomb(const char* filename);
 /**
  * 使用自定义配置创建ZIP炸弹
  *
- * @param filename 输出文件名
+ * @param filename 输出文件名，"-"表示写到标准输出（此时只用同步写，日志改写到标准错误）
  * @param config 压缩配置
  * @return 成功返回0，失败返回错误代码
  */
 int create_zipbomb_with_config(const char* filename, const zipbomb_config_t* config);
 
+/**
+ * 把ZIP炸弹生成到内存缓冲区
+ *
+ * 条目内容全部相同时归档大小可预先规划，库分配的缓冲区一次分配到精确大小
+ *
+ * @param config 压缩配置，output_mode不起作用
+ * @param buffer 输出缓冲区，见zipbomb_buffer_t
+ * @return 成功返回0；调用方的缓冲区放不下时返回ZIPBOMB_ERROR_BUFFER_TOO_SMALL，
+ *         buffer->size为所需大小；其他失败返回错误代码
+ */
+int create_zipbomb_to_buffer(const zipbomb_config_t* config, zipbomb_buffer_t* buffer);
+
+/**
+ * 释放库分配的缓冲区，调用方提供的缓冲区不受影响
+ */
+void zipbomb_buffer_free(zipbomb_buffer_t* buffer);
+
+/**
+ * 生成ZIP炸弹并按顺序把数据块交给回调函数
+ *
+ * @param config 压缩配置，output_mode不起作用
+ * @param callback 输出回调，返回非0时中止并返回ZIPBOMB_ERROR_WRITE_FAILED
+ * @param user_data 原样传给回调
+ * @return 成功返回0，失败返回错误代码
+ */
+int create_zipbomb_to_callback(const zipbomb_config_t* config, zipbomb_write_callback_t callback,
+                               void* user_data);
+
+/**
+ * 创建生成上下文，配置为编译期默认值
+ *
+ * @return 失败返回NULL
+ */
+zipbomb_ctx_t* zipbomb_ctx_create(void);
+
+/**
+ * 销毁生成上下文
+ */
+void zipbomb_ctx_destroy(zipbomb_ctx_t* ctx);
+
+/**
+ * 设置上下文的配置（复制一份）
+ *
+ * @return 成功返回0；配置取值超出范围时返回ZIPBOMB_ERROR_INVALID_PARAM，原配置不变
+ */
+int zipbomb_ctx_configure(zipbomb_ctx_t* ctx, const zipbomb_config_t* config);
+
+/**
+ * 读取上下文的配置
+ *
+ * @return 成功返回0，失败返回错误代码
+ */
+int zipbomb_ctx_get_config(const zipbomb_ctx_t* ctx, zipbomb_config_t* config);
+
+/**
+ * 设置上下文的详细日志开关
+ */
+void zipbomb_ctx_set_verbose(zipbomb_ctx_t* ctx, int enable);
+
+/**
+ * 按上下文的配置生成到文件，参数同create_zipbomb_with_config
+ */
+int zipbomb_ctx_generate(zipbomb_ctx_t* ctx, const char* filename);
+
+/**
+ * 按上下文的配置生成到内存缓冲区，参数同create_zipbomb_to_buffer
+ */
+int zipbomb_ctx_generate_to_buffer(zipbomb_ctx_t* ctx, zipbomb_buffer_t* buffer);
+
+/**
+ * 按上下文的配置生成并交给回调函数，参数同create_zipbomb_to_callback
+ */
+int zipbomb_ctx_generate_to_callback(zipbomb_ctx_t* ctx, zipbomb_write_callback_t callback,
+                                     void* user_data);
+
+/**
+ * 读取上下文最近一次生成的统计
+ *
+ * @return 成功返回0，失败返回错误代码
+ */
+int zipbomb_ctx_get_stats(const zipbomb_ctx_t* ctx, zipbomb_stats_t* stats);
+
+/**
+ * 把上下文最近一次生成的统计导出到文件，参数同zipbomb_stats_export
+ */
+int zipbomb_ctx_export_stats(const zipbomb_ctx_t* ctx, const char* filename, int format);
+
+/**
+ * 把统计导出到文件
+ *
+ * 文件先写到"<filename>.tmp"再改名，抓取方不会读到不完整的内容
+ *
+ * @param stats 统计
+ * @param filename 输出文件名，"-"表示标准输出
+ * @param format 导出格式(ZIPBOMB_STATS_*)
+ * @return 成功返回0，失败返回错误代码
+ */
+int zipbomb_stats_export(const zipbomb_stats_t* stats, const char* filename, int format);
+
 /**
  * 设置压缩参数
  *
@@ -100,6 +337,50 @@ void set_compression_params(int target_size, int compression_level);
  */
 zipbomb_config_t get_default_config(void);
 
+/**
+ * 检查配置各字段的取值范围，不做任何压缩
+ *
+ * 生成、规划和zipbomb_ctx_configure()都用同一套检查拒绝无效配置
+ *
+ * @param config 压缩配置
+ * @return 配置有效时返回NULL，否则返回问题说明（静态字符串）
+ */
+const char* zipbomb_check_config(const zipbomb_config_t* config);
+
+/**
+ * 规划归档布局，不生成输出文件
+ *
+ * 每份不同的条目内容压缩一次以得到其压缩后大小和CRC（多份时并行），
+ * 其余全部按公式计算。嵌套配置（nested_levels > 1）的外层大小要压缩后才能确定，
+ * 不支持规划，需要估算时用zipbomb_plan_bound()
+ *
+ * @param config 压缩配置
+ * @param plan 输出的规划结果
+ * @return 成功返回0；配置无效或为嵌套配置时返回ZIPBOMB_ERROR_INVALID_PARAM
+ */
+int zipbomb_plan(const zipbomb_config_t* config, zipbomb_plan_t* plan);
+
+/**
+ * 不压缩任何内容，给出输出文件大小的上界
+ *
+ * 条目压缩后大小按DEFLATE的最坏情况计，只有一份常量内容时取精确值；
+ * 嵌套时逐层加上包装的最坏开销。用于预先检查磁盘空间
+ *
+ * @param config 压缩配置
+ * @param max_size 输出的大小上界(字节)
+ * @return 成功返回0，失败返回错误代码
+ */
+int zipbomb_plan_bound(const zipbomb_config_t* config, int64_t* max_size);
+
+/**
+ * 计算规划中第index个条目本地头的偏移
+ *
+ * @param plan zipbomb_plan()的结果
+ * @param index 条目序号，等于条目数时返回中央目录偏移
+ * @return 偏移(字节)；参数无效或条目内容不全相同时返回-1
+ */
+int64_t zipbomb_plan_entry_offset(const zipbomb_plan_t* plan, int64_t index);
+
 /**
  * 清理C++分配的资源
  */
@@ -216,6 +497,70 @@ int check_disk_space(const char* path, int64_t required_bytes);
  */
 const char* get_error_description(int error_code);
 
+// ============================================================================
+// CRC-32 校验
+// ============================================================================
+
+/**
+ * 增量计算CRC-32 (与zlib的crc32()结果一致)
+ *
+ * @param crc 之前的CRC值，首次调用传0
+ * @param data 数据
+ * @param len 数据长度(字节)
+ * @return 更新后的CRC值
+ */
+uint32_t zipbomb_crc32(uint32_t crc, const void* data, size_t len);
+
+/**
+ * 合并两段数据的CRC-32
+ *
+ * @param crc1 前一段数据的CRC
+ * @param crc2 后一段数据的CRC
+ * @param len2 后一段数据的长度(字节)
+ * @return 拼接后数据的CRC，耗时O(log len2)
+ */
+uint32_t zipbomb_crc32_combine(uint32_t crc1, uint32_t crc2, int64_t len2);
+
+/**
+ * 计算一段数据重复多次后的CRC-32，无需访问数据
+ *
+ * @param pattern_crc 单份数据的CRC
+ * @param pattern_len 单份数据的长度(字节)
+ * @param count 重复次数
+ * @return 重复后数据的CRC
+ */
+uint32_t zipbomb_crc32_repeat(uint32_t pattern_crc, int64_t pattern_len, int64_t count);
+
+/**
+ * 获取当前使用的CRC-32实现名称（设置环境变量ZIPBOMB_CRC32=slice-by-8可强制使用查表实现）
+ *
+ * @return "pclmul"、"armv8-crc" 或 "slice-by-8"
+ */
+const char* zipbomb_crc32_impl(void);
+
+/**
+ * 生成条目内容的一段
+ *
+ * 与生成归档时写入的内容完全相同，可直接用作扫描器的测试数据
+ *
+ * @param config 使用其中的pattern_kind、pattern_char、pattern_period和pattern_seed
+ * @param entry_size 条目大小(字节)
+ * @param variant 内容编号(从0开始)，对应pattern_variants中的第几份
+ * @param offset 起始位置
+ * @param out 输出缓冲区
+ * @param len 生成的字节数，offset + len不得超过entry_size
+ * @return 成功返回ZIPBOMB_SUCCESS
+ */
+int zipbomb_fill_pattern(const zipbomb_config_t* config, int64_t entry_size, int64_t variant,
+                         int64_t offset, void* out, size_t len);
+
+/**
+ * 获取当前使用的模式生成实现名称
+ *
+ * @return "avx2"、"neon" 或 "scalar"
+ */
+const char* zipbomb_pattern_impl(void);
+
 // ============================================================================
 // 统计和性能监控
 // ============================================================================
@@ -239,6 +584,27 @@ double get_compression_ratio(void);
  */
 double get_processing_time(void);
 
+/**
+ * 获取最近一次生成的输出I/O统计
+ *
+ * @param stats 输出的统计结构体
+ */
+void get_io_stats(zipbomb_io_stats_t* stats);
+
+/**
+ * 获取默认上下文最近一次生成的完整统计（含各阶段计数）
+ *
+ * @param stats 输出的统计结构体
+ */
+void get_performance_stats(zipbomb_stats_t* stats);
+
+/**
+ * 把默认上下文最近一次生成的统计导出到文件，参数同zipbomb_stats_export
+ *
+ * @return 成功返回0，失败返回错误代码
+ */
+int export_performance_stats(const char* filename, int format);
+
 /**
  * 打印性能统计
  */
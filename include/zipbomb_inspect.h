@@ -0,0 +1,243 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档快速检查接口
+ *
+ * 功能: 只读取结束记录和中央目录，不解压任何数据，得出归档声明的
+ *       解压大小、条目数、整体和单个条目的膨胀比、嵌套归档迹象以及
+ *       条目数据重叠，并与给定预算比较；用于在上传入口处拒绝解压炸弹。
+ *       一致性扫描另外读一遍全部数据，逐个核对本地头与中央目录，
+ *       找出数据范围重叠或共用的条目以及不属于任何条目的记录签名；
+ *       解压验证在内存中实际解压每个条目（不写磁盘），核对CRC和大小
+ * 说明: 文件以只读方式映射，中央目录原地遍历，不复制；
+ *       快速检查的是中央目录中声明的大小，本地头与之不符的归档由一致性
+ *       扫描发现，实际解压出的数据与声明不符的由解压验证发现
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_INSPECT_H
+#define ZIPBOMB_INSPECT_H
+
+#include "zipbomb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 超出预算的项目(zipbomb_inspect_report_t.violations的位) */
+#define ZIPBOMB_INSPECT_TOTAL_SIZE   0x01     // 声明的总解压大小超出
+#define ZIPBOMB_INSPECT_ENTRY_SIZE   0x02     // 某个条目的解压大小超出
+#define ZIPBOMB_INSPECT_RATIO        0x04     // 整体膨胀比（总解压大小/归档大小）超出
+#define ZIPBOMB_INSPECT_ENTRY_RATIO  0x08     // 某个条目的膨胀比（解压大小/压缩大小）超出
+#define ZIPBOMB_INSPECT_ENTRY_COUNT  0x10     // 条目数超出
+#define ZIPBOMB_INSPECT_NESTED       0x20     // 看起来是归档的条目数超出
+#define ZIPBOMB_INSPECT_OVERLAP      0x40     // 条目数据互相重叠或伸入中央目录（与预算无关）
+
+/**
+ * 检查预算，各项为0表示不限制
+ */
+typedef struct {
+    uint64_t max_total_uncompressed;  // 总解压大小上限(字节)
+    uint64_t max_entry_uncompressed;  // 单个条目解压大小上限(字节)
+    double max_ratio;                 // 整体膨胀比上限
+    double max_entry_ratio;           // 单个条目膨胀比上限
+    uint64_t max_entries;             // 条目数上限
+    uint64_t max_nested_archives;     // 嵌套归档迹象上限
+} zipbomb_inspect_budget_t;
+
+/**
+ * 检查结果
+ */
+typedef struct {
+    uint64_t archive_size;            // 归档字节数
+    uint64_t entry_count;             // 中央目录中的条目数
+    uint64_t total_uncompressed;      // 声明的总解压大小（溢出时为UINT64_MAX）
+    uint64_t total_compressed;        // 声明的总压缩大小
+    uint64_t max_entry_uncompressed;  // 最大的单个条目解压大小
+    double ratio;                     // 整体膨胀比
+    double max_entry_ratio;           // 最大的单个条目膨胀比
+    uint64_t max_ratio_entry;         // 膨胀比最大的条目序号
+    uint64_t nested_archives;         // 文件名像归档(.zip、.gz等)的条目数
+    uint64_t overlapping_entries;     // 数据与前一条目重叠或伸入中央目录的条目数
+    bool zip64;                       // 是否使用ZIP64结束记录
+    uint32_t violations;              // 超出预算的项目(ZIPBOMB_INSPECT_*)
+} zipbomb_inspect_report_t;
+
+/**
+ * 获取默认预算
+ *
+ * 总解压大小4GB、单个条目1GB、整体膨胀比100、单个条目膨胀比1000、
+ * 条目数100000、嵌套归档不限
+ */
+zipbomb_inspect_budget_t zipbomb_inspect_default_budget(void);
+
+/**
+ * 检查内存中的归档
+ *
+ * @param data 归档内容
+ * @param size 字节数
+ * @param budget 预算，NULL使用默认预算
+ * @param report 输出的检查结果
+ * @return 成功解析返回0（是否超出预算见report->violations），
+ *         结构损坏返回ZIPBOMB_ERROR_MALFORMED，其他失败返回相应错误代码
+ */
+int zipbomb_inspect_buffer(const uint8_t* data, size_t size, const zipbomb_inspect_budget_t* budget,
+                           zipbomb_inspect_report_t* report);
+
+/**
+ * 映射并检查归档文件，参数和返回值同zipbomb_inspect_buffer
+ *
+ * @param filename 文件名
+ */
+int zipbomb_inspect_file(const char* filename, const zipbomb_inspect_budget_t* budget,
+                         zipbomb_inspect_report_t* report);
+
+// ============================================================================
+// 本地头与中央目录一致性扫描
+// ============================================================================
+
+/** 扫描发现的问题(zipbomb_scan_report_t.findings的位) */
+#define ZIPBOMB_SCAN_MISSING_LOCAL   0x01     // 中央目录指向的位置没有完整的本地头
+#define ZIPBOMB_SCAN_MISMATCH        0x02     // 本地头或数据描述符与中央目录不一致
+#define ZIPBOMB_SCAN_OVERLAP         0x04     // 条目数据与前面的条目重叠或伸入中央目录
+#define ZIPBOMB_SCAN_SHARED          0x08     // 多个中央目录条目指向同一个本地头
+#define ZIPBOMB_SCAN_STRAY_LOCAL     0x10     // 不属于任何条目的本地头签名（中央目录之外的隐藏条目）
+#define ZIPBOMB_SCAN_STRAY_CENTRAL   0x20     // 中央目录之外、不属于任何条目的中央目录签名
+
+/** 不一致的字段(zipbomb_scan_report_t.mismatched_fields的位) */
+#define ZIPBOMB_SCAN_FIELD_NAME        0x01   // 文件名
+#define ZIPBOMB_SCAN_FIELD_METHOD      0x02   // 压缩方法
+#define ZIPBOMB_SCAN_FIELD_FLAGS       0x04   // 加密或数据描述符标志
+#define ZIPBOMB_SCAN_FIELD_CRC         0x08   // CRC-32
+#define ZIPBOMB_SCAN_FIELD_SIZE        0x10   // 压缩后或原始大小
+#define ZIPBOMB_SCAN_FIELD_DESCRIPTOR  0x20   // 数据描述符越界
+
+/**
+ * 一致性扫描结果
+ */
+typedef struct {
+    uint64_t archive_size;            // 归档字节数
+    uint64_t entry_count;             // 中央目录中的条目数
+    uint64_t local_signatures;        // 中央目录之外找到的本地头签名数
+    uint64_t central_signatures;      // 中央目录之外找到的中央目录签名数
+    uint64_t missing_local;           // 没有本地头的条目数
+    uint64_t mismatched_entries;      // 本地头与中央目录不一致的条目数
+    uint64_t overlapping_entries;     // 数据与前面的条目重叠或伸入中央目录的条目数
+    uint64_t shared_entries;          // 与前一条目共用本地头的条目数
+    uint64_t embedded_signatures;     // 位于条目数据内部的签名数（如存储方式的嵌套归档）
+    uint64_t stray_local_headers;     // 不属于任何条目的本地头签名数
+    uint64_t stray_central_headers;   // 中央目录之外不属于任何条目的中央目录签名数
+    uint32_t mismatched_fields;       // 出现过不一致的字段(ZIPBOMB_SCAN_FIELD_*)
+    uint32_t findings;                // 发现的问题(ZIPBOMB_SCAN_*)
+} zipbomb_scan_report_t;
+
+/**
+ * 扫描内存中的归档
+ *
+ * 按本地头偏移的顺序逐个核对本地头（签名、文件名、压缩方法、标志、
+ * CRC和大小，使用数据描述符时核对描述符），同时用向量指令在中央目录
+ * 之外的全部数据中查找本地头和中央目录签名，与各条目的数据范围合并，
+ * 数据只读一遍
+ *
+ * @param data 归档内容
+ * @param size 字节数
+ * @param report 输出的扫描结果
+ * @return 成功解析中央目录返回0（发现的问题见report->findings），
+ *         结束记录或中央目录损坏返回ZIPBOMB_ERROR_MALFORMED，其他失败返回相应错误代码
+ */
+int zipbomb_scan_buffer(const uint8_t* data, size_t size, zipbomb_scan_report_t* report);
+
+/**
+ * 映射并扫描归档文件，返回值同zipbomb_scan_buffer
+ *
+ * @param filename 文件名
+ * @param report 输出的扫描结果
+ */
+int zipbomb_scan_file(const char* filename, zipbomb_scan_report_t* report);
+
+/**
+ * 获取签名查找使用的实现名称（"avx2"、"neon"或"scalar"）
+ */
+const char* zipbomb_scan_implementation(void);
+
+// ============================================================================
+// 解压验证
+// ============================================================================
+
+/** 验证发现的问题(zipbomb_verify_report_t.failures的位) */
+#define ZIPBOMB_VERIFY_CRC           0x01     // 解压结果的CRC与中央目录不符
+#define ZIPBOMB_VERIFY_SIZE          0x02     // 解压大小或压缩流长度与中央目录不符
+#define ZIPBOMB_VERIFY_CORRUPT       0x04     // 本地头缺失、压缩数据越界、损坏或截断
+#define ZIPBOMB_VERIFY_UNSUPPORTED   0x08     // 加密条目或不支持的压缩方法（只支持存储和deflate）
+#define ZIPBOMB_VERIFY_BYTE_BUDGET   0x10     // 解压字节数超出预算，已中止
+#define ZIPBOMB_VERIFY_RATIO_BUDGET  0x20     // 条目实际膨胀比超出预算，已中止
+#define ZIPBOMB_VERIFY_TIME_BUDGET   0x40     // 超出时间预算，已中止
+
+/**
+ * 解压验证预算，各项为0表示不限制
+ *
+ * 总字节数和时间超出时所有条目都停止；单个条目超出时只中止该条目
+ */
+typedef struct {
+    uint64_t max_total_bytes;         // 全部条目解压出的字节数上限
+    uint64_t max_entry_bytes;         // 单个条目解压出的字节数上限
+    double max_ratio;                 // 单个条目实际膨胀比（解压字节/压缩字节）上限
+    double max_seconds;               // 墙钟时间上限(秒)
+    int thread_count;                 // 并行解压的线程数，0表示使用全部硬件线程
+} zipbomb_verify_budget_t;
+
+/**
+ * 解压验证结果
+ */
+typedef struct {
+    uint64_t entry_count;             // 中央目录中的条目数
+    uint64_t verified_entries;        // 完整解压且CRC和大小都相符的条目数
+    uint64_t failed_entries;          // 发现问题或被中止的条目数
+    uint64_t skipped_entries;         // 因总预算用完而未开始的条目数
+    uint64_t first_failed_entry;      // 第一个出问题的条目序号（中央目录顺序）
+    uint64_t bytes_in;                // 已开始解压的条目的压缩字节数
+    uint64_t bytes_out;               // 解压出的字节数
+    uint64_t max_entry_bytes;         // 单个条目解压出的最大字节数
+    double max_ratio;                 // 单个条目实际膨胀比的最大值
+    uint64_t wall_time_ns;            // 墙钟耗时(纳秒)
+    double mb_in_per_sec;             // 压缩数据读入吞吐量(MB/s)
+    double mb_out_per_sec;            // 解压输出吞吐量(MB/s)
+    uint32_t threads;                 // 实际使用的线程数
+    uint32_t failures;                // 发现的问题(ZIPBOMB_VERIFY_*)
+} zipbomb_verify_report_t;
+
+/**
+ * 获取默认验证预算
+ *
+ * 总解压字节数16GB、时间60秒、单个条目和膨胀比不限、使用全部硬件线程
+ */
+zipbomb_verify_budget_t zipbomb_verify_default_budget(void);
+
+/**
+ * 在内存中解压并验证每个条目
+ *
+ * 每个线程用一个256KB的输出窗口流式解压，边解压边计算CRC，解压结果
+ * 不保存；解压出的字节超过声明的大小或任一预算时立即中止该条目
+ *
+ * @param data 归档内容
+ * @param size 字节数
+ * @param budget 预算，NULL使用默认预算
+ * @param report 输出的验证结果
+ * @return 成功解析中央目录返回0（发现的问题见report->failures），
+ *         结构损坏返回ZIPBOMB_ERROR_MALFORMED，其他失败返回相应错误代码
+ */
+int zipbomb_verify_buffer(const uint8_t* data, size_t size, const zipbomb_verify_budget_t* budget,
+                          zipbomb_verify_report_t* report);
+
+/**
+ * 映射并验证归档文件，参数和返回值同zipbomb_verify_buffer
+ *
+ * @param filename 文件名
+ */
+int zipbomb_verify_file(const char* filename, const zipbomb_verify_budget_t* budget,
+                        zipbomb_verify_report_t* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZIPBOMB_INSPECT_H */
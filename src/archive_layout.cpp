@@ -0,0 +1,134 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档布局计算实现
+ * ============================================================================
+ */
+
+#include "archive_layout.h"
+#include "central_directory.h"
+#include "zip_format.h"
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr uint64_t ZIP64_VALUE_SIZE = sizeof(uint64_t);
+
+/** n个ZIP64值对应的扩展字段长度 */
+inline uint64_t zip64_extra_size(unsigned n) {
+    return n ? sizeof(ZipExtraFieldHeader) + n * ZIP64_VALUE_SIZE : 0;
+}
+
+/** 本地头的ZIP64字段总是同时包含两个大小 */
+inline uint64_t local_extra_size(uint64_t uncompressed_size, uint64_t compressed_size) {
+    const bool zip64 = uncompressed_size >= ZIP64_LIMIT_32 || compressed_size >= ZIP64_LIMIT_32;
+    return zip64_extra_size(zip64 ? 2 : 0);
+}
+
+/** 本地头带ZIP64扩展字段时数据描述符使用64位大小 */
+inline uint64_t descriptor_size(uint64_t uncompressed_size, uint64_t compressed_size) {
+    return local_extra_size(uncompressed_size, compressed_size) ? sizeof(ZipDataDescriptor64)
+                                                                : sizeof(ZipDataDescriptor);
+}
+
+} // namespace
+
+ArchiveLayout::ArchiveLayout(uint64_t num_entries, uint64_t uncompressed_size,
+                             uint64_t compressed_size, bool data_descriptor)
+    : num_entries_(num_entries),
+      uncompressed_size_(uncompressed_size),
+      variant_sizes_(1, compressed_size),
+      data_descriptor_(data_descriptor) {
+    compute();
+}
+
+ArchiveLayout::ArchiveLayout(uint64_t num_entries, uint64_t uncompressed_size,
+                             const std::vector<uint64_t>& variant_compressed_sizes,
+                             bool data_descriptor)
+    : num_entries_(num_entries),
+      uncompressed_size_(uncompressed_size),
+      variant_sizes_(variant_compressed_sizes),
+      data_descriptor_(data_descriptor) {
+    if (variant_sizes_.empty()) variant_sizes_.push_back(0);
+    compute();
+}
+
+void ArchiveLayout::compute() {
+    const size_t variants = variant_sizes_.size();
+    record_prefix_.assign(variants + 1, 0);
+    for (size_t v = 0; v < variants; v++) {
+        const uint64_t extra = local_extra_size(uncompressed_size_, variant_sizes_[v]);
+        if (extra) entry_zip64_ = true;
+        record_prefix_[v + 1] = record_prefix_[v] + sizeof(ZipLocalFileHeader) + extra + variant_sizes_[v] +
+                                data_descriptor_size(v);
+    }
+
+    central_dir_offset_ = entry_offset(num_entries_);
+
+    // 中央目录的ZIP64字段只包含溢出的值；偏移溢出从某个条目开始一直持续
+    const uint64_t first_far = first_zip64_offset_entry();
+    central_dir_size_ = num_entries_ * sizeof(ZipCentralDirHeader) + entry_name_bytes(num_entries_);
+    for (size_t v = 0; v < variants; v++) {
+        const unsigned size_values = (uncompressed_size_ >= ZIP64_LIMIT_32 ? 1 : 0) +
+                                     (variant_sizes_[v] >= ZIP64_LIMIT_32 ? 1 : 0);
+        const uint64_t near_uses = variant_uses(v, first_far);
+        const uint64_t far_uses = variant_uses(v, num_entries_) - near_uses;
+        central_dir_size_ += near_uses * zip64_extra_size(size_values) +
+                             far_uses * zip64_extra_size(size_values + 1);
+    }
+
+    zip64_end_ = num_entries_ >= ZIP64_LIMIT_16 ||
+                 central_dir_size_ >= ZIP64_LIMIT_32 ||
+                 central_dir_offset_ >= ZIP64_LIMIT_32;
+    total_size_ = central_dir_offset_ + central_dir_size_ +
+                  (zip64_end_ ? sizeof(Zip64EndOfCentralDir) + sizeof(Zip64EndOfCentralDirLocator) : 0) +
+                  sizeof(ZipEndOfCentralDir);
+}
+
+uint64_t ArchiveLayout::variant_uses(uint64_t variant, uint64_t count) const {
+    const uint64_t variants = variant_sizes_.size();
+    return count / variants + (variant < count % variants ? 1 : 0);
+}
+
+uint64_t ArchiveLayout::total_compressed_size() const {
+    uint64_t total = 0;
+    for (size_t v = 0; v < variant_sizes_.size(); v++) {
+        total += variant_uses(v, num_entries_) * variant_sizes_[v];
+    }
+    return total;
+}
+
+uint64_t ArchiveLayout::entry_offset(uint64_t index) const {
+    const uint64_t variants = variant_sizes_.size();
+    return (index / variants) * record_prefix_[variants] + record_prefix_[index % variants] +
+           entry_name_bytes(index);
+}
+
+uint64_t ArchiveLayout::local_header_size(uint64_t index) const {
+    const uint64_t compressed_size = entry_compressed_size(index);
+    return sizeof(ZipLocalFileHeader) + local_extra_size(uncompressed_size_, compressed_size) +
+           entry_name_length(index);
+}
+
+uint64_t ArchiveLayout::data_descriptor_size(uint64_t index) const {
+    return data_descriptor_ ? descriptor_size(uncompressed_size_, entry_compressed_size(index)) : 0;
+}
+
+/**
+ * 二分查找第一个本地头偏移不能用32位表示的条目
+ */
+uint64_t ArchiveLayout::first_zip64_offset_entry() const {
+    uint64_t low = 0;
+    uint64_t high = num_entries_;
+    while (low < high) {
+        const uint64_t mid = low + (high - low) / 2;
+        if (entry_offset(mid) >= ZIP64_LIMIT_32) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+} // namespace ZipBombGenerator
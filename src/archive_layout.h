@@ -0,0 +1,103 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档布局计算
+ *
+ * 功能: 在不生成任何数据的情况下，根据条目数和单个条目的大小精确算出
+ *       每个条目的偏移、中央目录位置以及最终文件大小
+ * 说明: 条目内容按序号循环使用若干份压缩数据（第i个条目使用第i % D份），
+ *       文件名长度随序号变化，因此偏移可由整周期长度、周期内前缀和与
+ *       按十进制位数分段求和的文件名长度直接算出，单次查询O(位数)
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_ARCHIVE_LAYOUT_H
+#define ZIPBOMB_ARCHIVE_LAYOUT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/**
+ * 归档布局
+ */
+class ArchiveLayout {
+public:
+    /**
+     * 所有条目内容相同
+     *
+     * @param num_entries 条目数
+     * @param uncompressed_size 每个条目的原始大小
+     * @param compressed_size 每个条目的压缩后大小
+     * @param data_descriptor 每个条目的压缩数据之后是否有数据描述符
+     */
+    ArchiveLayout(uint64_t num_entries, uint64_t uncompressed_size, uint64_t compressed_size,
+                  bool data_descriptor = false);
+
+    /**
+     * 条目按序号循环使用多份内容
+     *
+     * @param variant_compressed_sizes 每份内容的压缩后大小，第i个条目使用第i % D份
+     */
+    ArchiveLayout(uint64_t num_entries, uint64_t uncompressed_size,
+                  const std::vector<uint64_t>& variant_compressed_sizes,
+                  bool data_descriptor = false);
+
+    uint64_t num_entries() const { return num_entries_; }
+    uint64_t entry_uncompressed_size() const { return uncompressed_size_; }
+    uint64_t variant_count() const { return variant_sizes_.size(); }
+
+    /** 第index个条目的压缩后大小 */
+    uint64_t entry_compressed_size(uint64_t index) const {
+        return variant_sizes_[index % variant_sizes_.size()];
+    }
+
+    /** 压缩数据总大小 */
+    uint64_t total_compressed_size() const;
+
+    /** 是否有条目的本地头需要ZIP64扩展字段 */
+    bool entry_zip64() const { return entry_zip64_; }
+
+    /** 第index个条目本地头的偏移；index == num_entries()时即中央目录偏移 */
+    uint64_t entry_offset(uint64_t index) const;
+
+    /** 本地头 + 文件名 + 扩展字段的长度 */
+    uint64_t local_header_size(uint64_t index) const;
+
+    /** 第index个条目的数据描述符长度，没有时为0 */
+    uint64_t data_descriptor_size(uint64_t index) const;
+
+    bool data_descriptor() const { return data_descriptor_; }
+
+    uint64_t central_dir_offset() const { return central_dir_offset_; }
+    uint64_t central_dir_size() const { return central_dir_size_; }
+
+    /** 是否需要ZIP64结束记录 */
+    bool zip64_end_records() const { return zip64_end_; }
+
+    /** 最终文件大小 */
+    uint64_t total_size() const { return total_size_; }
+
+private:
+    void compute();
+    uint64_t first_zip64_offset_entry() const;
+
+    /** 前count个条目中使用第variant份内容的个数 */
+    uint64_t variant_uses(uint64_t variant, uint64_t count) const;
+
+    uint64_t num_entries_;
+    uint64_t uncompressed_size_;
+    std::vector<uint64_t> variant_sizes_;
+    bool data_descriptor_;
+    std::vector<uint64_t> record_prefix_;   // 一个周期内除文件名外本地记录长度的前缀和
+    bool entry_zip64_ = false;
+
+    uint64_t central_dir_offset_;
+    uint64_t central_dir_size_;
+    bool zip64_end_;
+    uint64_t total_size_;
+};
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_ARCHIVE_LAYOUT_H */
@@ -0,0 +1,498 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 异步输出管线实现
+ * ============================================================================
+ */
+
+#include "async_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr unsigned DEFAULT_QUEUE_DEPTH = 8;
+constexpr unsigned MAX_QUEUE_DEPTH = 256;
+constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;   // 每个缓冲区1MB
+constexpr size_t IO_ALIGNMENT = 4096;                 // O_DIRECT对齐要求
+constexpr unsigned MAX_WORKER_THREADS = 4;
+
+/**
+ * 去掉文件的O_DIRECT标志，之后的写入可以不对齐
+ */
+void clear_direct_io(int fd) {
+#ifdef O_DIRECT
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0 && (flags & O_DIRECT)) fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+#else
+    (void)fd;
+#endif
+}
+
+/**
+ * 同步补写剩余部分（处理部分写入）
+ *
+ * 部分写入后剩余部分的地址和偏移不再对齐，先去掉O_DIRECT再继续写
+ */
+bool pwrite_all(int fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+        if (len > 0) clear_direct_io(fd);
+    }
+    return true;
+}
+
+// ============================================================================
+// io_uring后端
+// ============================================================================
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+
+/**
+ * 直接基于系统调用的最小io_uring封装
+ *
+ * 每个slot对应一个固定的iovec，提交IORING_OP_WRITEV；
+ * 内核短写时在完成处理中同步补齐
+ */
+class IoUringBackend : public AsyncWriteBackend {
+public:
+    IoUringBackend(int fd, unsigned depth) : fd_(fd), requests_(depth) {}
+
+    ~IoUringBackend() override {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_size_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+    }
+
+    /** 创建并映射环，内核不支持时返回false */
+    bool init() {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup,
+                                            static_cast<unsigned>(requests_.size()), &params));
+        if (ring_fd_ < 0) return false;
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) return false;
+        if (single_mmap) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == MAP_FAILED) return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        uint8_t* cq = static_cast<uint8_t*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    bool submit(const uint8_t* data, size_t len, uint64_t offset, size_t slot) override {
+        Request& request = requests_[slot];
+        request.iov.iov_base = const_cast<uint8_t*>(data);
+        request.iov.iov_len = len;
+        request.offset = offset;
+
+        // 只有本线程写SQ尾，读取无需同步；发布时用release保证SQE内容先可见
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = fd_;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(&request.iov);
+        sqe->len = 1;
+        sqe->user_data = slot;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    }
+
+    bool wait_one(size_t& slot) override {
+        for (;;) {
+            const unsigned head = *cq_head_;
+            if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                slot = static_cast<size_t>(cqe.user_data);
+                const int res = cqe.res;
+                __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+                return complete(slot, res);
+            }
+            if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                        nullptr, 0) < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+private:
+    struct Request {
+        struct iovec iov;
+        uint64_t offset;
+    };
+
+    bool complete(size_t slot, int res) {
+        if (res < 0) return false;
+        const Request& request = requests_[slot];
+        const size_t written = static_cast<size_t>(res);
+        if (written >= request.iov.iov_len) return true;
+        // 剩余部分不对齐，O_DIRECT下直接补写会返回EINVAL
+        clear_direct_io(fd_);
+        return pwrite_all(fd_, static_cast<const uint8_t*>(request.iov.iov_base) + written,
+                          request.iov.iov_len - written, request.offset + written);
+    }
+
+    int fd_;
+    int ring_fd_ = -1;
+    std::vector<Request> requests_;
+
+    void* sq_ptr_ = MAP_FAILED;
+    void* cq_ptr_ = MAP_FAILED;
+    void* sqes_ = MAP_FAILED;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+};
+
+#endif
+
+// ============================================================================
+// 线程池后端
+// ============================================================================
+
+/**
+ * io_uring不可用时的后备方案：少量工作线程执行pwrite
+ */
+class ThreadPoolBackend : public AsyncWriteBackend {
+public:
+    ThreadPoolBackend(int fd, unsigned depth) : fd_(fd) {
+        const unsigned workers = std::min(depth, MAX_WORKER_THREADS);
+        for (unsigned i = 0; i < workers; i++) {
+            workers_.emplace_back(&ThreadPoolBackend::worker_loop, this);
+        }
+    }
+
+    ~ThreadPoolBackend() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_ready_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    bool submit(const uint8_t* data, size_t len, uint64_t offset, size_t slot) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back({data, len, offset, slot});
+        }
+        work_ready_.notify_one();
+        return true;
+    }
+
+    bool wait_one(size_t& slot) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_ready_.wait(lock, [this] { return !done_.empty(); });
+        const Completion completion = done_.front();
+        done_.pop_front();
+        slot = completion.slot;
+        return completion.ok;
+    }
+
+    const char* name() const override { return "threads"; }
+
+private:
+    struct Job {
+        const uint8_t* data;
+        size_t len;
+        uint64_t offset;
+        size_t slot;
+    };
+
+    struct Completion {
+        size_t slot;
+        bool ok;
+    };
+
+    void worker_loop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_ready_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+                if (pending_.empty()) return;
+                job = pending_.front();
+                pending_.pop_front();
+            }
+            const bool ok = pwrite_all(fd_, job.data, job.len, job.offset);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.push_back({job.slot, ok});
+            }
+            done_ready_.notify_one();
+        }
+    }
+
+    int fd_;
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable done_ready_;
+    std::deque<Job> pending_;
+    std::deque<Completion> done_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace
+
+// ============================================================================
+// AsyncSink
+// ============================================================================
+
+AsyncSink::AsyncSink(int fd, std::unique_ptr<AsyncWriteBackend> backend,
+                     unsigned queue_depth, size_t buffer_size, bool direct_io)
+    : fd_(fd), backend_(std::move(backend)), buffer_size_(buffer_size), direct_io_(direct_io) {
+    stats_.backend = backend_->name();
+    stats_.direct_io = direct_io;
+
+    buffers_.reserve(queue_depth);
+    free_slots_.reserve(queue_depth);
+    for (unsigned i = 0; i < queue_depth; i++) {
+        void* buffer = nullptr;
+        if (posix_memalign(&buffer, IO_ALIGNMENT, buffer_size_) != 0) {
+            ok_ = false;
+            break;
+        }
+        buffers_.push_back(static_cast<uint8_t*>(buffer));
+        free_slots_.push_back(queue_depth - 1 - i);
+    }
+}
+
+AsyncSink::~AsyncSink() {
+    close();
+    // 后端先析构（等待工作线程退出），再释放缓冲区
+    backend_.reset();
+    for (uint8_t* buffer : buffers_) free(buffer);
+}
+
+/**
+ * 等待一个写请求完成并回收其缓冲区，等待时间计入stall
+ *
+ * 失败时slot可能未被设置（如io_uring_enter出错），不回收
+ */
+bool AsyncSink::reap_one() {
+    auto wait_start = std::chrono::steady_clock::now();
+    size_t slot;
+    const bool completed = backend_->wait_one(slot);
+    stats_.stall_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wait_start).count());
+    in_flight_--;
+    if (!completed) return false;
+    free_slots_.push_back(slot);
+    return true;
+}
+
+/**
+ * 取得一个空闲缓冲区，没有时等待最早完成的写请求
+ */
+bool AsyncSink::acquire_buffer() {
+    while (free_slots_.empty()) {
+        if (in_flight_ == 0 || !reap_one()) return false;
+    }
+    current_ = free_slots_.back();
+    free_slots_.pop_back();
+    current_used_ = 0;
+    return true;
+}
+
+bool AsyncSink::submit_current() {
+    const size_t len = current_used_;
+    if (!backend_->submit(buffers_[current_], len, submit_offset_, current_)) return false;
+    submit_offset_ += len;
+    stats_.writes_submitted++;
+    stats_.bytes_written += len;
+    in_flight_++;
+    stats_.max_in_flight = std::max(stats_.max_in_flight, in_flight_);
+    current_ = SIZE_MAX;
+    current_used_ = 0;
+    return true;
+}
+
+bool AsyncSink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    offset_ += len;
+
+    while (len > 0) {
+        if (current_ == SIZE_MAX && !acquire_buffer()) {
+            ok_ = false;
+            return false;
+        }
+        const size_t n = std::min(len, buffer_size_ - current_used_);
+        std::memcpy(buffers_[current_] + current_used_, data, n);
+        current_used_ += n;
+        data += n;
+        len -= n;
+
+        if (current_used_ == buffer_size_ && !submit_current()) {
+            ok_ = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 等待所有在途请求完成
+ */
+bool AsyncSink::wait_all() {
+    bool result = true;
+    while (in_flight_ > 0) {
+        if (!reap_one()) result = false;
+    }
+    return result;
+}
+
+/**
+ * 提交未满的缓冲区并等待全部完成
+ *
+ * O_DIRECT模式下未对齐的尾部不能提交，保留到close()时同步写出
+ */
+bool AsyncSink::flush() {
+    if (!ok_) return false;
+    if (!direct_io_ && current_ != SIZE_MAX && current_used_ > 0 && !submit_current()) {
+        ok_ = false;
+        return false;
+    }
+    if (!wait_all()) ok_ = false;
+    return ok_;
+}
+
+/**
+ * O_DIRECT模式下写出最后一段未对齐数据
+ */
+bool AsyncSink::write_tail() {
+    if (current_ == SIZE_MAX || current_used_ == 0) return true;
+    if (direct_io_) clear_direct_io(fd_);
+    const bool result = pwrite_all(fd_, buffers_[current_], current_used_, submit_offset_);
+    submit_offset_ += current_used_;
+    stats_.bytes_written += current_used_;
+    current_used_ = 0;
+    return result;
+}
+
+bool AsyncSink::preallocate(uint64_t size) {
+    if (fd_ < 0) return true;
+    return preallocate_fd(fd_, size);
+}
+
+bool AsyncSink::close() {
+    if (closed_) return ok_;
+    closed_ = true;
+    bool result = flush() && write_tail();
+    if (::close(fd_) != 0) result = false;
+    fd_ = -1;
+    ok_ = result;
+    return result;
+}
+
+// ============================================================================
+// 工厂函数
+// ============================================================================
+
+std::unique_ptr<AsyncSink> open_async_file_sink(const std::string& filename,
+                                                bool prefer_io_uring,
+                                                unsigned queue_depth,
+                                                bool direct_io) {
+    if (queue_depth == 0) queue_depth = DEFAULT_QUEUE_DEPTH;
+    queue_depth = std::min(queue_depth, MAX_QUEUE_DEPTH);
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    int fd = -1;
+#ifdef O_DIRECT
+    if (direct_io) {
+        fd = open(filename.c_str(), flags | O_DIRECT, 0644);
+    }
+#endif
+    if (fd < 0) {
+        // 文件系统不支持O_DIRECT（如tmpfs）时退回普通I/O
+        direct_io = false;
+        fd = open(filename.c_str(), flags, 0644);
+        if (fd < 0) return nullptr;
+    }
+
+    std::unique_ptr<AsyncWriteBackend> backend;
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+    if (prefer_io_uring) {
+        std::unique_ptr<IoUringBackend> ring(new IoUringBackend(fd, queue_depth));
+        if (ring->init()) backend = std::move(ring);
+    }
+#else
+    (void)prefer_io_uring;
+#endif
+    if (!backend) backend.reset(new ThreadPoolBackend(fd, queue_depth));
+
+    std::unique_ptr<AsyncSink> sink(new AsyncSink(fd, std::move(backend), queue_depth,
+                                                  DEFAULT_BUFFER_SIZE, direct_io));
+    return sink;
+}
+
+} // namespace ZipBombGenerator
@@ -0,0 +1,113 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 异步输出管线
+ *
+ * 功能: 生成线程把数据拷入对齐的缓冲区后立即返回，写盘在后台进行，
+ *       使压缩/CRC与磁盘I/O重叠
+ * 说明: 优先使用io_uring（直接系统调用，不依赖liburing），不可用时退回
+ *       线程池 + pwrite；可选O_DIRECT绕过页缓存
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_ASYNC_SINK_H
+#define ZIPBOMB_ASYNC_SINK_H
+
+#include "output_sink.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/** 异步写统计 */
+struct AsyncIoStats {
+    const char* backend = "none";     // "io_uring" / "threads"
+    uint64_t writes_submitted = 0;    // 提交的写请求数
+    uint64_t bytes_written = 0;       // 写入字节数
+    unsigned max_in_flight = 0;       // 观察到的最大在途请求数
+    uint64_t stall_ns = 0;            // 生成线程等待写请求完成的总时间（含flush时的排空）
+    bool direct_io = false;           // 是否实际启用了O_DIRECT
+};
+
+/**
+ * 异步写后端接口：提交写请求、等待完成
+ */
+class AsyncWriteBackend {
+public:
+    virtual ~AsyncWriteBackend() = default;
+
+    /** 提交一个写请求，slot用于在完成时识别缓冲区 */
+    virtual bool submit(const uint8_t* data, size_t len, uint64_t offset, size_t slot) = 0;
+
+    /** 阻塞直到至少一个请求完成，返回其slot；失败返回false */
+    virtual bool wait_one(size_t& slot) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+/**
+ * 异步输出端
+ *
+ * 持有queue_depth个对齐缓冲区，写满一个就提交一个；没有空闲缓冲区时
+ * 生成线程阻塞（计入stall时间），从而限制在途内存
+ */
+class AsyncSink : public OutputSink {
+public:
+    AsyncSink(int fd, std::unique_ptr<AsyncWriteBackend> backend,
+              unsigned queue_depth, size_t buffer_size, bool direct_io);
+    ~AsyncSink() override;
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool flush() override;
+    uint64_t offset() const override { return offset_; }
+    bool preallocate(uint64_t size) override;
+    bool close() override;
+
+    const AsyncIoStats& stats() const { return stats_; }
+
+private:
+    bool submit_current();
+    bool reap_one();
+    bool acquire_buffer();
+    bool wait_all();
+    bool write_tail();
+
+    int fd_;
+    std::unique_ptr<AsyncWriteBackend> backend_;
+    size_t buffer_size_;
+    bool direct_io_;
+    bool ok_ = true;
+    bool closed_ = false;
+
+    std::vector<uint8_t*> buffers_;
+    std::vector<size_t> free_slots_;
+    size_t current_ = SIZE_MAX;      // 当前正在填充的缓冲区
+    size_t current_used_ = 0;
+    unsigned in_flight_ = 0;
+
+    uint64_t offset_ = 0;            // 逻辑偏移
+    uint64_t submit_offset_ = 0;     // 下一个提交请求的文件偏移
+    AsyncIoStats stats_;
+};
+
+/**
+ * 打开文件并创建异步输出端
+ *
+ * @param prefer_io_uring 为false时直接使用线程池后端
+ * @param queue_depth 缓冲区个数（0使用默认值）
+ * @param direct_io 请求O_DIRECT，文件系统不支持时自动退回普通I/O
+ * @return 失败返回nullptr
+ */
+std::unique_ptr<AsyncSink> open_async_file_sink(const std::string& filename,
+                                                bool prefer_io_uring,
+                                                unsigned queue_depth,
+                                                bool direct_io);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_ASYNC_SINK_H */
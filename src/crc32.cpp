@@ -0,0 +1,386 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - CRC-32 计算引擎实现
+ *
+ * 原理: 查表法每次处理8字节(slice-by-8)；x86使用无进位乘法把数据
+ *       折叠到128位再做Barrett约简；ARMv8直接使用CRC32指令。
+ *       CRC合并基于GF(2)上的 x^(8n) mod P 运算。
+ * ============================================================================
+ */
+
+#include "crc32.h"
+#include "zipbomb.h"
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZIPBOMB_CRC32_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ZIPBOMB_CRC32_ARM 1
+#include <arm_acle.h>
+#ifdef __linux__
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr uint32_t CRC32_POLY = 0xEDB88320u;  // 反射形式的多项式
+
+// ============================================================================
+// slice-by-8 查找表（编译期生成）
+// ============================================================================
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr CrcTables make_crc_tables() {
+    CrcTables t{};
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ CRC32_POLY : c >> 1;
+        t[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int k = 1; k < 8; k++) t[k][n] = (t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xFF];
+    }
+    return t;
+}
+
+constexpr CrcTables kCrcTables = make_crc_tables();
+
+inline uint32_t load32_le(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/** 查表实现，c为未取反的内部状态 */
+uint32_t crc32_slice8(uint32_t c, const uint8_t* p, size_t len) {
+    const auto& t = kCrcTables;
+    while (len >= 8) {
+        uint32_t one = load32_le(p) ^ c;
+        uint32_t two = load32_le(p + 4);
+        c = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+            t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+            t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+            t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = t[0][(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c;
+}
+
+// ============================================================================
+// 硬件加速实现
+// ============================================================================
+
+#if ZIPBOMB_CRC32_X86
+
+constexpr size_t PCLMUL_MIN_LENGTH = 64;
+
+/**
+ * PCLMULQDQ折叠实现 (Intel白皮书"Fast CRC Computation Using PCLMULQDQ")
+ *
+ * 要求len >= 64且为16的倍数；c为未取反的内部状态
+ */
+__attribute__((target("pclmul,sse4.1")))
+uint32_t crc32_pclmul(uint32_t c, const uint8_t* buf, size_t len) {
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(c)));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    buf += 64;
+    len -= 64;
+
+    // 4路并行折叠，每轮64字节
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+        y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+        y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+        y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    // 折叠为128位
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // 剩余的16字节块逐个折叠
+    while (len >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    // 128位 -> 64位
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett约简到32位
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+bool detect_hardware_crc() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#elif ZIPBOMB_CRC32_ARM
+
+#if defined(__clang__)
+#define ZIPBOMB_TARGET_CRC __attribute__((target("crc")))
+#else
+#define ZIPBOMB_TARGET_CRC __attribute__((target("+crc")))
+#endif
+
+/** ARMv8 CRC32指令实现，c为未取反的内部状态 */
+ZIPBOMB_TARGET_CRC
+uint32_t crc32_armv8(uint32_t c, const uint8_t* p, size_t len) {
+    while (len > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        c = __crc32b(c, *p++);
+        len--;
+    }
+    while (len >= 32) {
+        uint64_t v[4];
+        std::memcpy(v, p, sizeof(v));
+        c = __crc32d(c, v[0]);
+        c = __crc32d(c, v[1]);
+        c = __crc32d(c, v[2]);
+        c = __crc32d(c, v[3]);
+        p += 32;
+        len -= 32;
+    }
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        c = __crc32d(c, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = __crc32b(c, *p++);
+    return c;
+}
+
+bool detect_hardware_crc() {
+#if defined(__APPLE__)
+    return true;  // Apple Silicon均支持CRC32扩展
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    return false;
+#endif
+}
+
+#else
+
+bool detect_hardware_crc() {
+    return false;
+}
+
+#endif
+
+/** 环境变量ZIPBOMB_CRC32=slice-by-8时不用硬件指令，便于测试对照两种实现 */
+bool software_crc_forced() {
+    const char* value = std::getenv("ZIPBOMB_CRC32");
+    return value && std::strcmp(value, "slice-by-8") == 0;
+}
+
+/** 运行时选择的实现（首次使用时检测一次） */
+bool use_hardware_crc() {
+    static const bool enabled = !software_crc_forced() && detect_hardware_crc();
+    return enabled;
+}
+
+// ============================================================================
+// GF(2)多项式运算 (用于CRC合并)
+// ============================================================================
+
+/** 计算 a*b mod P，a和b均为反射表示 */
+uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ CRC32_POLY : b >> 1;
+    }
+    return p;
+}
+
+/** x^(2^n) mod P 表 */
+constexpr std::array<uint32_t, 64> make_x2n_table() {
+    std::array<uint32_t, 64> table{};
+    uint32_t p = 1u << 30;  // x^1
+    table[0] = p;
+    for (size_t n = 1; n < table.size(); n++) {
+        // 与multmodp相同，这里展开成constexpr形式
+        uint32_t a = p, b = p, m = 1u << 31, r = 0;
+        for (;;) {
+            if (a & m) {
+                r ^= b;
+                if ((a & (m - 1)) == 0) break;
+            }
+            m >>= 1;
+            b = (b & 1) ? (b >> 1) ^ CRC32_POLY : b >> 1;
+        }
+        table[n] = p = r;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 64> kX2nTable = make_x2n_table();
+
+/** 计算 x^(n * 2^k) mod P */
+uint32_t x2nmodp(uint64_t n, unsigned k) {
+    uint32_t p = 1u << 31;  // x^0
+    while (n) {
+        if (n & 1) p = multmodp(kX2nTable[k & 63], p);
+        n >>= 1;
+        k++;
+    }
+    return p;
+}
+
+} // namespace
+
+// ============================================================================
+// 公共接口
+// ============================================================================
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len) {
+    if (!data || len == 0) return crc;
+
+    uint32_t c = ~crc;
+#if ZIPBOMB_CRC32_X86
+    if (len >= PCLMUL_MIN_LENGTH && use_hardware_crc()) {
+        size_t chunk = len & ~static_cast<size_t>(15);
+        c = crc32_pclmul(c, data, chunk);
+        data += chunk;
+        len -= chunk;
+    }
+#elif ZIPBOMB_CRC32_ARM
+    if (use_hardware_crc()) return ~crc32_armv8(c, data, len);
+#endif
+    return ~crc32_slice8(c, data, len);
+}
+
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+    return multmodp(x2nmodp(len2, 3), crc1) ^ crc2;
+}
+
+uint32_t crc32_repeat(uint32_t pattern_crc, uint64_t pattern_len, uint64_t count) {
+    // 二进制倍增：每轮把当前块与自身合并，长度翻倍
+    uint32_t result = 0;
+    uint32_t block_crc = pattern_crc;
+    uint64_t block_len = pattern_len;
+    while (count) {
+        if (count & 1) result = crc32_combine(result, block_crc, block_len);
+        count >>= 1;
+        if (count) {
+            block_crc = crc32_combine(block_crc, block_crc, block_len);
+            block_len *= 2;
+        }
+    }
+    return result;
+}
+
+const char* crc32_implementation() {
+#if ZIPBOMB_CRC32_X86
+    if (use_hardware_crc()) return "pclmul";
+#elif ZIPBOMB_CRC32_ARM
+    if (use_hardware_crc()) return "armv8-crc";
+#endif
+    return "slice-by-8";
+}
+
+} // namespace ZipBombGenerator
+
+// ============================================================================
+// C接口实现
+// ============================================================================
+
+extern "C" {
+
+uint32_t zipbomb_crc32(uint32_t crc, const void* data, size_t len) {
+    return ZipBombGenerator::crc32_update(crc, static_cast<const uint8_t*>(data), len);
+}
+
+uint32_t zipbomb_crc32_combine(uint32_t crc1, uint32_t crc2, int64_t len2) {
+    if (len2 <= 0) return crc1;
+    return ZipBombGenerator::crc32_combine(crc1, crc2, static_cast<uint64_t>(len2));
+}
+
+uint32_t zipbomb_crc32_repeat(uint32_t pattern_crc, int64_t pattern_len, int64_t count) {
+    if (pattern_len <= 0 || count <= 0) return 0;
+    return ZipBombGenerator::crc32_repeat(pattern_crc, static_cast<uint64_t>(pattern_len),
+                                          static_cast<uint64_t>(count));
+}
+
+const char* zipbomb_crc32_impl(void) {
+    return ZipBombGenerator::crc32_implementation();
+}
+
+} // extern "C"
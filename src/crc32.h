@@ -0,0 +1,51 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - CRC-32 计算引擎
+ *
+ * 功能: ZIP使用的CRC-32 (多项式0xEDB88320)，结果与zlib的crc32()一致
+ * 说明: 运行时检测CPU，优先使用PCLMULQDQ折叠或ARMv8 CRC指令，
+ *       否则退回slice-by-8查表实现
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_CRC32_H
+#define ZIPBOMB_CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ZipBombGenerator {
+
+/**
+ * 增量计算CRC-32
+ *
+ * @param crc 之前的CRC值，首次调用传0
+ * @return 追加data之后的CRC值
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t len);
+
+/**
+ * 合并两段数据的CRC
+ *
+ * @param crc1 前一段数据的CRC
+ * @param crc2 后一段数据的CRC
+ * @param len2 后一段数据的长度
+ * @return 两段数据拼接后的CRC，耗时O(log len2)，不需要访问数据
+ */
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
+/**
+ * 计算某段数据重复count次后的CRC
+ *
+ * @param pattern_crc 单份数据的CRC
+ * @param pattern_len 单份数据的长度
+ * @param count 重复次数
+ */
+uint32_t crc32_repeat(uint32_t pattern_crc, uint64_t pattern_len, uint64_t count);
+
+/** 当前使用的实现名称 ("pclmul" / "armv8-crc" / "slice-by-8")；环境变量ZIPBOMB_CRC32=slice-by-8强制使用查表实现 */
+const char* crc32_implementation();
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_CRC32_H */
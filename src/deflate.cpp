@@ -0,0 +1,991 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 流式DEFLATE编码器实现
+ *
+ * 功能: RFC 1951 压缩，LZ77(哈希链+贪心/惰性匹配) + Huffman编码
+ * 原理: 符号分布明显变化时提前结束当前块；每个块分别计算动态Huffman、
+ *       固定Huffman和存储三种编码的位数，选择最短的一种输出
+ * ============================================================================
+ */
+
+#include "deflate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ZipBombGenerator {
+
+// ============================================================================
+// 常量与查找表
+// ============================================================================
+
+namespace {
+
+constexpr unsigned WSIZE = 32768;                 // 窗口大小
+constexpr unsigned WMASK = WSIZE - 1;
+constexpr unsigned HASH_BITS = 15;
+constexpr unsigned HASH_SIZE = 1u << HASH_BITS;
+constexpr unsigned MIN_MATCH = 3;
+constexpr unsigned MAX_MATCH = 258;
+constexpr unsigned MIN_LOOKAHEAD = MAX_MATCH + MIN_MATCH + 1;
+constexpr unsigned MAX_DIST = WSIZE - MIN_LOOKAHEAD;
+constexpr unsigned TOO_FAR = 4096;                // 长度为3的远距离匹配不划算
+constexpr size_t SYMBOL_LIMIT = 16383;            // 每块最多符号数
+constexpr size_t OUT_BUF_SIZE = 65536;
+constexpr unsigned END_BLOCK = 256;
+
+constexpr unsigned LONG_MATCH_LENGTH = 128;       // 惰性匹配中超过该长度的匹配只插入末尾
+constexpr unsigned LONG_MATCH_TAIL = 16;          // 超长匹配末尾需要插入哈希链的位置数
+
+/**
+ * 各压缩级别的匹配器参数，与zlib的configuration_table相同，
+ * 只是级别1只探测一次哈希链
+ */
+struct LevelConfig {
+    uint16_t good_length;
+    uint16_t max_lazy;
+    uint16_t nice_length;
+    uint16_t max_chain;
+    bool lazy;
+};
+
+const LevelConfig kLevelConfig[10] = {
+    {0, 0, 0, 0, false},          // 0 不使用
+    {4, 4, 8, 1, false},          // 1 贪心，单次探测
+    {4, 5, 16, 8, false},
+    {4, 6, 32, 32, false},
+    {4, 4, 16, 16, true},         // 4 起使用惰性匹配
+    {8, 16, 32, 32, true},
+    {8, 16, 128, 128, true},      // 6 默认
+    {8, 32, 128, 256, true},
+    {32, 128, 258, 1024, true},
+    {32, 258, 258, 4096, true},   // 9 最高压缩率
+};
+
+// 分块判断参数（取自libdeflate）
+constexpr unsigned LITERAL_OBSERVATION_TYPES = 8;
+constexpr uint32_t OBSERVATIONS_PER_CHECK = 512;
+constexpr uint32_t SMALL_BLOCK_LENGTH = 10000;
+constexpr uint32_t SMALL_BLOCK_OBSERVATIONS = 8192;
+
+constexpr uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+const uint16_t kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr uint8_t kCodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** 长度/距离到编码的查找表，以及固定Huffman码表 */
+struct DeflateTables {
+    uint8_t length_code[MAX_MATCH + 1];
+    uint8_t dist_code[WSIZE + 1];
+    uint8_t fixed_lit_len[288];
+    uint8_t fixed_dist_len[30];
+    uint16_t fixed_lit_code[288];
+    uint16_t fixed_dist_code[30];
+
+    DeflateTables();
+};
+
+uint16_t reverse_bits(uint16_t code, unsigned len) {
+    uint16_t result = 0;
+    for (unsigned i = 0; i < len; i++) {
+        result = static_cast<uint16_t>((result << 1) | (code & 1));
+        code >>= 1;
+    }
+    return result;
+}
+
+/**
+ * 由码长生成规范Huffman码（已按位反转，可直接低位先出）
+ */
+void build_codes(const uint8_t* lens, unsigned n, uint16_t* codes) {
+    uint16_t bl_count[16] = {};
+    for (unsigned i = 0; i < n; i++) bl_count[lens[i]]++;
+    bl_count[0] = 0;
+
+    uint16_t next_code[16] = {};
+    uint16_t code = 0;
+    for (unsigned bits = 1; bits < 16; bits++) {
+        code = static_cast<uint16_t>((code + bl_count[bits - 1]) << 1);
+        next_code[bits] = code;
+    }
+    for (unsigned i = 0; i < n; i++) {
+        codes[i] = lens[i] ? reverse_bits(next_code[lens[i]]++, lens[i]) : 0;
+    }
+}
+
+DeflateTables::DeflateTables() {
+    for (unsigned code = 0; code < 28; code++) {
+        for (unsigned j = 0; j < (1u << kLengthExtra[code]); j++) {
+            length_code[kLengthBase[code] + j] = static_cast<uint8_t>(code);
+        }
+    }
+    length_code[MAX_MATCH] = 28;
+
+    for (unsigned code = 0; code < 30; code++) {
+        for (unsigned j = 0; j < (1u << kDistExtra[code]); j++) {
+            unsigned dist = kDistBase[code] + j;
+            if (dist <= WSIZE) dist_code[dist] = static_cast<uint8_t>(code);
+        }
+    }
+
+    for (unsigned i = 0; i < 288; i++) {
+        fixed_lit_len[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+    }
+    std::fill(fixed_dist_len, fixed_dist_len + 30, 5);
+    build_codes(fixed_lit_len, 288, fixed_lit_code);
+    build_codes(fixed_dist_len, 30, fixed_dist_code);
+}
+
+const DeflateTables& tables() {
+    static const DeflateTables t;
+    return t;
+}
+
+/**
+ * 计算限长Huffman码长
+ *
+ * 先用双队列法构造最优码，超出limit时截断并按Kraft不等式修正
+ */
+void build_lengths(const uint32_t* freq, unsigned n, unsigned limit, uint8_t* lens) {
+    std::fill(lens, lens + n, 0);
+
+    std::vector<unsigned> used;
+    for (unsigned i = 0; i < n; i++) {
+        if (freq[i]) used.push_back(i);
+    }
+    if (used.empty()) return;
+    if (used.size() == 1) {
+        lens[used[0]] = 1;
+        return;
+    }
+
+    std::stable_sort(used.begin(), used.end(),
+                     [freq](unsigned a, unsigned b) { return freq[a] < freq[b]; });
+
+    // 节点0..m-1为叶子，m..2m-2为内部节点
+    const size_t m = used.size();
+    std::vector<uint64_t> weight(2 * m - 1);
+    std::vector<size_t> parent(2 * m - 1, 0);
+    for (size_t i = 0; i < m; i++) weight[i] = freq[used[i]];
+
+    size_t leaf = 0, inner = m, next = m;
+    auto pick = [&]() {
+        if (leaf < m && (inner >= next || weight[leaf] <= weight[inner])) return leaf++;
+        return inner++;
+    };
+    for (; next < 2 * m - 1; next++) {
+        size_t a = pick();
+        size_t b = pick();
+        weight[next] = weight[a] + weight[b];
+        parent[a] = parent[b] = next;
+    }
+
+    std::vector<unsigned> depth(2 * m - 1, 0);
+    unsigned max_len = 0;
+    for (size_t i = 2 * m - 2; i-- > 0;) {
+        depth[i] = depth[parent[i]] + 1;
+        if (i < m) max_len = std::max(max_len, depth[i]);
+    }
+    for (size_t i = 0; i < m; i++) lens[used[i]] = static_cast<uint8_t>(depth[i]);
+    if (max_len <= limit) return;
+
+    // 截断过长的码，再逐个加长较短的码直到满足Kraft不等式
+    uint64_t kraft = 0;
+    for (unsigned sym : used) {
+        if (lens[sym] > limit) lens[sym] = static_cast<uint8_t>(limit);
+        kraft += 1ull << (limit - lens[sym]);
+    }
+    const uint64_t capacity = 1ull << limit;
+    while (kraft > capacity) {
+        unsigned best = n;
+        for (unsigned sym : used) {
+            if (lens[sym] >= limit) continue;
+            if (best == n || lens[sym] > lens[best] ||
+                (lens[sym] == lens[best] && freq[sym] < freq[best])) {
+                best = sym;
+            }
+        }
+        kraft -= 1ull << (limit - lens[best] - 1);
+        lens[best]++;
+    }
+
+    // 上面的修正可能加长过头，使编码不完整（inflate会拒绝），
+    // 再把出现最多的符号缩短，直到码空间恰好用满
+    while (kraft < capacity) {
+        unsigned best = n;
+        for (unsigned sym : used) {
+            if (lens[sym] <= 1 || (1ull << (limit - lens[sym])) > capacity - kraft) continue;
+            if (best == n || freq[sym] > freq[best]) best = sym;
+        }
+        if (best == n) break;
+        kraft += 1ull << (limit - lens[best]);
+        lens[best]--;
+    }
+}
+
+/** 比较两段数据的公共前缀长度 */
+inline unsigned match_length_at(const uint8_t* a, const uint8_t* b, unsigned max_len) {
+    unsigned len = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (len + 8 <= max_len) {
+        uint64_t x, y;
+        std::memcpy(&x, a + len, 8);
+        std::memcpy(&y, b + len, 8);
+        if (x != y) return len + static_cast<unsigned>(__builtin_ctzll(x ^ y) >> 3);
+        len += 8;
+    }
+#endif
+    while (len < max_len && a[len] == b[len]) len++;
+    return len;
+}
+
+/** 码长序列的游程编码项 (符号16/17/18带附加值) */
+struct CodeLengthItem {
+    uint8_t sym;
+    uint8_t extra;
+};
+
+void rle_code_lengths(const uint8_t* lens, unsigned n, std::vector<CodeLengthItem>& items) {
+    unsigned i = 0;
+    while (i < n) {
+        uint8_t cur = lens[i];
+        unsigned run = 1;
+        while (i + run < n && lens[i + run] == cur) run++;
+
+        if (cur == 0) {
+            while (run >= 11) {
+                unsigned r = std::min(run, 138u);
+                items.push_back({18, static_cast<uint8_t>(r - 11)});
+                run -= r;
+                i += r;
+            }
+            if (run >= 3) {
+                items.push_back({17, static_cast<uint8_t>(run - 3)});
+                i += run;
+                run = 0;
+            }
+        } else {
+            items.push_back({cur, 0});
+            i++;
+            run--;
+            while (run >= 3) {
+                unsigned r = std::min(run, 6u);
+                items.push_back({16, static_cast<uint8_t>(r - 3)});
+                run -= r;
+                i += r;
+            }
+        }
+        for (; run > 0; run--, i++) items.push_back({cur, 0});
+    }
+}
+
+unsigned code_length_extra_bits(uint8_t sym) {
+    return sym == 16 ? 2 : sym == 17 ? 3 : sym == 18 ? 7 : 0;
+}
+
+// ============================================================================
+// 常量数据快速路径的编译期码表
+// ============================================================================
+
+/** 已按位反转、可直接低位先出的码字 */
+struct BitCode {
+    uint32_t bits;
+    uint8_t length;
+};
+
+constexpr uint32_t reverse_code(uint32_t code, unsigned len) {
+    uint32_t result = 0;
+    for (unsigned i = 0; i < len; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+/** 固定Huffman码中的字面量/长度符号 */
+constexpr BitCode fixed_symbol(unsigned sym) {
+    return sym < 144 ? BitCode{reverse_code(0x30 + sym, 8), 8}
+         : sym < 256 ? BitCode{reverse_code(0x190 + sym - 144, 9), 9}
+         : sym < 280 ? BitCode{reverse_code(sym - 256, 7), 7}
+         : BitCode{reverse_code(0xC0 + sym - 280, 8), 8};
+}
+
+/** 固定码下每个填充字节的字面量码，以及距离为1的各长度匹配 */
+struct FixedRunTables {
+    BitCode literal[256];
+    BitCode match[MAX_MATCH + 1];  // 长度码 + 附加位 + 距离码0（5个0位）
+};
+
+constexpr FixedRunTables make_fixed_run_tables() {
+    FixedRunTables t{};
+    for (unsigned b = 0; b < 256; b++) t.literal[b] = fixed_symbol(b);
+    for (unsigned code = 0; code < 29; code++) {
+        const BitCode sym = fixed_symbol(257 + code);
+        const unsigned count = code == 28 ? 1 : 1u << kLengthExtra[code];
+        // 258同时落在码27和码28中，按顺序由码28覆盖
+        for (unsigned extra = 0; extra < count && kLengthBase[code] + extra <= MAX_MATCH; extra++) {
+            t.match[kLengthBase[code] + extra] = {
+                sym.bits | (extra << sym.length),
+                static_cast<uint8_t>(sym.length + kLengthExtra[code] + 5)};
+        }
+    }
+    return t;
+}
+
+constexpr FixedRunTables kFixedRun = make_fixed_run_tables();
+
+/** 编译期生成的位串 */
+struct BitString {
+    uint8_t bytes[16] = {};
+    unsigned length = 0;
+
+    constexpr void append(uint32_t value, unsigned count) {
+        for (unsigned i = 0; i < count; i++, length++) {
+            if ((value >> i) & 1) bytes[length / 8] |= static_cast<uint8_t>(1u << (length % 8));
+        }
+    }
+};
+
+/**
+ * 重复块的块头
+ *
+ * 最后一块、动态Huffman：字面量/长度码只有END_BLOCK('0')和285('1')，
+ * 距离码只有0('0')，于是一个距离1、长度258的匹配只占2位。
+ * 码长序列只需要码长码1和18，各占1位
+ */
+constexpr BitString make_repeat_block_header() {
+    constexpr unsigned lit_codes = 286;
+    uint8_t lens[lit_codes + 1] = {};
+    lens[END_BLOCK] = 1;
+    lens[285] = 1;
+    lens[lit_codes] = 1;  // 距离码0
+
+    BitString h;
+    h.append(1, 1);               // BFINAL
+    h.append(2, 2);               // BTYPE=动态
+    h.append(lit_codes - 257, 5);
+    h.append(0, 5);               // 1个距离码
+    h.append(18 - 4, 4);          // 码长码1在发送顺序中排第18
+    for (unsigned i = 0; i < 18; i++) {
+        h.append(kCodeLengthOrder[i] == 1 || kCodeLengthOrder[i] == 18 ? 1 : 0, 3);
+    }
+    for (unsigned i = 0; i <= lit_codes;) {
+        if (lens[i]) {
+            h.append(0, 1);
+            i++;
+            continue;
+        }
+        // 各段0的长度都不小于11，可以全部用符号18表示
+        unsigned run = 0;
+        while (i + run <= lit_codes && !lens[i + run] && run < 138) run++;
+        h.append(1, 1);
+        h.append(run - 11, 7);
+        i += run;
+    }
+    return h;
+}
+
+constexpr BitString kRepeatBlockHeader = make_repeat_block_header();
+constexpr uint32_t REPEAT_MATCH_CODE = 1;
+constexpr unsigned REPEAT_MATCH_BITS = 2;
+
+/** 快速路径的输出缓冲 */
+class RunWriter {
+public:
+    explicit RunWriter(ByteSink& out) : out_(out), buf_(OUT_BUF_SIZE) {}
+
+    void put(uint64_t bits, unsigned count) {
+        bit_buf_ |= bits << bit_count_;
+        bit_count_ += count;
+        while (bit_count_ >= 8) {
+            put_byte(static_cast<uint8_t>(bit_buf_));
+            bit_buf_ >>= 8;
+            bit_count_ -= 8;
+        }
+    }
+
+    void put(const BitString& s) {
+        for (unsigned i = 0; i < s.length / 8; i++) put(s.bytes[i], 8);
+        if (s.length % 8) put(s.bytes[s.length / 8], s.length % 8);
+    }
+
+    /** 直接输出count个相同字节，位缓冲保持不变 */
+    void repeat(uint8_t value, uint64_t count) {
+        while (count > 0 && ok_) {
+            if (pos_ == buf_.size()) flush();
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(count, buf_.size() - pos_));
+            std::memset(buf_.data() + pos_, value, n);
+            pos_ += n;
+            count -= n;
+        }
+    }
+
+    unsigned pending() const { return bit_count_; }
+
+    bool finish() {
+        if (bit_count_) put_byte(static_cast<uint8_t>(bit_buf_));
+        bit_buf_ = 0;
+        bit_count_ = 0;
+        return flush();
+    }
+
+private:
+    void put_byte(uint8_t b) {
+        if (pos_ == buf_.size()) flush();
+        buf_[pos_++] = b;
+    }
+
+    bool flush() {
+        if (pos_ && ok_) ok_ = out_.write(buf_.data(), pos_);
+        pos_ = 0;
+        return ok_;
+    }
+
+    ByteSink& out_;
+    std::vector<uint8_t> buf_;
+    size_t pos_ = 0;
+    uint64_t bit_buf_ = 0;
+    unsigned bit_count_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace
+
+// ============================================================================
+// 编码器实现
+// ============================================================================
+
+DeflateEncoder::DeflateEncoder(ByteSink& out, int level)
+    : out_(out),
+      window_(2 * WSIZE),
+      head_(HASH_SIZE, 0),
+      prev_(WSIZE, 0),
+      out_buf_(OUT_BUF_SIZE) {
+    const LevelConfig& config = kLevelConfig[std::min(std::max(level, 1), 9)];
+    good_length_ = config.good_length;
+    max_lazy_ = config.max_lazy;
+    nice_length_ = config.nice_length;
+    max_chain_ = config.max_chain;
+    lazy_ = config.lazy;
+
+    symbols_.reserve(SYMBOL_LIMIT);
+    std::memset(lit_freq_, 0, sizeof(lit_freq_));
+    std::memset(dist_freq_, 0, sizeof(dist_freq_));
+    std::memset(observations_, 0, sizeof(observations_));
+    std::memset(new_observations_, 0, sizeof(new_observations_));
+}
+
+void DeflateEncoder::set_dictionary(const uint8_t* data, size_t len) {
+    if (finished_ || total_in_ > 0) return;
+    if (len > WSIZE) {
+        data += len - WSIZE;
+        len = WSIZE;
+    }
+    if (len > 0) std::memcpy(&window_[0], data, len);
+    strstart_ = static_cast<unsigned>(len);
+    block_start_ = strstart_;
+    for (unsigned pos = 0; pos + MIN_MATCH <= strstart_; pos++) insert_string(pos);
+}
+
+bool DeflateEncoder::write(const uint8_t* data, size_t len) {
+    if (finished_) return false;
+
+    while (len > 0 && ok_) {
+        if (strstart_ >= WSIZE + MAX_DIST) slide_window();
+
+        size_t space = 2 * WSIZE - (strstart_ + lookahead_);
+        size_t n = std::min(space, len);
+        std::memcpy(&window_[strstart_ + lookahead_], data, n);
+        lookahead_ += static_cast<unsigned>(n);
+        total_in_ += n;
+        data += n;
+        len -= n;
+
+        process(false);
+    }
+    return ok_;
+}
+
+bool DeflateEncoder::finish(bool last) {
+    if (finished_) return ok_;
+    finished_ = true;
+
+    process(true);
+    if (last || !symbols_.empty()) flush_block(last);
+    if (!last) {
+        // 空存储块：3位块头，对齐后LEN=0、NLEN=0xFFFF
+        send_bits(0, 3);
+        align_to_byte();
+        send_bits(0xFFFF0000u, 32);
+    }
+    align_to_byte();
+    flush_output();
+    return ok_;
+}
+
+void DeflateEncoder::slide_window() {
+    std::memcpy(&window_[0], &window_[WSIZE], WSIZE);
+    match_start_ = match_start_ >= WSIZE ? match_start_ - WSIZE : 0;
+    strstart_ -= WSIZE;
+    block_start_ -= WSIZE;
+
+    // 固定长度的饱和减法循环，便于编译器向量化
+    uint16_t* head = head_.data();
+    for (unsigned i = 0; i < HASH_SIZE; i++) head[i] = static_cast<uint16_t>(head[i] >= WSIZE ? head[i] - WSIZE : 0);
+    uint16_t* prev = prev_.data();
+    for (unsigned i = 0; i < WSIZE; i++) prev[i] = static_cast<uint16_t>(prev[i] >= WSIZE ? prev[i] - WSIZE : 0);
+}
+
+unsigned DeflateEncoder::insert_string(unsigned pos) {
+    uint32_t key = (static_cast<uint32_t>(window_[pos]) << 16) |
+                   (static_cast<uint32_t>(window_[pos + 1]) << 8) |
+                   window_[pos + 2];
+    uint32_t h = (key * 2654435761u) >> (32 - HASH_BITS);
+    unsigned old = head_[h];
+    prev_[pos & WMASK] = static_cast<uint16_t>(old);
+    head_[h] = static_cast<uint16_t>(pos);
+    return old;
+}
+
+unsigned DeflateEncoder::longest_match(unsigned cur_match) {
+    unsigned chain = max_chain_;
+    if (prev_length_ >= good_length_) chain = std::max(chain >> 2, 1u);
+
+    unsigned best_len = prev_length_;
+    unsigned max_len = std::min(MAX_MATCH, lookahead_);
+    unsigned nice = std::min(nice_length_, max_len);
+    if (best_len >= max_len) return best_len;
+
+    unsigned limit = strstart_ > MAX_DIST ? strstart_ - MAX_DIST : 0;
+    const uint8_t* scan = &window_[strstart_];
+
+    do {
+        const uint8_t* match = &window_[cur_match];
+        if (match[best_len] != scan[best_len] || match[0] != scan[0] || match[1] != scan[1]) {
+            continue;
+        }
+        unsigned len = match_length_at(scan, match, max_len);
+        if (len > best_len) {
+            match_start_ = cur_match;
+            best_len = len;
+            if (len >= nice) break;
+        }
+    } while ((cur_match = prev_[cur_match & WMASK]) > limit && --chain != 0);
+
+    return best_len;
+}
+
+/**
+ * 按压缩级别选择匹配策略
+ *
+ * 非flush模式下保留MIN_LOOKAHEAD字节前瞻，等待更多输入
+ */
+void DeflateEncoder::process(bool flush) {
+    if (lazy_) {
+        process_lazy(flush);
+    } else {
+        process_greedy(flush);
+    }
+}
+
+/**
+ * 贪心匹配主循环：每个位置找到匹配就立即输出
+ */
+void DeflateEncoder::process_greedy(bool flush) {
+    for (;;) {
+        if (lookahead_ < MIN_LOOKAHEAD && (!flush || lookahead_ == 0)) break;
+
+        unsigned hash_head = 0;
+        if (lookahead_ >= MIN_MATCH) hash_head = insert_string(strstart_);
+
+        prev_length_ = MIN_MATCH - 1;
+        match_length_ = MIN_MATCH - 1;
+        if (hash_head != 0 && strstart_ - hash_head <= MAX_DIST) {
+            match_length_ = longest_match(hash_head);
+        }
+
+        if (match_length_ >= MIN_MATCH) {
+            // 较短的匹配把覆盖的位置全部插入哈希链，较长的只插入最后一个位置
+            const unsigned max_insert = strstart_ + lookahead_ - MIN_MATCH;
+            const unsigned last = strstart_ + match_length_ - 1;
+            unsigned first = strstart_ + 1;
+            if (match_length_ > max_lazy_) first = last;
+            for (unsigned pos = first; pos <= std::min(last, max_insert); pos++) insert_string(pos);
+
+            tally_match(strstart_ - match_start_, match_length_);
+            lookahead_ -= match_length_;
+            strstart_ += match_length_;
+        } else {
+            tally_literal(window_[strstart_]);
+            strstart_++;
+            lookahead_--;
+        }
+        if (symbols_.size() >= SYMBOL_LIMIT || should_end_block()) flush_block(false);
+    }
+}
+
+/**
+ * 惰性匹配主循环：先看下一位置能否找到更长的匹配，再决定输出
+ */
+void DeflateEncoder::process_lazy(bool flush) {
+    for (;;) {
+        if (lookahead_ < MIN_LOOKAHEAD && (!flush || lookahead_ == 0)) break;
+
+        unsigned hash_head = 0;
+        if (lookahead_ >= MIN_MATCH) hash_head = insert_string(strstart_);
+
+        prev_length_ = match_length_;
+        prev_match_ = match_start_;
+        match_length_ = MIN_MATCH - 1;
+
+        if (hash_head != 0 && prev_length_ < max_lazy_ && strstart_ - hash_head <= MAX_DIST) {
+            match_length_ = longest_match(hash_head);
+            if (match_length_ == MIN_MATCH && strstart_ - match_start_ > TOO_FAR) {
+                match_length_ = MIN_MATCH - 1;
+            }
+        }
+
+        if (prev_length_ >= MIN_MATCH && match_length_ <= prev_length_) {
+            // 上一位置的匹配更好：输出它并把覆盖的位置插入哈希链。
+            // 超长匹配只插入末尾若干位置，避免常量数据逐字节维护哈希链
+            unsigned max_insert = strstart_ + lookahead_ - MIN_MATCH;
+            unsigned first = strstart_ + 1;
+            unsigned last = std::min(strstart_ + prev_length_ - 2, max_insert);
+            if (prev_length_ > LONG_MATCH_LENGTH) {
+                first = std::max(first, strstart_ + prev_length_ - 1 - LONG_MATCH_TAIL);
+            }
+            for (unsigned pos = first; pos <= last; pos++) insert_string(pos);
+
+            tally_match(strstart_ - 1 - prev_match_, prev_length_);
+            lookahead_ -= prev_length_ - 1;
+            strstart_ += prev_length_ - 1;
+            match_available_ = false;
+            match_length_ = MIN_MATCH - 1;
+            if (symbols_.size() >= SYMBOL_LIMIT || should_end_block()) flush_block(false);
+        } else if (match_available_) {
+            tally_literal(window_[strstart_ - 1]);
+            if (symbols_.size() >= SYMBOL_LIMIT || should_end_block()) flush_block(false);
+            strstart_++;
+            lookahead_--;
+        } else {
+            match_available_ = true;
+            strstart_++;
+            lookahead_--;
+        }
+    }
+
+    if (flush && match_available_) {
+        tally_literal(window_[strstart_ - 1]);
+        match_available_ = false;
+    }
+}
+
+void DeflateEncoder::tally_literal(uint8_t c) {
+    symbols_.push_back({0, c});
+    lit_freq_[c]++;
+    new_observations_[((c >> 5) & 0x6) | (c & 1)]++;
+    num_new_observations_++;
+}
+
+void DeflateEncoder::tally_match(unsigned dist, unsigned len) {
+    const DeflateTables& t = tables();
+    symbols_.push_back({static_cast<uint16_t>(dist), static_cast<uint16_t>(len - MIN_MATCH)});
+    lit_freq_[257 + t.length_code[len]]++;
+    dist_freq_[t.dist_code[dist]]++;
+    new_observations_[LITERAL_OBSERVATION_TYPES + (len >= 9 ? 1 : 0)]++;
+    num_new_observations_++;
+}
+
+/**
+ * 判断是否应在此处结束当前块
+ *
+ * 每积累OBSERVATIONS_PER_CHECK个新符号，把它们的类别分布与块内已有
+ * 符号比较；差异足够大时说明数据性质变了，单独成块可以使用更合适的
+ * Huffman码（或改用固定码）。与libdeflate不同，这里不按块长度加大
+ * 结束倾向：大量超长匹配的块字节数很大但符号很少，那样会被无谓地切碎
+ */
+bool DeflateEncoder::should_end_block() {
+    if (num_new_observations_ < OBSERVATIONS_PER_CHECK) return false;
+
+    if (num_observations_ > 0) {
+        uint32_t total_delta = 0;
+        for (unsigned i = 0; i < OBSERVATION_TYPES; i++) {
+            const uint32_t expected = observations_[i] * num_new_observations_;
+            const uint32_t actual = new_observations_[i] * num_observations_;
+            total_delta += actual > expected ? actual - expected : expected - actual;
+        }
+
+        const uint32_t block_length = static_cast<uint32_t>(static_cast<int64_t>(strstart_) - block_start_);
+        const uint32_t num_items = num_observations_ + num_new_observations_;
+        uint32_t cutoff = num_new_observations_ * 200 / 512 * num_observations_;
+        if (block_length < SMALL_BLOCK_LENGTH && num_items < SMALL_BLOCK_OBSERVATIONS) {
+            cutoff += static_cast<uint32_t>(static_cast<uint64_t>(cutoff) *
+                                            (SMALL_BLOCK_OBSERVATIONS - num_items) / SMALL_BLOCK_OBSERVATIONS);
+        }
+        if (total_delta >= cutoff) return true;
+    }
+
+    for (unsigned i = 0; i < OBSERVATION_TYPES; i++) {
+        observations_[i] += new_observations_[i];
+        new_observations_[i] = 0;
+    }
+    num_observations_ += num_new_observations_;
+    num_new_observations_ = 0;
+    return false;
+}
+
+/**
+ * 输出一个块：比较动态/固定/存储三种编码的代价后选最短者
+ */
+void DeflateEncoder::flush_block(bool last) {
+    const DeflateTables& t = tables();
+    lit_freq_[END_BLOCK] = 1;
+
+    uint8_t lit_len[288];
+    uint8_t dist_len[30];
+    build_lengths(lit_freq_, 286, 15, lit_len);
+    lit_len[286] = lit_len[287] = 0;
+    build_lengths(dist_freq_, 30, 15, dist_len);
+    if (std::all_of(dist_len, dist_len + 30, [](uint8_t l) { return l == 0; })) {
+        dist_len[0] = 1;  // 没有距离码时保留一个1位码，兼容严格的解码器
+    }
+
+    unsigned hlit = 286;
+    while (hlit > 257 && lit_len[hlit - 1] == 0) hlit--;
+    unsigned hdist = 30;
+    while (hdist > 1 && dist_len[hdist - 1] == 0) hdist--;
+
+    uint8_t all_lens[286 + 30];
+    std::memcpy(all_lens, lit_len, hlit);
+    std::memcpy(all_lens + hlit, dist_len, hdist);
+    std::vector<CodeLengthItem> items;
+    rle_code_lengths(all_lens, hlit + hdist, items);
+
+    uint32_t cl_freq[19] = {};
+    for (const auto& item : items) cl_freq[item.sym]++;
+    uint8_t cl_len[19];
+    build_lengths(cl_freq, 19, 7, cl_len);
+    unsigned hclen = 19;
+    while (hclen > 4 && cl_len[kCodeLengthOrder[hclen - 1]] == 0) hclen--;
+
+    // 计算各编码方式的位数
+    auto data_bits = [&](const uint8_t* ll, const uint8_t* dl) {
+        uint64_t bits = 0;
+        for (unsigned i = 0; i < 286; i++) {
+            bits += static_cast<uint64_t>(lit_freq_[i]) * ll[i];
+            if (i >= 257) bits += static_cast<uint64_t>(lit_freq_[i]) * kLengthExtra[i - 257];
+        }
+        for (unsigned i = 0; i < 30; i++) {
+            bits += static_cast<uint64_t>(dist_freq_[i]) * (dl[i] + kDistExtra[i]);
+        }
+        return bits;
+    };
+
+    uint64_t dyn_bits = 3 + 5 + 5 + 4 + 3ull * hclen + data_bits(lit_len, dist_len);
+    for (const auto& item : items) dyn_bits += cl_len[item.sym] + code_length_extra_bits(item.sym);
+    uint64_t fixed_bits = 3 + data_bits(t.fixed_lit_len, t.fixed_dist_len);
+
+    uint64_t stored_len = static_cast<uint64_t>(static_cast<int64_t>(strstart_) - block_start_);
+    bool can_store = block_start_ >= 0;
+    uint64_t stored_blocks = std::max<uint64_t>(1, (stored_len + 65534) / 65535);
+    uint64_t stored_bits = stored_blocks * (3 + 7 + 32) + 8 * stored_len;
+
+    if (can_store && stored_bits < std::min(dyn_bits, fixed_bits)) {
+        const uint8_t* src = &window_[static_cast<size_t>(block_start_)];
+        uint64_t remaining = stored_len;
+        do {
+            unsigned chunk = static_cast<unsigned>(std::min<uint64_t>(remaining, 65535));
+            remaining -= chunk;
+            send_bits((last && remaining == 0) ? 1 : 0, 3);
+            align_to_byte();
+            send_bits(chunk, 16);
+            send_bits(~chunk & 0xFFFF, 16);
+            align_to_byte();
+            while (chunk > 0) {
+                if (out_pos_ == out_buf_.size()) flush_output();
+                size_t n = std::min<size_t>(chunk, out_buf_.size() - out_pos_);
+                std::memcpy(&out_buf_[out_pos_], src, n);
+                out_pos_ += n;
+                src += n;
+                chunk -= static_cast<unsigned>(n);
+            }
+        } while (remaining > 0);
+    } else {
+        uint16_t dyn_lit_code[288];
+        uint16_t dyn_dist_code[30];
+        const uint8_t* ll;
+        const uint8_t* dl;
+        const uint16_t* lc;
+        const uint16_t* dc;
+
+        if (dyn_bits < fixed_bits) {
+            build_codes(lit_len, 288, dyn_lit_code);
+            build_codes(dist_len, 30, dyn_dist_code);
+            uint16_t cl_code[19];
+            build_codes(cl_len, 19, cl_code);
+
+            send_bits((last ? 1 : 0) | (2 << 1), 3);
+            send_bits(hlit - 257, 5);
+            send_bits(hdist - 1, 5);
+            send_bits(hclen - 4, 4);
+            for (unsigned i = 0; i < hclen; i++) send_bits(cl_len[kCodeLengthOrder[i]], 3);
+            for (const auto& item : items) {
+                send_bits(cl_code[item.sym], cl_len[item.sym]);
+                unsigned extra = code_length_extra_bits(item.sym);
+                if (extra) send_bits(item.extra, extra);
+            }
+            ll = lit_len;
+            dl = dist_len;
+            lc = dyn_lit_code;
+            dc = dyn_dist_code;
+        } else {
+            send_bits((last ? 1 : 0) | (1 << 1), 3);
+            ll = t.fixed_lit_len;
+            dl = t.fixed_dist_len;
+            lc = t.fixed_lit_code;
+            dc = t.fixed_dist_code;
+        }
+
+        for (const Symbol& s : symbols_) {
+            if (s.dist == 0) {
+                send_bits(lc[s.lc], ll[s.lc]);
+            } else {
+                unsigned len = s.lc + MIN_MATCH;
+                unsigned code = t.length_code[len];
+                send_bits(lc[257 + code], ll[257 + code]);
+                if (kLengthExtra[code]) send_bits(len - kLengthBase[code], kLengthExtra[code]);
+                unsigned dcode = t.dist_code[s.dist];
+                send_bits(dc[dcode], dl[dcode]);
+                if (kDistExtra[dcode]) send_bits(s.dist - kDistBase[dcode], kDistExtra[dcode]);
+            }
+        }
+        send_bits(lc[END_BLOCK], ll[END_BLOCK]);
+    }
+
+    symbols_.clear();
+    std::memset(lit_freq_, 0, sizeof(lit_freq_));
+    std::memset(dist_freq_, 0, sizeof(dist_freq_));
+    std::memset(observations_, 0, sizeof(observations_));
+    std::memset(new_observations_, 0, sizeof(new_observations_));
+    num_observations_ = 0;
+    num_new_observations_ = 0;
+    block_start_ = strstart_;
+}
+
+// ============================================================================
+// 位输出
+// ============================================================================
+
+void DeflateEncoder::send_bits(uint64_t value, unsigned count) {
+    bit_buf_ |= value << bit_count_;
+    bit_count_ += count;
+    if (bit_count_ >= 32) {
+        if (out_pos_ + 4 > out_buf_.size()) flush_output();
+        for (int i = 0; i < 4; i++) {
+            out_buf_[out_pos_++] = static_cast<uint8_t>(bit_buf_);
+            bit_buf_ >>= 8;
+        }
+        bit_count_ -= 32;
+    }
+}
+
+void DeflateEncoder::align_to_byte() {
+    while (bit_count_ > 0) {
+        if (out_pos_ == out_buf_.size()) flush_output();
+        out_buf_[out_pos_++] = static_cast<uint8_t>(bit_buf_);
+        bit_buf_ >>= 8;
+        bit_count_ = bit_count_ > 8 ? bit_count_ - 8 : 0;
+    }
+    bit_buf_ = 0;
+}
+
+bool DeflateEncoder::flush_output() {
+    if (out_pos_ > 0) {
+        if (ok_ && !out_.write(out_buf_.data(), out_pos_)) ok_ = false;
+        total_out_ += out_pos_;
+        out_pos_ = 0;
+    }
+    return ok_;
+}
+
+// ============================================================================
+// 常量数据快速路径
+// ============================================================================
+
+/**
+ * 第一块(固定码)放首字节的字面量和不足258字节的零头，
+ * 第二块全部是距离1、长度258的匹配。从位缓冲对齐到字节
+ * (余0位)或余1位('0')开始，每4个匹配恰好构成同一个字节，
+ * 主体因此可以整段memset
+ */
+bool deflate_constant_run(ByteSink& out, uint8_t byte, uint64_t length) {
+    RunWriter w(out);
+    if (length == 0) {
+        w.put(1 | (1 << 1), 3);  // 最后一块、固定码，只有END_BLOCK
+        w.put(0, 7);
+        return w.finish();
+    }
+
+    const uint64_t matches = (length - 1) / MAX_MATCH;
+    const unsigned tail = static_cast<unsigned>((length - 1) % MAX_MATCH);
+    const BitCode& literal = kFixedRun.literal[byte];
+
+    w.put((matches == 0 ? 1 : 0) | (1 << 1), 3);
+    w.put(literal.bits, literal.length);
+    if (tail >= MIN_MATCH) {
+        w.put(kFixedRun.match[tail].bits, kFixedRun.match[tail].length);
+    } else {
+        for (unsigned i = 0; i < tail; i++) w.put(literal.bits, literal.length);
+    }
+    w.put(0, 7);  // END_BLOCK
+    if (matches == 0) return w.finish();
+
+    w.put(kRepeatBlockHeader);
+    uint64_t remaining = matches;
+    bool emitted = false;
+    while (remaining > 0 && !(w.pending() == 0 || (w.pending() == 1 && emitted))) {
+        w.put(REPEAT_MATCH_CODE, REPEAT_MATCH_BITS);
+        remaining--;
+        emitted = true;
+    }
+    w.repeat(w.pending() == 0 ? 0x55 : 0xAA, remaining / 4);
+    for (remaining %= 4; remaining > 0; remaining--) w.put(REPEAT_MATCH_CODE, REPEAT_MATCH_BITS);
+    w.put(0, 1);  // END_BLOCK
+    return w.finish();
+}
+
+uint64_t deflate_constant_run_size(uint8_t byte, uint64_t length) {
+    if (length == 0) return 2;
+
+    const uint64_t matches = (length - 1) / MAX_MATCH;
+    const unsigned tail = static_cast<unsigned>((length - 1) % MAX_MATCH);
+    const unsigned literal_bits = kFixedRun.literal[byte].length;
+
+    uint64_t bits = 3 + literal_bits + 7;
+    bits += tail >= MIN_MATCH ? kFixedRun.match[tail].length : tail * literal_bits;
+    if (matches > 0) bits += kRepeatBlockHeader.length + matches * REPEAT_MATCH_BITS + 1;
+    return (bits + 7) / 8;
+}
+
+uint64_t deflate_bound(uint64_t length) {
+    // 每块取存储、固定和动态码表中最小者，不超过固定码表：每字节至多9位。
+    // 块至少含OBSERVATIONS_PER_CHECK个符号，块头、块尾、对齐及分块压缩的同步刷新
+    // 合计不超过每256字节1字节
+    return length + (length >> 3) + (length >> 8) + 16;
+}
+
+} // namespace ZipBombGenerator
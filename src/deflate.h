@@ -0,0 +1,176 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 流式DEFLATE编码器 (RFC 1951)
+ *
+ * 功能: 分块输入、增量输出的DEFLATE压缩器，支持固定/动态Huffman块
+ * 说明: 32KB滑动窗口，最长匹配258字节，输出可被任何标准inflate解压
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_DEFLATE_H
+#define ZIPBOMB_DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/**
+ * 字节输出接口
+ *
+ * 压缩器等流式组件通过它把数据交给下一级（文件、内存、CRC等）
+ */
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+
+    /**
+     * 写入一段数据
+     *
+     * @return 成功返回true
+     */
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * 流式DEFLATE编码器
+ *
+ * 用法: 多次调用write()送入数据，最后调用finish()结束流。
+ * 压缩结果通过ByteSink增量输出，内部只保留窗口和一个块的符号缓冲。
+ * 压缩级别按zlib的方式选择匹配策略：1-3为贪心匹配，4-9为惰性匹配，
+ * 级别越高哈希链越长、越慢、压缩率越高
+ */
+class DeflateEncoder {
+public:
+    /**
+     * @param out 压缩结果的输出端
+     * @param level 压缩级别(1-9)，超出范围时取最近的有效值
+     */
+    explicit DeflateEncoder(ByteSink& out, int level = 6);
+
+    DeflateEncoder(const DeflateEncoder&) = delete;
+    DeflateEncoder& operator=(const DeflateEncoder&) = delete;
+
+    /**
+     * 预设字典：匹配可以引用这段数据，但它本身不输出
+     *
+     * 只能在第一次write()之前调用，超过窗口大小时只取末尾部分
+     */
+    void set_dictionary(const uint8_t* data, size_t len);
+
+    /** 送入一段未压缩数据 */
+    bool write(const uint8_t* data, size_t len);
+
+    /**
+     * 压缩剩余数据并结束流
+     *
+     * @param last true时写出最后一个块；false时以同步刷新结束（非最后块
+     *             之后补一个空的存储块），输出对齐到字节，可以直接拼接
+     *             另一段独立压缩的流
+     */
+    bool finish(bool last = true);
+
+    /** 已送入的未压缩字节数 */
+    uint64_t total_in() const { return total_in_; }
+
+    /** 已输出的压缩字节数 */
+    uint64_t total_out() const { return total_out_; }
+
+private:
+    struct Symbol {
+        uint16_t dist;   // 0表示字面量
+        uint16_t lc;     // 字面量或(匹配长度-3)
+    };
+
+    void process(bool flush);
+    void process_greedy(bool flush);
+    void process_lazy(bool flush);
+    void slide_window();
+    unsigned insert_string(unsigned pos);
+    unsigned longest_match(unsigned cur_match);
+    void tally_literal(uint8_t c);
+    void tally_match(unsigned dist, unsigned len);
+    bool should_end_block();
+    void flush_block(bool last);
+
+    void send_bits(uint64_t value, unsigned count);
+    void align_to_byte();
+    bool flush_output();
+
+    ByteSink& out_;
+    bool ok_ = true;
+    bool finished_ = false;
+
+    // 由压缩级别决定的匹配器参数
+    unsigned good_length_;      // 上一匹配达到该长度时只搜索1/4的链
+    unsigned max_lazy_;         // 惰性匹配：不再尝试更好匹配的长度；贪心：完整插入哈希链的最大匹配长度
+    unsigned nice_length_;      // 找到该长度的匹配即停止搜索
+    unsigned max_chain_;        // 哈希链最大搜索次数
+    bool lazy_;
+
+    // 滑动窗口与哈希链
+    std::vector<uint8_t> window_;
+    std::vector<uint16_t> head_;
+    std::vector<uint16_t> prev_;
+    unsigned strstart_ = 0;
+    unsigned lookahead_ = 0;
+    int64_t block_start_ = 0;
+
+    // 惰性匹配状态
+    unsigned match_start_ = 0;
+    unsigned match_length_ = 2;
+    unsigned prev_length_ = 2;
+    unsigned prev_match_ = 0;
+    bool match_available_ = false;
+
+    // 当前块的符号和频率
+    std::vector<Symbol> symbols_;
+    uint32_t lit_freq_[288];
+    uint32_t dist_freq_[30];
+
+    // 分块统计：按符号类别比较新近符号与当前块的分布，差异大时提前结束块
+    static constexpr unsigned OBSERVATION_TYPES = 10;
+    uint32_t observations_[OBSERVATION_TYPES];
+    uint32_t new_observations_[OBSERVATION_TYPES];
+    uint32_t num_observations_ = 0;
+    uint32_t num_new_observations_ = 0;
+
+    // 位输出缓冲
+    uint64_t bit_buf_ = 0;
+    unsigned bit_count_ = 0;
+    std::vector<uint8_t> out_buf_;
+    size_t out_pos_ = 0;
+
+    uint64_t total_in_ = 0;
+    uint64_t total_out_ = 0;
+};
+
+/**
+ * 常量数据的DEFLATE快速路径
+ *
+ * 把length个byte直接编码成DEFLATE流，不经过匹配查找：除首字节和零头外，
+ * 全部内容都是同一个字节的重复，耗时与压缩后大小成正比
+ *
+ * @param out 输出目标
+ * @param byte 填充字节
+ * @param length 未压缩字节数
+ * @return 成功返回true
+ */
+bool deflate_constant_run(ByteSink& out, uint8_t byte, uint64_t length);
+
+/**
+ * deflate_constant_run()输出的精确字节数
+ */
+uint64_t deflate_constant_run_size(uint8_t byte, uint64_t length);
+
+/**
+ * 任意length字节经DeflateEncoder（含分块压缩）压缩后大小的上界
+ *
+ * 不读取内容，用于预先估算磁盘空间
+ */
+uint64_t deflate_bound(uint64_t length);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_DEFLATE_H */
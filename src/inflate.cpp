@@ -0,0 +1,409 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - DEFLATE解码器实现
+ *
+ * 说明: 位缓冲为64位，输入剩余8字节以上时一次装入整字，每个符号之前
+ *       装满一次即可解出长度、距离及其附加位（最多48位）；输入末尾之后
+ *       按0补齐，最后按实际消耗的位数判断是否截断。
+ *       码表项: 低4位为消耗的位数（0表示无效码），第4位置位时指向子表，
+ *       此时第8-11位为子表索引位数、高16位为子表起点，否则高16位为符号
+ * ============================================================================
+ */
+
+#include "inflate.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr size_t WINDOW_SIZE = 32768;
+constexpr size_t OUTPUT_BUFFER = 256 * 1024;
+constexpr unsigned MAX_MATCH = 258;
+constexpr unsigned COPY_SLACK = 8;            // 按8字节复制匹配时可能多写的字节
+constexpr unsigned MAX_CODE_LENGTH = 15;
+
+constexpr unsigned LITLEN_TABLE_BITS = 10;
+constexpr unsigned DIST_TABLE_BITS = 8;
+constexpr unsigned PRECODE_TABLE_BITS = 7;
+
+constexpr uint32_t ENTRY_SUBTABLE = 0x10;
+
+/** 码表预留的表项数，足以容纳任何合法码长下的一级表和全部子表 */
+constexpr size_t TABLE_RESERVE = 2048;
+
+const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/** 码长码的码长在块头中的排列顺序 */
+const uint8_t PRECODE_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+inline uint32_t reverse_bits(uint32_t code, unsigned length) {
+    uint32_t reversed = 0;
+    for (unsigned i = 0; i < length; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    return reversed;
+}
+
+/**
+ * 由各符号的码长构造两级解码表
+ *
+ * 不完整的码是允许的（未使用的表项保持无效），超额的码返回false
+ */
+bool build_table(const uint8_t* lengths, unsigned count, unsigned table_bits, std::vector<uint32_t>& table) {
+    unsigned length_count[MAX_CODE_LENGTH + 1] = {};
+    for (unsigned i = 0; i < count; i++) length_count[lengths[i]]++;
+    length_count[0] = 0;
+
+    int left = 1;
+    for (unsigned len = 1; len <= MAX_CODE_LENGTH; len++) {
+        left = (left << 1) - static_cast<int>(length_count[len]);
+        if (left < 0) return false;
+    }
+
+    uint32_t next_code[MAX_CODE_LENGTH + 1];
+    uint32_t code = 0;
+    next_code[0] = 0;
+    for (unsigned len = 1; len <= MAX_CODE_LENGTH; len++) {
+        code = (code + length_count[len - 1]) << 1;
+        next_code[len] = code;
+    }
+
+    // 先求出每个前缀下最长的码，确定各子表的大小
+    const uint32_t primary_size = 1u << table_bits;
+    const uint32_t primary_mask = primary_size - 1;
+    uint32_t codes[288];
+    uint8_t sub_bits[1u << LITLEN_TABLE_BITS] = {};
+    for (unsigned symbol = 0; symbol < count; symbol++) {
+        const unsigned len = lengths[symbol];
+        if (!len) continue;
+        codes[symbol] = reverse_bits(next_code[len]++, len);
+        if (len > table_bits) {
+            uint8_t& bits = sub_bits[codes[symbol] & primary_mask];
+            bits = std::max(bits, static_cast<uint8_t>(len - table_bits));
+        }
+    }
+
+    uint32_t size = primary_size;
+    uint32_t sub_start[1u << LITLEN_TABLE_BITS];
+    for (uint32_t prefix = 0; prefix < primary_size; prefix++) {
+        if (!sub_bits[prefix]) continue;
+        sub_start[prefix] = size;
+        size += 1u << sub_bits[prefix];
+    }
+    table.assign(size, 0);
+    for (uint32_t prefix = 0; prefix < primary_size; prefix++) {
+        if (!sub_bits[prefix]) continue;
+        table[prefix] = (sub_start[prefix] << 16) | (static_cast<uint32_t>(sub_bits[prefix]) << 8) |
+                        ENTRY_SUBTABLE | table_bits;
+    }
+
+    for (unsigned symbol = 0; symbol < count; symbol++) {
+        const unsigned len = lengths[symbol];
+        if (!len) continue;
+        const uint32_t reversed = codes[symbol];
+        if (len <= table_bits) {
+            for (uint32_t i = reversed; i < primary_size; i += 1u << len) table[i] = (symbol << 16) | len;
+        } else {
+            const uint32_t prefix = reversed & primary_mask;
+            const unsigned sub_len = len - table_bits;
+            const uint32_t sub_size = 1u << sub_bits[prefix];
+            for (uint32_t i = reversed >> table_bits; i < sub_size; i += 1u << sub_len) {
+                table[sub_start[prefix] + i] = (symbol << 16) | sub_len;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+InflateDecoder::InflateDecoder() : window_(OUTPUT_BUFFER + MAX_MATCH + COPY_SLACK) {
+    litlen_.reserve(TABLE_RESERVE);
+    dist_.reserve(TABLE_RESERVE);
+    precode_.reserve(1u << PRECODE_TABLE_BITS);
+    uint8_t lengths[288];
+    std::fill(lengths, lengths + 144, 8);
+    std::fill(lengths + 144, lengths + 256, 9);
+    std::fill(lengths + 256, lengths + 280, 7);
+    std::fill(lengths + 280, lengths + 288, 8);
+    build_table(lengths, 288, LITLEN_TABLE_BITS, fixed_litlen_);
+    std::fill(lengths, lengths + 32, 5);
+    build_table(lengths, 32, DIST_TABLE_BITS, fixed_dist_);
+}
+
+// ============================================================================
+// 位流
+// ============================================================================
+
+bool InflateDecoder::BitStream::refill_slow() {
+    while (count <= 56) {
+        // 已补了8个字节的0仍不够，实际消耗必然越过了输入末尾
+        if (pos >= len + 8) return false;
+        const uint64_t byte = pos < len ? in[pos] : 0;
+        buf |= byte << count;
+        pos++;
+        count += 8;
+    }
+    return true;
+}
+
+/** 装满位缓冲（至少57位） */
+inline bool InflateDecoder::BitStream::refill() {
+    if (len - std::min(pos, len) < 8) return refill_slow();
+    // 整字装入；超出计数的高位是后面字节的内容，下次装入时原样覆盖
+    const unsigned bytes = (63 - count) >> 3;
+    uint64_t word;
+    std::memcpy(&word, in + pos, sizeof(word));
+    buf |= word << count;
+    pos += bytes;
+    count += bytes * 8;
+    return true;
+}
+
+inline void InflateDecoder::BitStream::consume(unsigned bits) {
+    buf >>= bits;
+    count -= bits;
+}
+
+inline uint32_t InflateDecoder::BitStream::take(unsigned bits) {
+    const uint32_t value = static_cast<uint32_t>(buf) & ((1u << bits) - 1);
+    consume(bits);
+    return value;
+}
+
+inline bool InflateDecoder::BitStream::decode(const uint32_t* table, unsigned table_bits, unsigned& symbol) {
+    uint32_t entry = table[static_cast<uint32_t>(buf) & ((1u << table_bits) - 1)];
+    if (entry & ENTRY_SUBTABLE) {
+        consume(table_bits);
+        const unsigned sub_bits = (entry >> 8) & 0xF;
+        entry = table[(entry >> 16) + (static_cast<uint32_t>(buf) & ((1u << sub_bits) - 1))];
+    }
+    const unsigned length = entry & 0xF;
+    if (!length) return false;
+    consume(length);
+    symbol = entry >> 16;
+    return true;
+}
+
+// ============================================================================
+// 输出窗口
+// ============================================================================
+
+/** 把未输出的部分交给输出端，只留32KB历史 */
+bool InflateDecoder::flush_window(ByteSink& out) {
+    if (out_pos_ > flushed_) {
+        if (!out.write(window_.data() + flushed_, out_pos_ - flushed_)) return false;
+        total_out_ += out_pos_ - flushed_;
+    }
+    if (out_pos_ > WINDOW_SIZE) {
+        std::memmove(window_.data(), window_.data() + out_pos_ - WINDOW_SIZE, WINDOW_SIZE);
+        out_pos_ = WINDOW_SIZE;
+    }
+    flushed_ = out_pos_;
+    return true;
+}
+
+// ============================================================================
+// 块
+// ============================================================================
+
+InflateDecoder::Status InflateDecoder::stored_block(ByteSink& out) {
+    bits_.consume(bits_.count & 7);
+    if (!bits_.refill()) return Status::Truncated;
+    const uint32_t length = bits_.take(16);
+    const uint32_t complement = bits_.take(16);
+    if (length != (~complement & 0xFFFF)) return Status::Corrupt;
+
+    // 位缓冲中剩余的整字节退回输入
+    const size_t pos = bits_.pos - bits_.count / 8;
+    if (pos > bits_.len || bits_.len - pos < length) return Status::Truncated;
+    bits_.buf = 0;
+    bits_.count = 0;
+    bits_.pos = pos + length;
+
+    const uint8_t* src = bits_.in + pos;
+    size_t remaining = length;
+    while (remaining) {
+        if (out_pos_ >= OUTPUT_BUFFER && !flush_window(out)) return Status::Stopped;
+        const size_t n = std::min(remaining, OUTPUT_BUFFER - out_pos_);
+        std::memcpy(window_.data() + out_pos_, src, n);
+        out_pos_ += n;
+        src += n;
+        remaining -= n;
+    }
+    return Status::Ok;
+}
+
+InflateDecoder::Status InflateDecoder::read_dynamic_tables() {
+    if (!bits_.refill()) return Status::Truncated;
+    const unsigned litlen_count = bits_.take(5) + 257;
+    const unsigned dist_count = bits_.take(5) + 1;
+    const unsigned precode_count = bits_.take(4) + 4;
+    if (litlen_count > 286 || dist_count > 30) return Status::Corrupt;
+
+    uint8_t precode_lengths[19] = {};
+    for (unsigned i = 0; i < precode_count; i++) {
+        if (!bits_.refill()) return Status::Truncated;
+        precode_lengths[PRECODE_ORDER[i]] = static_cast<uint8_t>(bits_.take(3));
+    }
+    if (!build_table(precode_lengths, 19, PRECODE_TABLE_BITS, precode_)) return Status::Corrupt;
+
+    uint8_t lengths[286 + 30];
+    const unsigned total = litlen_count + dist_count;
+    unsigned i = 0;
+    while (i < total) {
+        if (!bits_.refill()) return Status::Truncated;
+        unsigned symbol;
+        if (!bits_.decode(precode_.data(), PRECODE_TABLE_BITS, symbol)) return Status::Corrupt;
+        if (symbol < 16) {
+            lengths[i++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        uint8_t value = 0;
+        unsigned repeat;
+        if (symbol == 16) {
+            if (i == 0) return Status::Corrupt;
+            value = lengths[i - 1];
+            repeat = 3 + bits_.take(2);
+        } else if (symbol == 17) {
+            repeat = 3 + bits_.take(3);
+        } else {
+            repeat = 11 + bits_.take(7);
+        }
+        if (repeat > total - i) return Status::Corrupt;
+        std::memset(lengths + i, value, repeat);
+        i += repeat;
+    }
+    if (lengths[256] == 0) return Status::Corrupt;  // 块结束符必须有码
+
+    if (!build_table(lengths, litlen_count, LITLEN_TABLE_BITS, litlen_) ||
+        !build_table(lengths + litlen_count, dist_count, DIST_TABLE_BITS, dist_)) {
+        return Status::Corrupt;
+    }
+    return Status::Ok;
+}
+
+InflateDecoder::Status InflateDecoder::huffman_block(const std::vector<uint32_t>& litlen_table,
+                                                     const std::vector<uint32_t>& dist_table, ByteSink& out) {
+    uint8_t* const window = window_.data();
+    const uint32_t* const litlen = litlen_table.data();
+    const uint32_t* const dist = dist_table.data();
+    BitStream bits = bits_;
+    size_t out_pos = out_pos_;
+    Status status;
+    for (;;) {
+        if (out_pos >= OUTPUT_BUFFER) {
+            out_pos_ = out_pos;
+            if (!flush_window(out)) {
+                status = Status::Stopped;
+                break;
+            }
+            out_pos = out_pos_;
+        }
+        if (!bits.refill()) {
+            status = Status::Truncated;
+            break;
+        }
+
+        unsigned symbol;
+        if (!bits.decode(litlen, LITLEN_TABLE_BITS, symbol)) {
+            status = Status::Corrupt;
+            break;
+        }
+        if (symbol < 256) {
+            window[out_pos++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        if (symbol == 256) {
+            status = Status::Ok;
+            break;
+        }
+        symbol -= 257;
+        if (symbol >= 29) {
+            status = Status::Corrupt;
+            break;
+        }
+        const unsigned length = LENGTH_BASE[symbol] + bits.take(LENGTH_EXTRA[symbol]);
+
+        if (!bits.decode(dist, DIST_TABLE_BITS, symbol) || symbol >= 30) {
+            status = Status::Corrupt;
+            break;
+        }
+        const size_t distance = DIST_BASE[symbol] + bits.take(DIST_EXTRA[symbol]);
+        if (distance > out_pos) {
+            status = Status::Corrupt;
+            break;
+        }
+
+        uint8_t* dst = window + out_pos;
+        const uint8_t* src = dst - distance;
+        if (distance == 1) {
+            std::memset(dst, *src, length);
+        } else if (distance >= COPY_SLACK) {
+            // 每次复制的8字节都已写出，重叠时也正确；末尾可能多写几个字节
+            for (unsigned i = 0; i < length; i += COPY_SLACK) std::memcpy(dst + i, src + i, COPY_SLACK);
+        } else {
+            for (unsigned i = 0; i < length; i++) dst[i] = src[i];
+        }
+        out_pos += length;
+    }
+    bits_ = bits;
+    out_pos_ = out_pos;
+    return status;
+}
+
+InflateDecoder::Status InflateDecoder::inflate(const uint8_t* data, size_t len, ByteSink& out) {
+    bits_ = BitStream();
+    bits_.in = data;
+    bits_.len = len;
+    out_pos_ = 0;
+    flushed_ = 0;
+    total_in_ = 0;
+    total_out_ = 0;
+
+    bool last = false;
+    while (!last) {
+        if (!bits_.refill()) return Status::Truncated;
+        last = bits_.take(1) != 0;
+        const uint32_t type = bits_.take(2);
+
+        Status status;
+        if (type == 0) {
+            status = stored_block(out);
+        } else if (type == 1) {
+            status = huffman_block(fixed_litlen_, fixed_dist_, out);
+        } else if (type == 2) {
+            status = read_dynamic_tables();
+            if (status == Status::Ok) status = huffman_block(litlen_, dist_, out);
+        } else {
+            status = Status::Corrupt;
+        }
+        if (status != Status::Ok) return status;
+    }
+
+    // 补齐的0被当作数据用掉说明输入被截断
+    const uint64_t consumed_bits = static_cast<uint64_t>(bits_.pos) * 8 - bits_.count;
+    if (consumed_bits > static_cast<uint64_t>(len) * 8) return Status::Truncated;
+    total_in_ = (consumed_bits + 7) / 8;
+    return flush_window(out) ? Status::Ok : Status::Stopped;
+}
+
+} // namespace ZipBombGenerator
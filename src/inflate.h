@@ -0,0 +1,102 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - DEFLATE解码器 (RFC 1951)
+ *
+ * 功能: 解压内存中的一段原始DEFLATE流，结果经固定大小的输出窗口分段
+ *       交给ByteSink，不保留完整的解压结果
+ * 说明: 两级查表解码Huffman码；输出窗口256KB（含32KB历史），解码器
+ *       多次使用时窗口和码表都复用，不再分配内存
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_INFLATE_H
+#define ZIPBOMB_INFLATE_H
+
+#include "deflate.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/**
+ * DEFLATE解码器
+ *
+ * 输出端的write()返回false时立即停止解压，用于按预算提前中止
+ */
+class InflateDecoder {
+public:
+    enum class Status {
+        Ok,          // 流正常结束
+        Corrupt,     // 数据不符合DEFLATE格式
+        Truncated,   // 输入在流结束之前用完
+        Stopped      // 输出端要求停止
+    };
+
+    InflateDecoder();
+
+    InflateDecoder(const InflateDecoder&) = delete;
+    InflateDecoder& operator=(const InflateDecoder&) = delete;
+
+    /**
+     * 解压一个完整的流
+     *
+     * @param data 压缩数据
+     * @param len 可读的字节数，流结束之后的字节不读
+     * @param out 输出端
+     */
+    Status inflate(const uint8_t* data, size_t len, ByteSink& out);
+
+    /** 最近一次解压读入的字节数（到最后一个块结束的字节边界） */
+    uint64_t total_in() const { return total_in_; }
+
+    /** 最近一次解压交给输出端的字节数 */
+    uint64_t total_out() const { return total_out_; }
+
+private:
+    /**
+     * 输入位流
+     *
+     * 解码循环把它复制到局部变量里使用：输出窗口按字节写入，若位缓冲是
+     * 成员，每写一个字节编译器都要重新读写它
+     */
+    struct BitStream {
+        const uint8_t* in = nullptr;
+        size_t len = 0;
+        size_t pos = 0;              // 已装入位缓冲的字节（可能越过末尾，越过部分按0补齐）
+        uint64_t buf = 0;
+        unsigned count = 0;
+
+        bool refill_slow();
+        bool refill();
+        void consume(unsigned bits);
+        uint32_t take(unsigned bits);
+        bool decode(const uint32_t* table, unsigned table_bits, unsigned& symbol);
+    };
+
+    Status stored_block(ByteSink& out);
+    Status read_dynamic_tables();
+    Status huffman_block(const std::vector<uint32_t>& litlen, const std::vector<uint32_t>& dist, ByteSink& out);
+    bool flush_window(ByteSink& out);
+
+    BitStream bits_;
+
+    // 输出窗口：[0, flushed_)已交给输出端，其中末尾32KB是匹配可以引用的历史
+    std::vector<uint8_t> window_;
+    size_t out_pos_ = 0;
+    size_t flushed_ = 0;
+
+    // 码表
+    std::vector<uint32_t> fixed_litlen_;
+    std::vector<uint32_t> fixed_dist_;
+    std::vector<uint32_t> litlen_;
+    std::vector<uint32_t> dist_;
+    std::vector<uint32_t> precode_;
+
+    uint64_t total_in_ = 0;
+    uint64_t total_out_ = 0;
+};
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_INFLATE_H */
@@ -0,0 +1,222 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档快速检查实现
+ *
+ * 说明: 中央目录的定位和解析见zip_directory.h。条目数据重叠的检查在
+ *       本地头偏移单调递增时逐条完成，否则再遍历一次，把各条目的范围
+ *       排序后比较
+ * ============================================================================
+ */
+
+#include "zipbomb_inspect.h"
+#include "zip_directory.h"
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+/** 默认预算 */
+constexpr uint64_t BUDGET_TOTAL_UNCOMPRESSED = 4ULL << 30;
+constexpr uint64_t BUDGET_ENTRY_UNCOMPRESSED = 1ULL << 30;
+constexpr double BUDGET_RATIO = 100.0;
+constexpr double BUDGET_ENTRY_RATIO = 1000.0;
+constexpr uint64_t BUDGET_ENTRIES = 100000;
+
+/** 最长的扩展名加点号 */
+constexpr size_t MAX_EXTENSION_LENGTH = 4;
+
+/** 扩展名（不含点号，最多3个字符）按小写打包成一个整数，最高字节为长度 */
+constexpr uint32_t pack_extension(const char* text) {
+    uint32_t key = 0;
+    uint32_t length = 0;
+    while (text[length]) {
+        key |= static_cast<uint32_t>(static_cast<uint8_t>(text[length])) << (8 * length);
+        length++;
+    }
+    return key | (length << 24);
+}
+
+/** 扩展名为这些之一（不区分大小写）的条目视为嵌套归档 */
+constexpr uint32_t ARCHIVE_EXTENSIONS[] = {
+    pack_extension("zip"), pack_extension("jar"), pack_extension("war"), pack_extension("apk"),
+    pack_extension("gz"), pack_extension("tgz"), pack_extension("bz2"), pack_extension("xz"),
+    pack_extension("zst"), pack_extension("7z"), pack_extension("rar"), pack_extension("tar")
+};
+
+inline double expansion(uint64_t uncompressed, uint64_t compressed) {
+    return static_cast<double>(uncompressed) / static_cast<double>(compressed ? compressed : 1);
+}
+
+/**
+ * 文件名是否像归档：在末尾几个字节里找点号，把扩展名打包后查表
+ *
+ * 每个条目都要检查，不使用依赖区域设置的tolower
+ */
+bool archive_name(const uint8_t* name, size_t length) {
+    const size_t window = std::min(length, MAX_EXTENSION_LENGTH);
+    size_t dot = length;
+    for (size_t i = length - window; i < length; i++) {
+        if (name[i] == '.') dot = i;
+    }
+    if (dot == length || dot == 0 || dot + 1 == length) return false;
+
+    uint32_t key = 0;
+    const size_t extension_length = length - dot - 1;
+    for (size_t i = 0; i < extension_length; i++) {
+        uint8_t c = name[dot + 1 + i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<uint8_t>(c | 0x20);
+        key |= static_cast<uint32_t>(c) << (8 * i);
+    }
+    key |= static_cast<uint32_t>(extension_length) << 24;
+    for (uint32_t candidate : ARCHIVE_EXTENSIONS) {
+        if (key == candidate) return true;
+    }
+    return false;
+}
+
+/** 条目至少占用的字节范围：本地头固定部分、文件名和压缩数据 */
+inline uint64_t entry_end(const EntryInfo& entry) {
+    return saturating_add(saturating_add(entry.local_header_offset, sizeof(ZipLocalFileHeader) + entry.name_length),
+                          entry.compressed_size);
+}
+
+/**
+ * 本地头偏移不单调时，把所有条目按起点排序后统计重叠
+ */
+uint64_t count_overlaps_sorted(const uint8_t* data, const DirectoryLocation& location) {
+    std::vector<std::pair<uint64_t, uint64_t>> spans;
+    spans.reserve(static_cast<size_t>(location.entries));
+    walk_directory(data, location, [&](uint64_t, const EntryInfo& entry) {
+        spans.emplace_back(entry.local_header_offset, entry_end(entry));
+    });
+    std::sort(spans.begin(), spans.end());
+
+    uint64_t overlaps = 0;
+    uint64_t covered = 0;
+    for (const auto& span : spans) {
+        if (span.first < covered || span.second > location.offset) overlaps++;
+        covered = std::max(covered, span.second);
+    }
+    return overlaps;
+}
+
+void check_budget(const zipbomb_inspect_budget_t& budget, zipbomb_inspect_report_t& report) {
+    if (budget.max_total_uncompressed && report.total_uncompressed > budget.max_total_uncompressed) {
+        report.violations |= ZIPBOMB_INSPECT_TOTAL_SIZE;
+    }
+    if (budget.max_entry_uncompressed && report.max_entry_uncompressed > budget.max_entry_uncompressed) {
+        report.violations |= ZIPBOMB_INSPECT_ENTRY_SIZE;
+    }
+    if (budget.max_ratio > 0.0 && report.ratio > budget.max_ratio) {
+        report.violations |= ZIPBOMB_INSPECT_RATIO;
+    }
+    if (budget.max_entry_ratio > 0.0 && report.max_entry_ratio > budget.max_entry_ratio) {
+        report.violations |= ZIPBOMB_INSPECT_ENTRY_RATIO;
+    }
+    if (budget.max_entries && report.entry_count > budget.max_entries) {
+        report.violations |= ZIPBOMB_INSPECT_ENTRY_COUNT;
+    }
+    if (budget.max_nested_archives && report.nested_archives > budget.max_nested_archives) {
+        report.violations |= ZIPBOMB_INSPECT_NESTED;
+    }
+    if (report.overlapping_entries) report.violations |= ZIPBOMB_INSPECT_OVERLAP;
+}
+
+} // namespace
+
+/**
+ * 检查内存中的归档
+ */
+int inspect_archive(const uint8_t* data, uint64_t size, const zipbomb_inspect_budget_t& budget,
+                    zipbomb_inspect_report_t& report) {
+    report = zipbomb_inspect_report_t();
+    report.archive_size = size;
+
+    DirectoryLocation location;
+    const int result = locate_central_directory(data, size, location);
+    if (result != ZIPBOMB_SUCCESS) return result;
+    report.entry_count = location.entries;
+    report.zip64 = location.zip64;
+
+    bool monotonic = true;
+    uint64_t previous_start = 0;
+    uint64_t covered = 0;       // 已出现条目的最远结束位置，被前面某个大条目整个包住的条目也要计入
+    const bool complete = walk_directory(data, location, [&](uint64_t index, const EntryInfo& entry) {
+        report.total_uncompressed = saturating_add(report.total_uncompressed, entry.uncompressed_size);
+        report.total_compressed = saturating_add(report.total_compressed, entry.compressed_size);
+        report.max_entry_uncompressed = std::max(report.max_entry_uncompressed, entry.uncompressed_size);
+
+        const double ratio = expansion(entry.uncompressed_size, entry.compressed_size);
+        if (ratio > report.max_entry_ratio) {
+            report.max_entry_ratio = ratio;
+            report.max_ratio_entry = index;
+        }
+        if (archive_name(entry.name, entry.name_length)) report.nested_archives++;
+
+        const uint64_t start = entry.local_header_offset;
+        const uint64_t end = entry_end(entry);
+        if (index > 0 && start < previous_start) monotonic = false;
+        if (monotonic && (start < covered || end > location.offset)) {
+            report.overlapping_entries++;
+        }
+        previous_start = start;
+        covered = std::max(covered, end);
+    });
+    if (!complete) return ZIPBOMB_ERROR_MALFORMED;
+
+    if (!monotonic) {
+        try {
+            report.overlapping_entries = count_overlaps_sorted(data, location);
+        } catch (const std::bad_alloc&) {
+            return ZIPBOMB_ERROR_MEMORY_ALLOC;
+        }
+    }
+
+    report.ratio = expansion(report.total_uncompressed, size);
+    check_budget(budget, report);
+    return ZIPBOMB_SUCCESS;
+}
+
+} // namespace ZipBombGenerator
+
+// ============================================================================
+// C接口实现
+// ============================================================================
+
+extern "C" {
+
+zipbomb_inspect_budget_t zipbomb_inspect_default_budget(void) {
+    zipbomb_inspect_budget_t budget = {};
+    budget.max_total_uncompressed = ZipBombGenerator::BUDGET_TOTAL_UNCOMPRESSED;
+    budget.max_entry_uncompressed = ZipBombGenerator::BUDGET_ENTRY_UNCOMPRESSED;
+    budget.max_ratio = ZipBombGenerator::BUDGET_RATIO;
+    budget.max_entry_ratio = ZipBombGenerator::BUDGET_ENTRY_RATIO;
+    budget.max_entries = ZipBombGenerator::BUDGET_ENTRIES;
+    budget.max_nested_archives = 0;
+    return budget;
+}
+
+int zipbomb_inspect_buffer(const uint8_t* data, size_t size, const zipbomb_inspect_budget_t* budget,
+                           zipbomb_inspect_report_t* report) {
+    if ((!data && size > 0) || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+    const zipbomb_inspect_budget_t limits = budget ? *budget : zipbomb_inspect_default_budget();
+    return ZipBombGenerator::inspect_archive(data, size, limits, *report);
+}
+
+int zipbomb_inspect_file(const char* filename, const zipbomb_inspect_budget_t* budget,
+                         zipbomb_inspect_report_t* report) {
+    if (!filename || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+
+    ZipBombGenerator::MappedArchive archive;
+    const int result = archive.open(filename);
+    if (result != ZIPBOMB_SUCCESS) {
+        *report = zipbomb_inspect_report_t();
+        return result;
+    }
+    return zipbomb_inspect_buffer(archive.data(), static_cast<size_t>(archive.size()), budget, report);
+}
+
+} // extern "C"
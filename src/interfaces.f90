@@ -11,6 +11,56 @@ module zipbomb_interfaces
     
     ! 公开接口
     public :: create_zipbomb, get_file_size, cleanup_resources
+    public :: get_performance_stats, export_performance_stats, export_performance_stats_fortran
+    
+    ! 生成阶段，对应zipbomb.h中的ZIPBOMB_PHASE_*（Fortran下标为其值加1）
+    integer(c_int), parameter :: ZIPBOMB_PHASE_PATTERN = 0
+    integer(c_int), parameter :: ZIPBOMB_PHASE_COMPRESS = 1
+    integer(c_int), parameter :: ZIPBOMB_PHASE_CRC = 2
+    integer(c_int), parameter :: ZIPBOMB_PHASE_WRITE = 3
+    integer(c_int), parameter :: ZIPBOMB_PHASE_CENTRAL_DIR = 4
+    integer(c_int), parameter :: ZIPBOMB_PHASE_COUNT = 5
+    
+    ! 统计导出格式，对应ZIPBOMB_STATS_*
+    integer(c_int), parameter :: ZIPBOMB_STATS_JSON = 0
+    integer(c_int), parameter :: ZIPBOMB_STATS_PROMETHEUS = 1
+    
+    !---------------------------------------------------------------------------
+    ! 与C结构体zipbomb_io_stats_t布局一致的输出I/O统计
+    !---------------------------------------------------------------------------
+    type, bind(C) :: zipbomb_io_stats_t
+        character(kind=c_char) :: backend(16)
+        integer(c_int64_t) :: writes_submitted
+        integer(c_int64_t) :: bytes_written
+        integer(c_int32_t) :: max_queue_depth
+        integer(c_int64_t) :: stall_ns
+        logical(c_bool) :: direct_io
+    end type zipbomb_io_stats_t
+    
+    !---------------------------------------------------------------------------
+    ! 与C结构体zipbomb_phase_stats_t布局一致的单阶段统计
+    !---------------------------------------------------------------------------
+    type, bind(C) :: zipbomb_phase_stats_t
+        integer(c_int64_t) :: time_ns
+        integer(c_int64_t) :: bytes_in
+        integer(c_int64_t) :: bytes_out
+        integer(c_int64_t) :: calls
+        real(c_double) :: mb_in_per_sec
+        real(c_double) :: mb_out_per_sec
+    end type zipbomb_phase_stats_t
+    
+    !---------------------------------------------------------------------------
+    ! 与C结构体zipbomb_stats_t布局一致的生成统计
+    !---------------------------------------------------------------------------
+    type, bind(C) :: zipbomb_stats_t
+        real(c_double) :: processing_time
+        real(c_double) :: compression_ratio
+        integer(c_int64_t) :: archive_size
+        type(zipbomb_io_stats_t) :: io
+        integer(c_int64_t) :: wall_time_ns
+        integer(c_int64_t) :: peak_buffer_bytes
+        type(zipbomb_phase_stats_t) :: phases(ZIPBOMB_PHASE_COUNT)
+    end type zipbomb_stats_t
     
     ! C/C++函数接口声明
     interface
@@ -78,6 +128,31 @@ module zipbomb_interfaces
             integer(c_int), value, intent(in) :: compression_level
         end subroutine set_compression_params
         
+        !-----------------------------------------------------------------------
+        ! C++函数: 获取最近一次生成的完整统计（含各阶段纳秒耗时和字节数）
+        ! 参数: stats - 输出的统计结构体
+        !-----------------------------------------------------------------------
+        subroutine get_performance_stats(stats) bind(C, name="get_performance_stats")
+            use iso_c_binding
+            import :: zipbomb_stats_t
+            type(zipbomb_stats_t), intent(out) :: stats
+        end subroutine get_performance_stats
+        
+        !-----------------------------------------------------------------------
+        ! C++函数: 把最近一次生成的统计导出到文件
+        ! 参数:
+        !   filename - 输出文件名（C字符串），"-"表示标准输出
+        !   format - 导出格式（ZIPBOMB_STATS_JSON或ZIPBOMB_STATS_PROMETHEUS）
+        ! 返回: 成功返回0，失败返回错误代码
+        !-----------------------------------------------------------------------
+        function export_performance_stats(filename, format) &
+            bind(C, name="export_performance_stats") result(status)
+            use iso_c_binding
+            character(kind=c_char), intent(in) :: filename(*)
+            integer(c_int), value, intent(in) :: format
+            integer(c_int) :: status
+        end function export_performance_stats
+        
     end interface
     
 contains
@@ -114,6 +189,20 @@ contains
         success = (c_result == 0)
     end function delete_file_fortran
     
+    !---------------------------------------------------------------------------
+    ! Fortran包装函数: 导出性能统计
+    ! 自动把Fortran字符串转换为C字符串
+    !---------------------------------------------------------------------------
+    function export_performance_stats_fortran(filename, format) result(success)
+        character(len=*), intent(in) :: filename
+        integer(c_int), intent(in) :: format
+        logical :: success
+        character(len=:), allocatable :: c_filename
+        
+        c_filename = trim(filename) // c_null_char
+        success = (export_performance_stats(c_filename, format) == 0)
+    end function export_performance_stats_fortran
+    
     !---------------------------------------------------------------------------
     ! Fortran包装函数: 获取人类可读的文件大小
     ! 自动转换为合适的单位（B, KB, MB, GB）
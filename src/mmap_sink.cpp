@@ -0,0 +1,135 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 内存映射输出实现
+ * ============================================================================
+ */
+
+#include "mmap_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+uint64_t page_size() {
+    static const uint64_t size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+/**
+ * 实际分配磁盘空间并把文件大小设为size
+ */
+bool allocate_file(int fd, uint64_t size) {
+#if defined(__linux__)
+    if (fallocate(fd, 0, 0, static_cast<off_t>(size)) == 0) return true;
+    if (errno == ENOSPC || errno == EFBIG) return false;
+#endif
+    // 文件系统不支持预分配时退回ftruncate（稀疏文件）
+    return ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+} // namespace
+
+// ============================================================================
+// MmapSink
+// ============================================================================
+
+MmapSink::MmapSink(int fd, uint8_t* base, uint64_t size)
+    : fd_(fd), base_(base), size_(size) {
+}
+
+MmapSink::~MmapSink() {
+    close();
+}
+
+bool MmapSink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    if (len > size_ - offset_) {
+        ok_ = false;
+        return false;
+    }
+    std::memcpy(base_ + offset_, data, len);
+    offset_ += len;
+    if (offset_ - released_ >= RELEASE_WINDOW) {
+        release(released_, offset_);
+        released_ = page_floor(offset_);
+    }
+    return true;
+}
+
+bool MmapSink::advance(uint64_t len) {
+    if (!ok_ || len > size_ - offset_) {
+        ok_ = false;
+        return false;
+    }
+    offset_ += len;
+    released_ = page_floor(offset_);
+    return true;
+}
+
+uint64_t MmapSink::page_floor(uint64_t offset) {
+    return offset / page_size() * page_size();
+}
+
+uint64_t MmapSink::page_ceil(uint64_t offset) {
+    return page_floor(offset + page_size() - 1);
+}
+
+void MmapSink::release(uint64_t begin, uint64_t end) {
+    const uint64_t page = page_size();
+    begin = (begin + page - 1) / page * page;
+    end = end / page * page;
+    if (begin >= end) return;
+
+    // 先启动回写，再解除映射；MAP_SHARED页面的数据保留在页缓存中
+    msync(base_ + begin, end - begin, MS_ASYNC);
+    madvise(base_ + begin, end - begin, MADV_DONTNEED);
+    releases_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool MmapSink::flush() {
+    return ok_;
+}
+
+bool MmapSink::close() {
+    if (!base_) return ok_;
+    bool result = ok_ && offset_ == size_;
+    if (munmap(base_, size_) != 0) result = false;
+    if (::close(fd_) != 0) result = false;
+    base_ = nullptr;
+    fd_ = -1;
+    ok_ = result;
+    return result;
+}
+
+// ============================================================================
+// 工厂函数
+// ============================================================================
+
+std::unique_ptr<MmapSink> open_mmap_file_sink(const std::string& filename, uint64_t size) {
+    if (size == 0) return nullptr;
+
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return nullptr;
+
+    if (!allocate_file(fd, size)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return nullptr;
+    }
+    madvise(base, static_cast<size_t>(size), MADV_SEQUENTIAL);
+
+    return std::unique_ptr<MmapSink>(new MmapSink(fd, static_cast<uint8_t*>(base), size));
+}
+
+} // namespace ZipBombGenerator
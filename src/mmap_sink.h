@@ -0,0 +1,95 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 内存映射输出
+ *
+ * 功能: 最终大小已知时，把输出文件预分配并整体映射到内存，头和数据直接
+ *       写入映射区，不再经过write系统调用
+ * 说明: 多个工作线程可以并行填充互不重叠的区域；每写完一个窗口就
+ *       msync + madvise(MADV_DONTNEED)，已写完的页面不再计入进程常驻内存
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_MMAP_SINK_H
+#define ZIPBOMB_MMAP_SINK_H
+
+#include "output_sink.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ZipBombGenerator {
+
+/**
+ * 内存映射输出端
+ */
+class MmapSink : public OutputSink {
+public:
+    /** 每写完这么多字节释放一次映射页面 */
+    static constexpr uint64_t RELEASE_WINDOW = 64ull * 1024 * 1024;
+
+    /**
+     * @param fd 已打开且大小已设为size的文件
+     * @param base 映射起始地址
+     * @param size 映射大小
+     */
+    MmapSink(int fd, uint8_t* base, uint64_t size);
+    ~MmapSink() override;
+
+    MmapSink(const MmapSink&) = delete;
+    MmapSink& operator=(const MmapSink&) = delete;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool flush() override;
+    uint64_t offset() const override { return offset_; }
+    bool close() override;
+
+    /** 映射区起始地址，工作线程在[0, size())内直接写入 */
+    uint8_t* data() const { return base_; }
+    uint64_t size() const { return size_; }
+
+    /**
+     * 声明[offset(), offset() + len)已由工作线程直接写好并各自释放，移动写入位置
+     *
+     * 这里不再释放该区域；最后一个不完整的页面留给之后的顺序写入一起释放
+     */
+    bool advance(uint64_t len);
+
+    /**
+     * 已写完一段区域：启动回写并解除映射页面（只处理完全落在区域内的页）
+     *
+     * 可由多个线程对互不重叠的区域并发调用；相邻区域的边界应按page_floor()对齐，
+     * 否则边界所在的页面哪一边都不会释放
+     */
+    void release(uint64_t begin, uint64_t end);
+
+    /** 向下/向上对齐到页面边界 */
+    static uint64_t page_floor(uint64_t offset);
+    static uint64_t page_ceil(uint64_t offset);
+
+    /** release()调用次数 */
+    uint64_t release_count() const { return releases_.load(std::memory_order_relaxed); }
+
+private:
+    int fd_;
+    uint8_t* base_;
+    uint64_t size_;
+    uint64_t offset_ = 0;
+    uint64_t released_ = 0;      // 顺序写入时已释放到的位置
+    bool ok_ = true;
+    std::atomic<uint64_t> releases_{0};
+};
+
+/**
+ * 创建文件、分配size字节的磁盘空间并映射
+ *
+ * 空间在映射前就实际分配，避免写入稀疏映射时因磁盘已满收到SIGBUS
+ *
+ * @return 失败（包括空间不足）返回nullptr
+ */
+std::unique_ptr<MmapSink> open_mmap_file_sink(const std::string& filename, uint64_t size);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_MMAP_SINK_H */
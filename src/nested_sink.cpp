@@ -0,0 +1,91 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 嵌套归档流水线实现
+ * ============================================================================
+ */
+
+#include "nested_sink.h"
+#include "central_directory.h"
+#include "crc32.h"
+#include "zip_format.h"
+#include <cstring>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+NestedArchiveSink::NestedArchiveSink(std::unique_ptr<OutputSink> outer, const std::string& entry_name,
+                                     int level)
+    : outer_(std::move(outer)), entry_name_(entry_name), forward_(*outer_), encoder_(forward_, level) {
+}
+
+NestedArchiveSink::~NestedArchiveSink() {
+    close();
+}
+
+/**
+ * 写出外层条目的本地头
+ *
+ * 内层归档的大小事先未知，本地头总是带ZIP64扩展字段（大小填0），
+ * 数据描述符因此使用8字节大小
+ */
+bool NestedArchiveSink::begin() {
+    header_offset_ = outer_->offset();
+
+    ZipLocalFileHeader header = {};
+    header.signature = ZIP_LOCAL_HEADER_SIG;
+    header.version = ZIP_VERSION_ZIP64;
+    header.flags = ZIP_FLAG_DATA_DESCRIPTOR;
+    header.compression = 8;  // 8=deflate
+    header.crc32 = 0;
+    header.compressed_size = ZIP64_LIMIT_32;
+    header.uncompressed_size = ZIP64_LIMIT_32;
+    header.filename_length = static_cast<uint16_t>(entry_name_.size());
+    header.extra_length = sizeof(ZipExtraFieldHeader) + 2 * sizeof(uint64_t);
+
+    const ZipExtraFieldHeader extra = {ZIP64_EXTRA_ID, 2 * sizeof(uint64_t)};
+    const uint64_t sizes[2] = {0, 0};
+
+    ok_ = outer_->write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) &&
+          outer_->write(reinterpret_cast<const uint8_t*>(entry_name_.data()), entry_name_.size()) &&
+          outer_->write(reinterpret_cast<const uint8_t*>(&extra), sizeof(extra)) &&
+          outer_->write(reinterpret_cast<const uint8_t*>(sizes), sizeof(sizes));
+    return ok_;
+}
+
+bool NestedArchiveSink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    crc_ = crc32_update(crc_, data, len);
+    offset_ += len;
+    ok_ = encoder_.write(data, len);
+    return ok_;
+}
+
+bool NestedArchiveSink::close() {
+    if (closed_) return ok_;
+    closed_ = true;
+
+    if (ok_ && encoder_.finish()) {
+        ZipDataDescriptor64 descriptor = {};
+        descriptor.signature = ZIP_DATA_DESCRIPTOR_SIG;
+        descriptor.crc32 = crc_;
+        descriptor.compressed_size = encoder_.total_out();
+        descriptor.uncompressed_size = encoder_.total_in();
+
+        CentralDirectoryBuilder directory;
+        directory.add(entry_name_.data(), static_cast<uint16_t>(entry_name_.size()), header_offset_,
+                      encoder_.total_out(), encoder_.total_in(), crc_, ZIP_FLAG_DATA_DESCRIPTOR);
+
+        ok_ = outer_->write(reinterpret_cast<const uint8_t*>(&descriptor), sizeof(descriptor));
+        if (ok_) {
+            std::vector<uint8_t> buffer = directory.serialize(outer_->offset());
+            ok_ = outer_->write(buffer.data(), buffer.size());
+        }
+    } else {
+        ok_ = false;
+    }
+
+    if (!outer_->close()) ok_ = false;
+    return ok_;
+}
+
+} // namespace ZipBombGenerator
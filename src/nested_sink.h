@@ -0,0 +1,79 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 嵌套归档流水线
+ *
+ * 功能: 把写入的字节流当作一个内层ZIP文件，实时压缩成外层归档中的
+ *       唯一条目。多个NestedArchiveSink串联即得到多层嵌套的归档
+ * 说明: 内层数据一边产生一边经DEFLATE和CRC送往外层，任何一层都不会
+ *       完整地存放在内存或磁盘上；每层只占一个压缩器的固定内存。
+ *       最内层归档的条目照常由生成端写入：只用一次的大条目边压缩边写出，
+ *       被多个条目复用的内容才在内存中缓存一份压缩结果，总内存因此与
+ *       条目大小无关。
+ *       外层条目的CRC和大小在压缩结束前未知，因此使用数据描述符
+ *       (通用标志第3位)，真实值写在数据之后和中央目录中
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_NESTED_SINK_H
+#define ZIPBOMB_NESTED_SINK_H
+
+#include "output_sink.h"
+#include "deflate.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ZipBombGenerator {
+
+/**
+ * 嵌套归档输出端
+ */
+class NestedArchiveSink : public OutputSink {
+public:
+    /**
+     * @param outer 外层输出端（关闭时一并关闭）
+     * @param entry_name 内层归档在外层中的文件名
+     * @param level 压缩级别(1-9)
+     */
+    NestedArchiveSink(std::unique_ptr<OutputSink> outer, const std::string& entry_name, int level);
+    ~NestedArchiveSink() override;
+
+    NestedArchiveSink(const NestedArchiveSink&) = delete;
+    NestedArchiveSink& operator=(const NestedArchiveSink&) = delete;
+
+    /** 在外层写出本地文件头，必须在第一次write()之前调用 */
+    bool begin();
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool flush() override { return ok_; }
+    uint64_t offset() const override { return offset_; }
+
+    /** 结束压缩，写出数据描述符和外层中央目录，然后关闭外层 */
+    bool close() override;
+
+private:
+    /** 把压缩器输出转交给外层 */
+    class ForwardSink : public ByteSink {
+    public:
+        explicit ForwardSink(OutputSink& target) : target_(target) {}
+        bool write(const uint8_t* data, size_t len) override { return target_.write(data, len); }
+
+    private:
+        OutputSink& target_;
+    };
+
+    std::unique_ptr<OutputSink> outer_;
+    std::string entry_name_;
+    ForwardSink forward_;
+    DeflateEncoder encoder_;
+
+    uint64_t header_offset_ = 0;   // 本地头在外层中的偏移
+    uint64_t offset_ = 0;          // 内层归档已写入的字节数
+    uint32_t crc_ = 0;
+    bool ok_ = true;
+    bool closed_ = false;
+};
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_NESTED_SINK_H */
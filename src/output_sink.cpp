@@ -0,0 +1,253 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档输出实现
+ * ============================================================================
+ */
+
+#include "output_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+#ifdef IOV_MAX
+constexpr size_t MAX_IOVECS = IOV_MAX;
+#else
+constexpr size_t MAX_IOVECS = 1024;
+#endif
+
+constexpr size_t STAGING_SIZE = 256 * 1024;    // 小块数据暂存区
+constexpr size_t COPY_THRESHOLD = 512;         // 小于此长度的引用写入直接复制
+constexpr uint64_t MIN_BUFFER_CAPACITY = 64 * 1024;  // 库分配缓冲区的初始容量
+
+} // namespace
+
+// ============================================================================
+// FdSink
+// ============================================================================
+
+FdSink::FdSink(int fd, bool owns_fd)
+    : fd_(fd), owns_fd_(owns_fd), staging_(STAGING_SIZE) {
+    off_t pos = lseek(fd_, 0, SEEK_CUR);
+    seekable_ = pos >= 0;
+    if (seekable_) file_offset_ = offset_ = static_cast<uint64_t>(pos);
+    iov_.reserve(MAX_IOVECS);
+}
+
+FdSink::~FdSink() {
+    close();
+}
+
+bool FdSink::push_iov(const uint8_t* data, size_t len) {
+    if (iov_.size() == MAX_IOVECS && !flush()) return false;
+    iov_.push_back({const_cast<uint8_t*>(data), len});
+    return true;
+}
+
+bool FdSink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    if (len == 0) return true;
+    offset_ += len;
+
+    // 大块数据不进暂存区，直接写出
+    if (len > staging_.size() / 2) {
+        if (!push_iov(data, len) || !flush()) return false;
+        return true;
+    }
+
+    // 复制前先保证暂存区和iovec都有空位：push_iov()内部的flush会重置暂存区，
+    // 若在复制之后才发生，刚复制的数据会被后续写入覆盖
+    if ((staging_used_ + len > staging_.size() || iov_.size() == MAX_IOVECS) && !flush()) return false;
+
+    uint8_t* dst = staging_.data() + staging_used_;
+    std::memcpy(dst, data, len);
+    staging_used_ += len;
+
+    // 与上一段暂存数据相邻时合并为一个iovec
+    if (!iov_.empty()) {
+        struct iovec& last = iov_.back();
+        if (static_cast<uint8_t*>(last.iov_base) + last.iov_len == dst) {
+            last.iov_len += len;
+            return true;
+        }
+    }
+    return push_iov(dst, len);
+}
+
+bool FdSink::write_ref(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    if (len < COPY_THRESHOLD) return write(data, len);
+    offset_ += len;
+    return push_iov(data, len);
+}
+
+/**
+ * 把收集到的iovec一次写出，处理部分写入
+ */
+bool FdSink::flush() {
+    if (!ok_) return false;
+
+    size_t first = 0;
+    while (first < iov_.size()) {
+        int count = static_cast<int>(std::min(iov_.size() - first, MAX_IOVECS));
+        ssize_t n;
+#if defined(__linux__)
+        if (seekable_) {
+            n = pwritev(fd_, &iov_[first], count, static_cast<off_t>(file_offset_));
+        } else {
+            n = writev(fd_, &iov_[first], count);
+        }
+#else
+        n = writev(fd_, &iov_[first], count);
+#endif
+        syscalls_++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok_ = false;
+            return false;
+        }
+        if (n == 0) {
+            // 还有数据却一个字节也没写出，重试只会原地空转
+            ok_ = false;
+            return false;
+        }
+        file_offset_ += static_cast<uint64_t>(n);
+
+        // 跳过已完整写出的iovec，截掉部分写出的那一个
+        size_t written = static_cast<size_t>(n);
+        while (first < iov_.size() && written >= iov_[first].iov_len) {
+            written -= iov_[first].iov_len;
+            first++;
+        }
+        if (first < iov_.size() && written > 0) {
+            iov_[first].iov_base = static_cast<uint8_t*>(iov_[first].iov_base) + written;
+            iov_[first].iov_len -= written;
+        }
+    }
+
+    iov_.clear();
+    staging_used_ = 0;
+    return true;
+}
+
+void FdSink::abort() {
+    iov_.clear();
+    staging_used_ = 0;
+    ok_ = false;
+}
+
+bool FdSink::preallocate(uint64_t size) {
+    if (!seekable_ || fd_ < 0) return true;
+    return preallocate_fd(fd_, size);
+}
+
+bool FdSink::close() {
+    if (fd_ < 0) return ok_;
+    bool result = flush();
+    if (owns_fd_ && ::close(fd_) != 0) result = false;
+    fd_ = -1;
+    ok_ = result;
+    return result;
+}
+
+// ============================================================================
+// MemorySink
+// ============================================================================
+
+MemorySink::MemorySink(zipbomb_buffer_t& buffer) : buffer_(buffer) {
+    if (!buffer_.data) {
+        buffer_.capacity = 0;
+        buffer_.owned = true;
+    }
+    buffer_.size = 0;
+}
+
+bool MemorySink::reserve(uint64_t capacity) {
+    if (capacity <= static_cast<uint64_t>(buffer_.capacity)) return true;
+    if (!buffer_.owned || capacity > static_cast<uint64_t>(INT64_MAX) || capacity > SIZE_MAX) return false;
+    void* data = std::realloc(buffer_.data, static_cast<size_t>(capacity));
+    if (!data) return false;
+    buffer_.data = static_cast<uint8_t*>(data);
+    buffer_.capacity = static_cast<int64_t>(capacity);
+    grows_++;
+    return true;
+}
+
+bool MemorySink::preallocate(uint64_t size) {
+    // 调用方的缓冲区放不下时照常生成，只统计大小
+    if (buffer_.owned && !reserve(size)) ok_ = false;
+    return ok_;
+}
+
+bool MemorySink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    const uint64_t size = static_cast<uint64_t>(buffer_.size);
+    if (buffer_.owned && size + len > static_cast<uint64_t>(buffer_.capacity)) {
+        ok_ = reserve(std::max({size + len, static_cast<uint64_t>(buffer_.capacity) * 2, MIN_BUFFER_CAPACITY}));
+        if (!ok_) return false;
+    }
+    const uint64_t capacity = static_cast<uint64_t>(buffer_.capacity);
+    if (size < capacity) {
+        std::memcpy(buffer_.data + size, data, static_cast<size_t>(std::min<uint64_t>(len, capacity - size)));
+    }
+    buffer_.size += static_cast<int64_t>(len);
+    return true;
+}
+
+// ============================================================================
+// CallbackSink
+// ============================================================================
+
+CallbackSink::CallbackSink(Callback callback)
+    : callback_(std::move(callback)), staging_(STAGING_SIZE) {
+}
+
+bool CallbackSink::deliver(const uint8_t* data, size_t len) {
+    if (len == 0 || !ok_) return ok_;
+    calls_++;
+    ok_ = callback_(data, len);
+    return ok_;
+}
+
+bool CallbackSink::write(const uint8_t* data, size_t len) {
+    if (!ok_) return false;
+    offset_ += len;
+    if (staging_used_ + len > staging_.size() && !flush()) return false;
+    if (len >= staging_.size()) return deliver(data, len);
+    std::memcpy(staging_.data() + staging_used_, data, len);
+    staging_used_ += len;
+    return true;
+}
+
+bool CallbackSink::flush() {
+    const size_t used = staging_used_;
+    staging_used_ = 0;
+    return deliver(staging_.data(), used);
+}
+
+bool preallocate_fd(int fd, uint64_t size) {
+    if (size == 0) return true;
+#if defined(__linux__)
+    // FALLOC_FL_KEEP_SIZE只分配块不改变文件大小，实际写入多少文件就多大
+    if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0) return true;
+    return errno != ENOSPC && errno != EFBIG;
+#else
+    (void)fd;
+    return true;
+#endif
+}
+
+std::unique_ptr<OutputSink> open_file_sink(const std::string& filename) {
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return nullptr;
+    return std::unique_ptr<OutputSink>(new FdSink(fd, true));
+}
+
+} // namespace ZipBombGenerator
@@ -0,0 +1,195 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档输出接口
+ *
+ * 功能: 可替换的输出端。生成器只通过OutputSink写数据，不关心数据最终
+ *       进入文件描述符、内存还是其他位置
+ * 说明: FdSink把小块数据暂存、大块数据按引用收集成iovec，
+ *       攒满后用一次writev/pwritev写出，共享的压缩数据不会被复制；
+ *       MemorySink写入调用方的内存缓冲区，CallbackSink把数据块交给回调函数
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_OUTPUT_SINK_H
+#define ZIPBOMB_OUTPUT_SINK_H
+
+#include "zipbomb.h"
+#include "deflate.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+namespace ZipBombGenerator {
+
+/**
+ * 归档输出接口
+ */
+class OutputSink : public ByteSink {
+public:
+    /** 追加写入，调用返回后data即可复用 */
+    bool write(const uint8_t* data, size_t len) override = 0;
+
+    /**
+     * 按引用追加写入（零拷贝）
+     *
+     * data在下一次flush()完成前必须保持有效且不被修改
+     */
+    virtual bool write_ref(const uint8_t* data, size_t len) { return write(data, len); }
+
+    /** 把所有暂存数据写到底层 */
+    virtual bool flush() = 0;
+
+    /** 已追加的逻辑字节数（即下一字节在归档中的偏移） */
+    virtual uint64_t offset() const = 0;
+
+    /**
+     * 预先为输出保留磁盘空间（不改变文件大小）
+     *
+     * @return 空间不足时返回false；底层不支持预分配时视为成功
+     */
+    virtual bool preallocate(uint64_t size) { (void)size; return true; }
+
+    /** 刷新并关闭 */
+    virtual bool close() { return flush(); }
+
+    /**
+     * 出错时放弃尚未写出的数据，包括按引用收集的块，之后的写入全部失败
+     *
+     * 按引用交出的数据要在flush()之前释放时必须先调用，否则析构时会写出已释放的内存
+     */
+    virtual void abort() {}
+};
+
+/**
+ * 基于原始文件描述符的聚集写输出
+ */
+class FdSink : public OutputSink {
+public:
+    /**
+     * @param fd 已打开的文件描述符
+     * @param owns_fd 关闭时是否close(fd)
+     */
+    FdSink(int fd, bool owns_fd);
+    ~FdSink() override;
+
+    FdSink(const FdSink&) = delete;
+    FdSink& operator=(const FdSink&) = delete;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool write_ref(const uint8_t* data, size_t len) override;
+    bool flush() override;
+    uint64_t offset() const override { return offset_; }
+    bool preallocate(uint64_t size) override;
+    bool close() override;
+    void abort() override;
+
+    /** 底层写系统调用次数 */
+    uint64_t syscall_count() const { return syscalls_; }
+
+private:
+    bool push_iov(const uint8_t* data, size_t len);
+
+    int fd_;
+    bool owns_fd_;
+    bool seekable_;
+    bool ok_ = true;
+
+    uint64_t offset_ = 0;        // 逻辑偏移（含暂存部分）
+    uint64_t file_offset_ = 0;   // 已写入底层的偏移
+    uint64_t syscalls_ = 0;
+
+    std::vector<struct iovec> iov_;
+    std::vector<uint8_t> staging_;
+    size_t staging_used_ = 0;
+};
+
+/**
+ * 写入内存缓冲区的输出
+ *
+ * 库分配的缓冲区（buffer.owned）按需用realloc增长，preallocate()时直接
+ * 扩到规划的精确大小；调用方提供的缓冲区大小固定，放不下的部分丢弃但
+ * 仍计入buffer.size，调用方可据此重新分配后再生成（同snprintf）
+ */
+class MemorySink : public OutputSink {
+public:
+    /**
+     * @param buffer 输出缓冲区；data为NULL时改由库分配
+     */
+    explicit MemorySink(zipbomb_buffer_t& buffer);
+
+    MemorySink(const MemorySink&) = delete;
+    MemorySink& operator=(const MemorySink&) = delete;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool flush() override { return ok_; }
+    uint64_t offset() const override { return static_cast<uint64_t>(buffer_.size); }
+    bool preallocate(uint64_t size) override;
+
+    /** realloc的次数 */
+    uint64_t grow_count() const { return grows_; }
+
+private:
+    /** 把库分配的缓冲区扩到至少capacity字节 */
+    bool reserve(uint64_t capacity);
+
+    zipbomb_buffer_t& buffer_;
+    bool ok_ = true;
+    uint64_t grows_ = 0;
+};
+
+/**
+ * 把数据块交给回调函数的输出
+ *
+ * 小块数据先暂存，攒满或flush()时一次交出；大块数据直接交出，不复制
+ */
+class CallbackSink : public OutputSink {
+public:
+    /** 返回false时生成中止 */
+    using Callback = std::function<bool(const uint8_t* data, size_t len)>;
+
+    explicit CallbackSink(Callback callback);
+
+    CallbackSink(const CallbackSink&) = delete;
+    CallbackSink& operator=(const CallbackSink&) = delete;
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool flush() override;
+    uint64_t offset() const override { return offset_; }
+
+    /** 回调次数 */
+    uint64_t call_count() const { return calls_; }
+
+private:
+    bool deliver(const uint8_t* data, size_t len);
+
+    Callback callback_;
+    bool ok_ = true;
+    uint64_t offset_ = 0;
+    uint64_t calls_ = 0;
+    std::vector<uint8_t> staging_;
+    size_t staging_used_ = 0;
+};
+
+/**
+ * 为文件描述符预分配空间，不支持预分配的文件系统或非普通文件直接返回true
+ *
+ * @param fd 文件描述符
+ * @param size 从偏移0开始需要保留的字节数
+ * @return 空间不足等真实错误时返回false
+ */
+bool preallocate_fd(int fd, uint64_t size);
+
+/**
+ * 创建/截断文件并返回对应的FdSink
+ *
+ * @return 失败返回nullptr
+ */
+std::unique_ptr<OutputSink> open_file_sink(const std::string& filename);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_OUTPUT_SINK_H */
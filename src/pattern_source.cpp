@@ -0,0 +1,429 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 条目内容模式源实现
+ * ============================================================================
+ */
+
+#include "pattern_source.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZIPBOMB_PATTERN_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ZIPBOMB_PATTERN_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ZipBombGenerator {
+
+namespace {
+
+const uint8_t MARK[3] = {'Z', 'I', 'P'};
+
+/** 随机符号表，哈希值的低4位选择其中一个 */
+alignas(16) const uint8_t ALPHABET[16] = {
+    ' ', 'e', 't', 'a', 'o', 'i', 'n', 's', 'r', 'h', 'l', 'd', 'c', 'u', 'm', '.'
+};
+
+/** 混合模式中重复的短语，存两遍以便从任意相位连续读取32字节 */
+const char PHRASE[] = "The quick brown fox jumps over the lazy dogs. ZIP fixture data.\n";
+static_assert(sizeof(PHRASE) == 65, "短语必须恰好64字节");
+
+struct PhraseTable {
+    uint8_t bytes[128];
+    PhraseTable() {
+        std::memcpy(bytes, PHRASE, 64);
+        std::memcpy(bytes + 64, PHRASE, 64);
+    }
+};
+const PhraseTable PHRASE2;
+
+/** 混合模式中哈希字节不小于该值时输出随机符号（约6%） */
+constexpr uint8_t MIX_THRESHOLD = 240;
+
+constexpr uint64_t GOLDEN64 = 0x9E3779B97F4A7C15ull;
+
+/** 64位整数哈希(splitmix64的输出函数) */
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/** 32位整数哈希(murmur3的输出函数)，向量实现与之逐步对应 */
+inline uint32_t hash_word(uint32_t key, uint32_t word) {
+    uint32_t x = (word ^ key) * 0x9E3779B1u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/** 每个哈希字生成的字节数 */
+constexpr unsigned SYMBOL_WORD_BYTES = 8;   // 每个半字节选择一个符号
+constexpr unsigned MIXED_WORD_BYTES = 4;    // 每个字节决定保留短语还是换成随机符号
+
+/** 随机文本的第k个字节：先取各字节的低半字节，再取高半字节 */
+inline uint8_t symbol_byte(uint32_t h, unsigned k) {
+    const unsigned shift = k < 4 ? 8 * k : 8 * (k - 4) + 4;
+    return ALPHABET[(h >> shift) & 15];
+}
+
+/** 混合数据的第k个字节，pos为其逻辑位置 */
+inline uint8_t mixed_byte(uint32_t h, unsigned k, uint64_t pos) {
+    const uint8_t t = static_cast<uint8_t>(h >> (8 * k));
+    return t >= MIX_THRESHOLD ? ALPHABET[t & 15] : PHRASE2.bytes[pos & 63];
+}
+
+// ============================================================================
+// 按字生成：key为当前段的密钥，word为段内第一个字的序号；
+// symbols输出words * SYMBOL_WORD_BYTES字节，mixed输出words * MIXED_WORD_BYTES字节，
+// 其中第j字节对应的短语相位为(word * 4 + j) % 64
+// ============================================================================
+
+void symbols_scalar(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    for (size_t i = 0; i < words; i++) {
+        const uint32_t h = hash_word(key, word + static_cast<uint32_t>(i));
+        for (unsigned k = 0; k < SYMBOL_WORD_BYTES; k++) out[i * SYMBOL_WORD_BYTES + k] = symbol_byte(h, k);
+    }
+}
+
+void mixed_scalar(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    for (size_t i = 0; i < words; i++) {
+        const uint32_t w = word + static_cast<uint32_t>(i);
+        const uint32_t h = hash_word(key, w);
+        for (unsigned k = 0; k < MIXED_WORD_BYTES; k++) {
+            out[i * MIXED_WORD_BYTES + k] = mixed_byte(h, k, w * 4u + k);
+        }
+    }
+}
+
+#if ZIPBOMB_PATTERN_X86
+
+/** 连续8个字的哈希 */
+__attribute__((target("avx2")))
+inline __m256i hash_lanes_avx2(uint32_t key, uint32_t word) {
+    __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(word)),
+                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    x = _mm256_xor_si256(x, _mm256_set1_epi32(static_cast<int>(key)));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x9E3779B1u)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x85EBCA6Bu)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0xC2B2AE35u)));
+    return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+__attribute__((target("avx2")))
+void symbols_avx2(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    const __m256i alphabet = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(ALPHABET)));
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 8 <= words; i += 8) {
+        const __m256i x = hash_lanes_avx2(key, word + static_cast<uint32_t>(i));
+        const __m256i lo = _mm256_shuffle_epi8(alphabet, _mm256_and_si256(x, low4));
+        const __m256i hi = _mm256_shuffle_epi8(alphabet, _mm256_and_si256(_mm256_srli_epi16(x, 4), low4));
+        // 每个字的低半字节符号在前、高半字节符号在后，再恢复字的顺序
+        const __m256i a = _mm256_unpacklo_epi32(lo, hi);   // 字0,1 | 字4,5
+        const __m256i b = _mm256_unpackhi_epi32(lo, hi);   // 字2,3 | 字6,7
+        uint8_t* dst = out + i * SYMBOL_WORD_BYTES;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    symbols_scalar(key, word + static_cast<uint32_t>(i), words - i, out + i * SYMBOL_WORD_BYTES);
+}
+
+__attribute__((target("avx2")))
+void mixed_avx2(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    const __m256i alphabet = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(ALPHABET)));
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    const __m256i threshold = _mm256_set1_epi8(static_cast<char>(MIX_THRESHOLD));
+
+    size_t i = 0;
+    for (; i + 8 <= words; i += 8) {
+        const uint32_t w = word + static_cast<uint32_t>(i);
+        const __m256i x = hash_lanes_avx2(key, w);
+        const __m256i random = _mm256_shuffle_epi8(alphabet, _mm256_and_si256(x, low4));
+        const __m256i phrase = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(PHRASE2.bytes + ((w * 4u) & 63)));
+        const __m256i pick = _mm256_cmpeq_epi8(_mm256_max_epu8(x, threshold), x);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * MIXED_WORD_BYTES),
+                            _mm256_blendv_epi8(phrase, random, pick));
+    }
+    mixed_scalar(key, word + static_cast<uint32_t>(i), words - i, out + i * MIXED_WORD_BYTES);
+}
+
+#elif ZIPBOMB_PATTERN_NEON
+
+/** 连续4个字的哈希 */
+inline uint32x4_t hash_lanes_neon(uint32_t key, uint32_t word) {
+    const uint32_t lanes[4] = {0, 1, 2, 3};
+    uint32x4_t x = vaddq_u32(vdupq_n_u32(word), vld1q_u32(lanes));
+    x = vmulq_n_u32(veorq_u32(x, vdupq_n_u32(key)), 0x9E3779B1u);
+    x = veorq_u32(x, vshrq_n_u32(x, 16));
+    x = vmulq_n_u32(x, 0x85EBCA6Bu);
+    x = veorq_u32(x, vshrq_n_u32(x, 13));
+    x = vmulq_n_u32(x, 0xC2B2AE35u);
+    return veorq_u32(x, vshrq_n_u32(x, 16));
+}
+
+void symbols_neon(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    const uint8x16_t alphabet = vld1q_u8(ALPHABET);
+    const uint8x16_t low4 = vdupq_n_u8(0x0F);
+
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        const uint8x16_t t = vreinterpretq_u8_u32(hash_lanes_neon(key, word + static_cast<uint32_t>(i)));
+        const uint8x16_t lo = vqtbl1q_u8(alphabet, vandq_u8(t, low4));
+        const uint8x16_t hi = vqtbl1q_u8(alphabet, vshrq_n_u8(t, 4));
+        const uint32x4x2_t z = vzipq_u32(vreinterpretq_u32_u8(lo), vreinterpretq_u32_u8(hi));
+        uint8_t* dst = out + i * SYMBOL_WORD_BYTES;
+        vst1q_u8(dst, vreinterpretq_u8_u32(z.val[0]));
+        vst1q_u8(dst + 16, vreinterpretq_u8_u32(z.val[1]));
+    }
+    symbols_scalar(key, word + static_cast<uint32_t>(i), words - i, out + i * SYMBOL_WORD_BYTES);
+}
+
+void mixed_neon(uint32_t key, uint32_t word, size_t words, uint8_t* out) {
+    const uint8x16_t alphabet = vld1q_u8(ALPHABET);
+    const uint8x16_t low4 = vdupq_n_u8(0x0F);
+    const uint8x16_t threshold = vdupq_n_u8(MIX_THRESHOLD);
+
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        const uint32_t w = word + static_cast<uint32_t>(i);
+        const uint8x16_t t = vreinterpretq_u8_u32(hash_lanes_neon(key, w));
+        const uint8x16_t random = vqtbl1q_u8(alphabet, vandq_u8(t, low4));
+        const uint8x16_t phrase = vld1q_u8(PHRASE2.bytes + ((w * 4u) & 63));
+        vst1q_u8(out + i * MIXED_WORD_BYTES, vbslq_u8(vcgeq_u8(t, threshold), random, phrase));
+    }
+    mixed_scalar(key, word + static_cast<uint32_t>(i), words - i, out + i * MIXED_WORD_BYTES);
+}
+
+#endif
+
+using HashWordsFn = void (*)(uint32_t, uint32_t, size_t, uint8_t*);
+
+struct HashKernels {
+    HashWordsFn symbols;
+    HashWordsFn mixed;
+    const char* name;
+};
+
+HashKernels select_hash_kernels() {
+#if ZIPBOMB_PATTERN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {symbols_avx2, mixed_avx2, "avx2"};
+#elif ZIPBOMB_PATTERN_NEON
+    return {symbols_neon, mixed_neon, "neon"};
+#endif
+    return {symbols_scalar, mixed_scalar, "scalar"};
+}
+
+/** 运行时选择的实现（首次使用时检测一次） */
+const HashKernels& hash_kernels() {
+    static const HashKernels kernels = select_hash_kernels();
+    return kernels;
+}
+
+} // namespace
+
+// ============================================================================
+// MarkedPatternSource
+// ============================================================================
+
+MarkedPatternSource::MarkedPatternSource(uint64_t size, char pattern_char, uint64_t variant)
+    : size_(size),
+      tail_start_(size ? (size - 1) / MARK_INTERVAL * MARK_INTERVAL : 0),
+      fill_byte_(static_cast<uint8_t>(pattern_char)),
+      variant_(variant) {
+    // 完整周期的内容，只有最后一个周期可能与之不同
+    std::memset(period_, fill_byte_, sizeof(period_));
+    std::memcpy(period_, MARK, sizeof(MARK));
+    if (variant_ != 0) std::memcpy(period_ + sizeof(MARK), &variant_, sizeof(variant_));
+}
+
+uint8_t MarkedPatternSource::tail_byte(uint64_t pos) const {
+    const uint64_t index = pos - tail_start_;
+    if (index < sizeof(MARK)) {
+        return tail_start_ + sizeof(MARK) < size_ ? MARK[index] : fill_byte_;
+    }
+    if (variant_ != 0 && index < sizeof(MARK) + sizeof(variant_) &&
+        tail_start_ + sizeof(MARK) + sizeof(variant_) < size_) {
+        return period_[index];
+    }
+    return fill_byte_;
+}
+
+void MarkedPatternSource::fill(uint64_t offset, uint8_t* out, size_t len) const {
+    const uint64_t end = offset + len;
+
+    for (uint64_t pos = offset; pos < end;) {
+        const size_t phase = static_cast<size_t>(pos % MARK_INTERVAL);
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(MARK_INTERVAL - phase, end - pos));
+        std::memcpy(out + (pos - offset), period_ + phase, n);
+        pos += n;
+    }
+
+    // 修正最后一个周期开头可能放不下的标记和编号
+    const uint64_t patch_end = std::min(end, tail_start_ + sizeof(MARK) + sizeof(variant_));
+    for (uint64_t pos = std::max(offset, tail_start_); pos < patch_end; pos++) {
+        out[pos - offset] = tail_byte(pos);
+    }
+}
+
+// ============================================================================
+// ConstantPatternSource
+// ============================================================================
+
+ConstantPatternSource::ConstantPatternSource(uint64_t size, char pattern_char, uint64_t variant)
+    : size_(size), fill_byte_(static_cast<uint8_t>(pattern_char)), variant_(variant) {
+}
+
+void ConstantPatternSource::fill(uint64_t offset, uint8_t* out, size_t len) const {
+    std::memset(out, fill_byte_, len);
+    if (variant_ == 0) return;
+
+    const uint64_t end = std::min<uint64_t>(offset + len, sizeof(variant_));
+    for (uint64_t pos = offset; pos < end; pos++) {
+        out[pos - offset] = static_cast<uint8_t>(variant_ >> (8 * pos));
+    }
+}
+
+// ============================================================================
+// HashedPatternSource
+// ============================================================================
+
+HashedPatternSource::HashedPatternSource(Shape shape, uint64_t size, uint64_t seed, uint64_t period)
+    : shape_(shape),
+      size_(size),
+      key_(mix64(seed)),
+      period_(period ? period : DEFAULT_PATTERN_PERIOD) {
+    if (shape_ == Shape::PERIODIC && period_ <= PERIOD_CACHE_LIMIT) {
+        period_cache_.resize(static_cast<size_t>(period_));
+        generate(0, period_cache_.data(), period_cache_.size());
+    }
+}
+
+/**
+ * 哈希以2^32个字为一段，每段使用不同的密钥，
+ * 保证几十GB以上的条目也不会出现重复
+ */
+void HashedPatternSource::generate(uint64_t pos, uint8_t* out, size_t len) const {
+    const bool mixed = shape_ == Shape::MIXED;
+    const unsigned unit = mixed ? MIXED_WORD_BYTES : SYMBOL_WORD_BYTES;
+    const HashWordsFn fn = mixed ? hash_kernels().mixed : hash_kernels().symbols;
+
+    while (len > 0) {
+        const uint64_t word = pos / unit;
+        const unsigned index = static_cast<unsigned>(pos % unit);
+        const uint32_t key = static_cast<uint32_t>(mix64(key_ ^ ((word >> 32) * GOLDEN64)));
+
+        // 未对齐到字的开头和不足一个字的结尾逐字节生成
+        if (index != 0 || len < unit) {
+            const uint32_t h = hash_word(key, static_cast<uint32_t>(word));
+            *out++ = mixed ? mixed_byte(h, index, pos) : symbol_byte(h, index);
+            pos++;
+            len--;
+            continue;
+        }
+
+        const uint64_t room = (uint64_t(1) << 32) - static_cast<uint32_t>(word);
+        const size_t words = static_cast<size_t>(std::min<uint64_t>(len / unit, room));
+        fn(key, static_cast<uint32_t>(word), words, out);
+        pos += words * unit;
+        out += words * unit;
+        len -= words * unit;
+    }
+}
+
+void HashedPatternSource::fill(uint64_t offset, uint8_t* out, size_t len) const {
+    if (shape_ != Shape::PERIODIC) {
+        generate(offset, out, len);
+        return;
+    }
+
+    const uint64_t end = offset + len;
+    for (uint64_t pos = offset; pos < end;) {
+        const uint64_t phase = pos % period_;
+        const size_t n = static_cast<size_t>(std::min(period_ - phase, end - pos));
+        if (!period_cache_.empty()) {
+            std::memcpy(out + (pos - offset), period_cache_.data() + phase, n);
+        } else {
+            generate(phase, out + (pos - offset), n);
+        }
+        pos += n;
+    }
+}
+
+// ============================================================================
+// 工厂函数
+// ============================================================================
+
+std::unique_ptr<PatternSource> make_pattern_source(const zipbomb_config_t& config,
+                                                   uint64_t size, uint64_t variant) {
+    // 各份内容使用不同的种子
+    const uint64_t seed = config.pattern_seed + variant * GOLDEN64;
+    const uint64_t period = static_cast<uint64_t>(config.pattern_period);
+
+    switch (config.pattern_kind) {
+    case ZIPBOMB_PATTERN_CONSTANT:
+        return std::unique_ptr<PatternSource>(new ConstantPatternSource(size, config.pattern_char, variant));
+    case ZIPBOMB_PATTERN_PERIODIC:
+        return std::unique_ptr<PatternSource>(
+            new HashedPatternSource(HashedPatternSource::Shape::PERIODIC, size, seed, period));
+    case ZIPBOMB_PATTERN_RANDOM:
+        return std::unique_ptr<PatternSource>(
+            new HashedPatternSource(HashedPatternSource::Shape::RANDOM, size, seed));
+    case ZIPBOMB_PATTERN_MIXED:
+        return std::unique_ptr<PatternSource>(
+            new HashedPatternSource(HashedPatternSource::Shape::MIXED, size, seed));
+    default:
+        return std::unique_ptr<PatternSource>(new MarkedPatternSource(size, config.pattern_char, variant));
+    }
+}
+
+const char* pattern_implementation() {
+    return hash_kernels().name;
+}
+
+} // namespace ZipBombGenerator
+
+// ============================================================================
+// C接口实现
+// ============================================================================
+
+extern "C" {
+
+int zipbomb_fill_pattern(const zipbomb_config_t* config, int64_t entry_size, int64_t variant,
+                         int64_t offset, void* out, size_t len) {
+    if (!config || entry_size < 0 || variant < 0 || offset < 0 || (len > 0 && !out) ||
+        static_cast<uint64_t>(offset) + len > static_cast<uint64_t>(entry_size)) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+    try {
+        const std::unique_ptr<ZipBombGenerator::PatternSource> source =
+            ZipBombGenerator::make_pattern_source(*config, static_cast<uint64_t>(entry_size),
+                                                  static_cast<uint64_t>(variant));
+        source->fill(static_cast<uint64_t>(offset), static_cast<uint8_t*>(out), len);
+    } catch (const std::bad_alloc&) {
+        return ZIPBOMB_ERROR_MEMORY_ALLOC;
+    }
+    return ZIPBOMB_SUCCESS;
+}
+
+const char* zipbomb_pattern_impl(void) {
+    return ZipBombGenerator::pattern_implementation();
+}
+
+} // extern "C"
@@ -0,0 +1,132 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 条目内容模式源
+ *
+ * 功能: 按需生成条目内容的任意一段，供压缩和CRC逐块读取
+ * 说明: 内容由位置直接计算得出，不在内存中展开整个条目；
+ *       无论条目多大，占用的内存都只有一个模式周期（周期文本最多
+ *       缓存PERIOD_CACHE_LIMIT字节，更长的周期直接计算）。
+ *       随机类模式对每个32位字做整数哈希，x86使用AVX2、ARM使用NEON
+ *       一次处理多个字，其他平台使用标量实现，三者输出完全相同
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_PATTERN_SOURCE_H
+#define ZIPBOMB_PATTERN_SOURCE_H
+
+#include "zipbomb.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/**
+ * 模式源接口
+ */
+class PatternSource {
+public:
+    virtual ~PatternSource() = default;
+
+    /** 内容总字节数 */
+    virtual uint64_t size() const = 0;
+
+    /**
+     * 生成[offset, offset + len)处的内容
+     *
+     * @param out 输出缓冲区，至少len字节；offset + len不得超过size()
+     */
+    virtual void fill(uint64_t offset, uint8_t* out, size_t len) const = 0;
+};
+
+/**
+ * 带"ZIP"标记的重复字符模式
+ *
+ * 每MARK_INTERVAL字节以"ZIP"开头，其余为重复字符；variant非0时
+ * 紧跟在每个标记之后，使各份内容互不相同
+ */
+class MarkedPatternSource : public PatternSource {
+public:
+    static constexpr size_t MARK_INTERVAL = 1024;
+
+    MarkedPatternSource(uint64_t size, char pattern_char, uint64_t variant = 0);
+
+    uint64_t size() const override { return size_; }
+    void fill(uint64_t offset, uint8_t* out, size_t len) const override;
+
+private:
+    /** 最后一个周期放不下标记或编号时的实际字节 */
+    uint8_t tail_byte(uint64_t pos) const;
+
+    uint64_t size_;
+    uint64_t tail_start_;          // 最后一个周期的起点
+    uint8_t fill_byte_;
+    uint64_t variant_;
+    uint8_t period_[MARK_INTERVAL];
+};
+
+/**
+ * 常量模式：全部为同一字节；variant非0时写在内容开头
+ */
+class ConstantPatternSource : public PatternSource {
+public:
+    ConstantPatternSource(uint64_t size, char pattern_char, uint64_t variant = 0);
+
+    uint64_t size() const override { return size_; }
+    void fill(uint64_t offset, uint8_t* out, size_t len) const override;
+
+private:
+    uint64_t size_;
+    uint8_t fill_byte_;
+    uint64_t variant_;
+};
+
+/**
+ * 基于位置哈希的模式
+ *
+ * 每个字节由(种子, 位置)决定，可以从任意位置开始生成：
+ *   RANDOM   - 16个符号的伪随机文本，每字节约4比特熵
+ *   PERIODIC - 同样的文本以period字节为周期重复；周期超过32KB的
+ *              DEFLATE窗口时压缩器无法发现重复
+ *   MIXED    - 64字节短语不断重复，约6%的字节被随机符号替换
+ */
+class HashedPatternSource : public PatternSource {
+public:
+    enum class Shape { RANDOM, PERIODIC, MIXED };
+
+    /** 周期不超过该值时预先生成一个周期，之后直接复制 */
+    static constexpr uint64_t PERIOD_CACHE_LIMIT = 64 * 1024;
+
+    HashedPatternSource(Shape shape, uint64_t size, uint64_t seed, uint64_t period = 0);
+
+    uint64_t size() const override { return size_; }
+    void fill(uint64_t offset, uint8_t* out, size_t len) const override;
+
+private:
+    /** 生成逻辑位置pos起的len字节（周期模式下为周期内的位置） */
+    void generate(uint64_t pos, uint8_t* out, size_t len) const;
+
+    Shape shape_;
+    uint64_t size_;
+    uint64_t key_;
+    uint64_t period_;
+    std::vector<uint8_t> period_cache_;
+};
+
+/**
+ * 按配置创建第variant份条目内容的模式源
+ *
+ * @param config 使用其中的pattern_kind、pattern_char、pattern_period和pattern_seed
+ */
+std::unique_ptr<PatternSource> make_pattern_source(const zipbomb_config_t& config,
+                                                   uint64_t size, uint64_t variant);
+
+/**
+ * 当前使用的模式生成实现名称
+ */
+const char* pattern_implementation();
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_PATTERN_SOURCE_H */
@@ -0,0 +1,213 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 分阶段性能计数器实现
+ * ============================================================================
+ */
+
+#include "perf_stats.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+const char* const PHASE_NAMES[ZIPBOMB_PHASE_COUNT] = {
+    "pattern", "compress", "crc", "write", "central_directory"
+};
+
+/** 字节数和纳秒数换算成MB/s */
+inline double throughput(uint64_t bytes, uint64_t ns) {
+    return ns ? (static_cast<double>(bytes) / BYTES_PER_MB) / (static_cast<double>(ns) / 1e9) : 0.0;
+}
+
+std::string format_json(const zipbomb_stats_t& stats) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+    out << "{\n"
+        << "  \"wall_time_ns\": " << stats.wall_time_ns << ",\n"
+        << "  \"processing_time\": " << stats.processing_time << ",\n"
+        << "  \"archive_size\": " << stats.archive_size << ",\n"
+        << "  \"compression_ratio\": " << stats.compression_ratio << ",\n"
+        << "  \"peak_buffer_bytes\": " << stats.peak_buffer_bytes << ",\n"
+        << "  \"io\": {\n"
+        << "    \"backend\": \"" << stats.io.backend << "\",\n"
+        << "    \"writes_submitted\": " << stats.io.writes_submitted << ",\n"
+        << "    \"bytes_written\": " << stats.io.bytes_written << ",\n"
+        << "    \"max_queue_depth\": " << stats.io.max_queue_depth << ",\n"
+        << "    \"stall_ns\": " << stats.io.stall_ns << ",\n"
+        << "    \"direct_io\": " << (stats.io.direct_io ? "true" : "false") << "\n"
+        << "  },\n"
+        << "  \"phases\": {\n";
+    for (int i = 0; i < ZIPBOMB_PHASE_COUNT; i++) {
+        const zipbomb_phase_stats_t& phase = stats.phases[i];
+        out << "    \"" << PHASE_NAMES[i] << "\": {"
+            << "\"time_ns\": " << phase.time_ns
+            << ", \"bytes_in\": " << phase.bytes_in
+            << ", \"bytes_out\": " << phase.bytes_out
+            << ", \"calls\": " << phase.calls
+            << ", \"mb_in_per_sec\": " << phase.mb_in_per_sec
+            << ", \"mb_out_per_sec\": " << phase.mb_out_per_sec
+            << "}" << (i + 1 < ZIPBOMB_PHASE_COUNT ? ",\n" : "\n");
+    }
+    out << "  }\n"
+        << "}\n";
+    return out.str();
+}
+
+/** 写出一个按阶段分标签的指标 */
+template <typename Getter>
+void prometheus_phase_metric(std::ostringstream& out, const zipbomb_stats_t& stats, const char* name,
+                             const char* help, Getter value) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " gauge\n";
+    for (int i = 0; i < ZIPBOMB_PHASE_COUNT; i++) {
+        out << name << "{phase=\"" << PHASE_NAMES[i] << "\"} " << value(stats.phases[i]) << "\n";
+    }
+}
+
+/** 写出一个不带标签的指标 */
+template <typename T>
+void prometheus_metric(std::ostringstream& out, const char* name, const char* help, T value) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " gauge\n"
+        << name << " " << value << "\n";
+}
+
+std::string format_prometheus(const zipbomb_stats_t& stats) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(9);
+
+    prometheus_metric(out, "zipbomb_wall_seconds", "最近一次生成的墙钟耗时",
+                      static_cast<double>(stats.wall_time_ns) / 1e9);
+    prometheus_metric(out, "zipbomb_archive_bytes", "归档字节数", stats.archive_size);
+    prometheus_metric(out, "zipbomb_compression_ratio", "归档大小/目标解压大小", stats.compression_ratio);
+    prometheus_metric(out, "zipbomb_peak_buffer_bytes", "缓冲区内存峰值", stats.peak_buffer_bytes);
+
+    out << "# HELP zipbomb_io_writes_submitted 输出端提交的写请求数\n"
+        << "# TYPE zipbomb_io_writes_submitted gauge\n"
+        << "zipbomb_io_writes_submitted{backend=\"" << stats.io.backend << "\"} "
+        << stats.io.writes_submitted << "\n";
+    prometheus_metric(out, "zipbomb_io_stall_seconds", "生成线程等待I/O的时间",
+                      static_cast<double>(stats.io.stall_ns) / 1e9);
+
+    prometheus_phase_metric(out, stats, "zipbomb_phase_seconds", "各阶段耗时（并发阶段为各线程之和）",
+                            [](const zipbomb_phase_stats_t& p) { return static_cast<double>(p.time_ns) / 1e9; });
+    prometheus_phase_metric(out, stats, "zipbomb_phase_bytes_in", "各阶段读入字节数",
+                            [](const zipbomb_phase_stats_t& p) { return p.bytes_in; });
+    prometheus_phase_metric(out, stats, "zipbomb_phase_bytes_out", "各阶段产出字节数",
+                            [](const zipbomb_phase_stats_t& p) { return p.bytes_out; });
+    prometheus_phase_metric(out, stats, "zipbomb_phase_calls", "各阶段调用次数（写入阶段为系统调用数）",
+                            [](const zipbomb_phase_stats_t& p) { return p.calls; });
+    prometheus_phase_metric(out, stats, "zipbomb_phase_in_mb_per_second", "各阶段输入吞吐量",
+                            [](const zipbomb_phase_stats_t& p) { return p.mb_in_per_sec; });
+    prometheus_phase_metric(out, stats, "zipbomb_phase_out_mb_per_second", "各阶段输出吞吐量",
+                            [](const zipbomb_phase_stats_t& p) { return p.mb_out_per_sec; });
+    return out.str();
+}
+
+} // namespace
+
+// ============================================================================
+// PhaseCounters
+// ============================================================================
+
+void PhaseCounters::reset() {
+    for (Phase& phase : phases_) {
+        phase.time_ns.store(0, std::memory_order_relaxed);
+        phase.bytes_in.store(0, std::memory_order_relaxed);
+        phase.bytes_out.store(0, std::memory_order_relaxed);
+        phase.calls.store(0, std::memory_order_relaxed);
+    }
+    buffer_bytes_.store(0, std::memory_order_relaxed);
+    peak_buffer_bytes_.store(0, std::memory_order_relaxed);
+}
+
+void PhaseCounters::add(int phase, uint64_t ns, uint64_t bytes_in, uint64_t bytes_out, uint64_t calls) {
+    Phase& p = phases_[phase];
+    p.time_ns.fetch_add(ns, std::memory_order_relaxed);
+    p.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+    p.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+    p.calls.fetch_add(calls, std::memory_order_relaxed);
+}
+
+void PhaseCounters::set_write_totals(uint64_t bytes_out, uint64_t syscalls) {
+    phases_[ZIPBOMB_PHASE_WRITE].bytes_out.store(bytes_out, std::memory_order_relaxed);
+    phases_[ZIPBOMB_PHASE_WRITE].calls.store(syscalls, std::memory_order_relaxed);
+}
+
+void PhaseCounters::acquire(uint64_t bytes) {
+    const uint64_t current = buffer_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t peak = peak_buffer_bytes_.load(std::memory_order_relaxed);
+    while (current > peak &&
+           !peak_buffer_bytes_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+}
+
+void PhaseCounters::release(uint64_t bytes) {
+    buffer_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void PhaseCounters::snapshot(zipbomb_phase_stats_t phases[ZIPBOMB_PHASE_COUNT]) const {
+    for (int i = 0; i < ZIPBOMB_PHASE_COUNT; i++) {
+        zipbomb_phase_stats_t& out = phases[i];
+        out.time_ns = phases_[i].time_ns.load(std::memory_order_relaxed);
+        out.bytes_in = phases_[i].bytes_in.load(std::memory_order_relaxed);
+        out.bytes_out = phases_[i].bytes_out.load(std::memory_order_relaxed);
+        out.calls = phases_[i].calls.load(std::memory_order_relaxed);
+        out.mb_in_per_sec = throughput(out.bytes_in, out.time_ns);
+        out.mb_out_per_sec = throughput(out.bytes_out, out.time_ns);
+    }
+}
+
+// ============================================================================
+// 导出
+// ============================================================================
+
+const char* phase_name(int phase) {
+    return (phase >= 0 && phase < ZIPBOMB_PHASE_COUNT) ? PHASE_NAMES[phase] : "unknown";
+}
+
+std::string format_stats(const zipbomb_stats_t& stats, int format) {
+    switch (format) {
+    case ZIPBOMB_STATS_JSON:
+        return format_json(stats);
+    case ZIPBOMB_STATS_PROMETHEUS:
+        return format_prometheus(stats);
+    default:
+        return std::string();
+    }
+}
+
+int export_stats(const zipbomb_stats_t& stats, const std::string& filename, int format) {
+    const std::string text = format_stats(stats, format);
+    if (text.empty()) return ZIPBOMB_ERROR_INVALID_PARAM;
+
+    if (filename == "-") {
+        std::cout << text << std::flush;
+        return std::cout ? ZIPBOMB_SUCCESS : ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+
+    const std::string temp = filename + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) return ZIPBOMB_ERROR_FILE_CREATE;
+        file << text;
+        if (!file.flush()) {
+            std::remove(temp.c_str());
+            return ZIPBOMB_ERROR_WRITE_FAILED;
+        }
+    }
+    if (std::rename(temp.c_str(), filename.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+    return ZIPBOMB_SUCCESS;
+}
+
+} // namespace ZipBombGenerator
@@ -0,0 +1,153 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 分阶段性能计数器
+ *
+ * 功能: 按阶段（模式生成、压缩、CRC、写入、中央目录）累计纳秒耗时、
+ *       输入输出字节数和调用次数，记录缓冲区内存峰值，并导出为
+ *       JSON或Prometheus文本格式
+ * 说明: 压缩阶段在线程池中并发执行，计数器全部为原子变量；
+ *       并发阶段的耗时是各线程耗时之和，可能超过墙钟时间
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_PERF_STATS_H
+#define ZIPBOMB_PERF_STATS_H
+
+#include "zipbomb.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ZipBombGenerator {
+
+/**
+ * 分阶段计数器
+ */
+class PhaseCounters {
+public:
+    PhaseCounters() = default;
+    PhaseCounters(const PhaseCounters&) = delete;
+    PhaseCounters& operator=(const PhaseCounters&) = delete;
+
+    /** 清零，开始新一次生成前调用 */
+    void reset();
+
+    /**
+     * 累加一次阶段执行
+     *
+     * @param phase 阶段(ZIPBOMB_PHASE_*)
+     * @param ns 耗时(纳秒)
+     * @param bytes_in 读入字节数
+     * @param bytes_out 产出字节数
+     * @param calls 调用次数
+     */
+    void add(int phase, uint64_t ns, uint64_t bytes_in, uint64_t bytes_out, uint64_t calls = 1);
+
+    /** 用输出端的实际统计覆盖写入阶段的产出字节数和调用（系统调用）次数 */
+    void set_write_totals(uint64_t bytes_out, uint64_t syscalls);
+
+    /** 占用bytes字节缓冲区，更新峰值 */
+    void acquire(uint64_t bytes);
+
+    /** 释放acquire()占用的缓冲区 */
+    void release(uint64_t bytes);
+
+    uint64_t peak_buffer_bytes() const { return peak_buffer_bytes_.load(std::memory_order_relaxed); }
+
+    /** 复制各阶段计数并算出吞吐量 */
+    void snapshot(zipbomb_phase_stats_t phases[ZIPBOMB_PHASE_COUNT]) const;
+
+private:
+    struct Phase {
+        std::atomic<uint64_t> time_ns{0};
+        std::atomic<uint64_t> bytes_in{0};
+        std::atomic<uint64_t> bytes_out{0};
+        std::atomic<uint64_t> calls{0};
+    };
+
+    Phase phases_[ZIPBOMB_PHASE_COUNT];
+    std::atomic<uint64_t> buffer_bytes_{0};
+    std::atomic<uint64_t> peak_buffer_bytes_{0};
+};
+
+/**
+ * 分段计时器：lap()返回上次lap()（或构造）以来的纳秒数
+ */
+class PhaseTimer {
+public:
+    PhaseTimer() : last_(std::chrono::steady_clock::now()) {}
+
+    uint64_t lap() {
+        const auto now = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+        last_ = now;
+        return static_cast<uint64_t>(elapsed);
+    }
+
+private:
+    std::chrono::steady_clock::time_point last_;
+};
+
+/**
+ * 缓冲区占用凭证：析构时把占用的字节数还给计数器
+ *
+ * 放在持有缓冲区的对象里，对象随缓存、共享指针或重排缓冲区
+ * 释放时自动计入，只能移动不能复制
+ */
+class BufferLease {
+public:
+    BufferLease() = default;
+    BufferLease(PhaseCounters& counters, uint64_t bytes) : counters_(&counters), bytes_(bytes) {
+        counters.acquire(bytes);
+    }
+    BufferLease(BufferLease&& other) noexcept : counters_(other.counters_), bytes_(other.bytes_) {
+        other.counters_ = nullptr;
+    }
+    BufferLease& operator=(BufferLease&& other) noexcept {
+        if (this != &other) {
+            reset();
+            counters_ = other.counters_;
+            bytes_ = other.bytes_;
+            other.counters_ = nullptr;
+        }
+        return *this;
+    }
+    BufferLease(const BufferLease&) = delete;
+    BufferLease& operator=(const BufferLease&) = delete;
+    ~BufferLease() { reset(); }
+
+    void reset() {
+        if (counters_) counters_->release(bytes_);
+        counters_ = nullptr;
+    }
+
+private:
+    PhaseCounters* counters_ = nullptr;
+    uint64_t bytes_ = 0;
+};
+
+/** 阶段名称，用作JSON键和Prometheus标签 */
+const char* phase_name(int phase);
+
+/**
+ * 把统计格式化为文本
+ *
+ * @param format ZIPBOMB_STATS_JSON或ZIPBOMB_STATS_PROMETHEUS
+ * @return 格式无效时返回空串
+ */
+std::string format_stats(const zipbomb_stats_t& stats, int format);
+
+/**
+ * 把统计写入文件
+ *
+ * 先写临时文件再改名，抓取方不会读到写了一半的内容；
+ * 文件名为"-"时写到标准输出
+ *
+ * @return 成功返回0，失败返回错误代码
+ */
+int export_stats(const zipbomb_stats_t& stats, const std::string& filename, int format);
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_PERF_STATS_H */
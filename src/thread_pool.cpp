@@ -0,0 +1,133 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 工作窃取线程池实现
+ * ============================================================================
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+constexpr unsigned MAX_THREADS = 256;
+
+} // namespace
+
+unsigned resolve_thread_count(int requested) {
+    unsigned threads = requested > 0 ? static_cast<unsigned>(requested)
+                                     : std::thread::hardware_concurrency();
+    return std::min(std::max(threads, 1u), MAX_THREADS);
+}
+
+// ============================================================================
+// ThreadPool
+// ============================================================================
+
+ThreadPool::ThreadPool(unsigned threads) {
+    threads = std::max(threads, 1u);
+    for (unsigned i = 0; i < threads; i++) {
+        queues_.emplace_back(new WorkQueue);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+    unsigned index;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        index = next_queue_;
+        next_queue_ = (next_queue_ + 1) % queues_.size();
+        queued_++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    work_ready_.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    idle_.wait(lock, [this] { return queued_ == 0 && running_ == 0; });
+}
+
+uint64_t ThreadPool::steal_count() const {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return steals_;
+}
+
+/**
+ * 从自己的队列尾部取任务（最近提交的数据更可能还在缓存中）
+ */
+bool ThreadPool::pop_local(unsigned index, Task& task) {
+    WorkQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+/**
+ * 从其他线程的队列头部窃取最早提交的任务
+ */
+bool ThreadPool::steal(unsigned index, Task& task) {
+    const unsigned count = static_cast<unsigned>(queues_.size());
+    for (unsigned k = 1; k < count; k++) {
+        WorkQueue& queue = *queues_[(index + k) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    for (;;) {
+        Task task;
+        bool stolen = false;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            work_ready_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (queued_ == 0) return;
+            // 先占用计数，保证取到任务前wait_idle()不会误判为空闲
+            queued_--;
+            running_++;
+        }
+
+        // 计数保证至少有一个任务尚未被取走，循环直到拿到为止
+        while (!pop_local(index, task)) {
+            if (steal(index, task)) {
+                stolen = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            running_--;
+            if (stolen) steals_++;
+            if (queued_ == 0 && running_ == 0) idle_.notify_all();
+        }
+    }
+}
+
+} // namespace ZipBombGenerator
@@ -0,0 +1,123 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 工作窃取线程池与有序提交缓冲区
+ *
+ * 功能: 多个工作线程并行执行相互独立的任务（如压缩不同条目）；
+ *       结果通过重排缓冲区按序号顺序交给唯一的写入方
+ * 说明: 每个工作线程有自己的双端队列，从队尾取任务；自己的队列为空时
+ *       从其他线程的队首窃取，任务耗时不均时负载仍然均衡
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_THREAD_POOL_H
+#define ZIPBOMB_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+/**
+ * 解析线程数配置：0表示使用全部硬件线程
+ */
+unsigned resolve_thread_count(int requested);
+
+/**
+ * 工作窃取线程池
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** 提交任务（轮流放入各工作线程的队列） */
+    void submit(Task task);
+
+    /** 等待所有已提交的任务执行完 */
+    void wait_idle();
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    /** 被窃取执行的任务数 */
+    uint64_t steal_count() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(unsigned index);
+    bool pop_local(unsigned index, Task& task);
+    bool steal(unsigned index, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex state_mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable idle_;
+    uint64_t queued_ = 0;       // 已提交但未取走的任务数
+    uint64_t running_ = 0;      // 正在执行的任务数
+    uint64_t steals_ = 0;
+    unsigned next_queue_ = 0;
+    bool stopping_ = false;
+};
+
+/**
+ * 有序提交缓冲区
+ *
+ * 生产者以任意顺序put(序号, 结果)，消费者按序号递增take()；
+ * 最多容纳capacity个未取走的结果。缓冲区本身不阻塞put，提交方必须保证
+ * 在途序号不超出窗口（只提交到已取出序号 + capacity为止），在途内存随之受限
+ */
+template <typename T>
+class ReorderBuffer {
+public:
+    explicit ReorderBuffer(size_t capacity) : slots_(capacity), ready_(capacity, false) {}
+
+    /** 放入第index个结果 */
+    void put(uint64_t index, T value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const size_t slot = static_cast<size_t>(index % slots_.size());
+            slots_[slot] = std::move(value);
+            ready_[slot] = true;
+        }
+        available_.notify_all();
+    }
+
+    /** 按顺序取出下一个结果 */
+    T take() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const size_t slot = static_cast<size_t>(next_ % slots_.size());
+        available_.wait(lock, [&] { return static_cast<bool>(ready_[slot]); });
+        T value = std::move(slots_[slot]);
+        ready_[slot] = false;
+        next_++;
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<T> slots_;
+    std::vector<bool> ready_;
+    uint64_t next_ = 0;         // 下一个要取出的序号
+};
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_THREAD_POOL_H */
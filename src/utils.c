@@ -305,6 +305,12 @@ const char* get_error_description(int error_code) {
             return "参数无效";
         case ZIPBOMB_ERROR_MEMORY_ALLOC:
             return "内存分配失败";
+        case ZIPBOMB_ERROR_BUFFER_TOO_SMALL:
+            return "输出缓冲区太小";
+        case ZIPBOMB_ERROR_FILE_READ:
+            return "文件读取失败";
+        case ZIPBOMB_ERROR_MALFORMED:
+            return "归档结构损坏";
         default:
             return "未知错误";
     }
@@ -367,25 +373,30 @@ int validate_parameters(const char* filename, const zipbomb_config_t* config) {
         return 0;
     }
 
-    // 检查配置参数
-    if (config->target_size_mb <= 0 || config->target_size_mb > 100000) {
-        fprintf(stderr, "参数验证失败: 目标大小无效 (%d MB)\n", config->target_size_mb);
+    // 检查配置参数：与生成时使用同一套范围检查
+    const char* problem = zipbomb_check_config(config);
+    if (problem) {
+        fprintf(stderr, "参数验证失败: %s\n", problem);
         return 0;
     }
 
-    if (config->compression_level < 1 || config->compression_level > 9) {
-        fprintf(stderr, "参数验证失败: 压缩级别无效 (%d)\n", config->compression_level);
-        return 0;
-    }
-
-    if (config->pattern_size <= 0 || config->pattern_size > 100*1024*1024) {
+    // 交互程序额外限制单份模式的大小
+    if (config->pattern_size > 100*1024*1024) {
         fprintf(stderr, "参数验证失败: 模式大小无效 (%d 字节)\n", config->pattern_size);
         return 0;
     }
 
-    // 检查磁盘空间（估算需要的临时空间）
-    int64_t estimated_temp_space = (int64_t)config->target_size_mb * 1024 * 1024 / 1000; // 估算1/1000
-    if (!check_disk_space(".", estimated_temp_space)) {
+    // 检查磁盘空间：所有条目内容相同且不嵌套时只需压缩一份内容，使用精确的归档大小；
+    // 否则不为检查而压缩，按布局公式给出的上界
+    zipbomb_plan_t plan;
+    int64_t required_space = config->target_size_bytes / 1000;
+    const int nested = config->use_nested_compression && config->nested_levels > 1;
+    if (config->pattern_variants == 1 && !nested && zipbomb_plan(config, &plan) == ZIPBOMB_SUCCESS) {
+        required_space = plan.total_size;
+    } else {
+        zipbomb_plan_bound(config, &required_space);
+    }
+    if (!check_disk_space(".", required_space)) {
         fprintf(stderr, "参数验证失败: 磁盘空间不足\n");
         return 0;
     }
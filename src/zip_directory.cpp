@@ -0,0 +1,172 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 中央目录读取实现
+ * ============================================================================
+ */
+
+#include "zip_directory.h"
+#include "zipbomb.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+/** 结束记录加最长注释 */
+constexpr uint64_t END_RECORD_SEARCH_LIMIT = sizeof(ZipEndOfCentralDir) + 0xFFFF;
+
+/**
+ * 从末尾向前查找结束记录
+ *
+ * 注释里也可能出现签名，只接受注释恰好延伸到文件末尾的那一个
+ */
+bool find_end_record(const uint8_t* data, uint64_t size, uint64_t& position) {
+    if (size < sizeof(ZipEndOfCentralDir)) return false;
+    const uint64_t last = size - sizeof(ZipEndOfCentralDir);
+    const uint64_t first = size > END_RECORD_SEARCH_LIMIT ? size - END_RECORD_SEARCH_LIMIT : 0;
+    for (uint64_t pos = last + 1; pos-- > first;) {
+        if (data[pos] != 0x50 || load<uint32_t>(data + pos) != ZIP_EOCD_SIG) continue;
+        const ZipEndOfCentralDir end = load<ZipEndOfCentralDir>(data + pos);
+        if (pos + sizeof(ZipEndOfCentralDir) + end.comment_length == size) {
+            position = pos;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int locate_central_directory(const uint8_t* data, uint64_t size, DirectoryLocation& location) {
+    uint64_t end_pos;
+    if (!find_end_record(data, size, end_pos)) return ZIPBOMB_ERROR_MALFORMED;
+    const ZipEndOfCentralDir end = load<ZipEndOfCentralDir>(data + end_pos);
+    if (end.disk_number != 0 || end.disk_start != 0) return ZIPBOMB_ERROR_MALFORMED;  // 不支持分卷
+
+    location.offset = end.central_dir_offset;
+    location.size = end.central_dir_size;
+    location.entries = end.total_entries;
+    uint64_t directory_end = end_pos;
+
+    const uint64_t locator_size = sizeof(Zip64EndOfCentralDirLocator);
+    if (end_pos >= locator_size &&
+        load<uint32_t>(data + end_pos - locator_size) == ZIP64_EOCD_LOCATOR_SIG) {
+        const uint64_t locator_pos = end_pos - locator_size;
+        const Zip64EndOfCentralDirLocator locator = load<Zip64EndOfCentralDirLocator>(data + locator_pos);
+        if (locator.eocd64_offset > locator_pos ||
+            locator_pos - locator.eocd64_offset < sizeof(Zip64EndOfCentralDir)) {
+            return ZIPBOMB_ERROR_MALFORMED;
+        }
+        const Zip64EndOfCentralDir end64 = load<Zip64EndOfCentralDir>(data + locator.eocd64_offset);
+        if (end64.signature != ZIP64_EOCD_SIG || end64.disk_number != 0 || end64.disk_start != 0) {
+            return ZIPBOMB_ERROR_MALFORMED;
+        }
+        location.offset = end64.central_dir_offset;
+        location.size = end64.central_dir_size;
+        location.entries = end64.total_entries;
+        location.zip64 = true;
+        directory_end = locator.eocd64_offset;
+    }
+
+    if (location.offset > directory_end || location.size > directory_end - location.offset) {
+        return ZIPBOMB_ERROR_MALFORMED;
+    }
+    // 每条记录至少占一个固定头，条目数不可能超过这个上限
+    if (location.entries > location.size / sizeof(ZipCentralDirHeader)) return ZIPBOMB_ERROR_MALFORMED;
+    return ZIPBOMB_SUCCESS;
+}
+
+bool parse_record(const uint8_t* record, uint64_t available, EntryInfo& entry, uint64_t& length) {
+    if (available < sizeof(ZipCentralDirHeader)) return false;
+    const ZipCentralDirHeader header = load<ZipCentralDirHeader>(record);
+    if (header.signature != ZIP_CENTRAL_HEADER_SIG) return false;
+    length = sizeof(ZipCentralDirHeader) + header.filename_length + header.extra_length + header.comment_length;
+    if (length > available) return false;
+
+    entry.name = record + sizeof(ZipCentralDirHeader);
+    entry.name_length = header.filename_length;
+    entry.flags = header.flags;
+    entry.compression = header.compression;
+    entry.crc32 = header.crc32;
+    entry.uncompressed_size = header.uncompressed_size;
+    entry.compressed_size = header.compressed_size;
+    entry.local_header_offset = header.local_header_offset;
+
+    const bool need_uncompressed = header.uncompressed_size == ZIP64_LIMIT_32;
+    const bool need_compressed = header.compressed_size == ZIP64_LIMIT_32;
+    const bool need_offset = header.local_header_offset == ZIP64_LIMIT_32;
+    if (!need_uncompressed && !need_compressed && !need_offset) return true;
+
+    // ZIP64扩展字段只依次包含溢出的值
+    const uint8_t* extra = entry.name + header.filename_length;
+    const uint8_t* extra_end = extra + header.extra_length;
+    while (extra_end - extra >= static_cast<ptrdiff_t>(sizeof(ZipExtraFieldHeader))) {
+        const ZipExtraFieldHeader field = load<ZipExtraFieldHeader>(extra);
+        const uint8_t* value = extra + sizeof(ZipExtraFieldHeader);
+        if (field.data_size > extra_end - value) return false;
+        if (field.header_id == ZIP64_EXTRA_ID) {
+            const uint8_t* value_end = value + field.data_size;
+            auto next = [&](uint64_t& out) {
+                if (value_end - value < static_cast<ptrdiff_t>(sizeof(uint64_t))) return false;
+                out = load<uint64_t>(value);
+                value += sizeof(uint64_t);
+                return true;
+            };
+            return (!need_uncompressed || next(entry.uncompressed_size)) &&
+                   (!need_compressed || next(entry.compressed_size)) &&
+                   (!need_offset || next(entry.local_header_offset));
+        }
+        extra = value + field.data_size;
+    }
+    return false;
+}
+
+bool locate_entry_data(const uint8_t* data, uint64_t limit, const EntryInfo& entry, uint64_t& data_offset) {
+    const uint64_t start = entry.local_header_offset;
+    if (start > limit || limit - start < sizeof(ZipLocalFileHeader)) return false;
+    const ZipLocalFileHeader header = load<ZipLocalFileHeader>(data + start);
+    if (header.signature != ZIP_LOCAL_HEADER_SIG) return false;
+    data_offset = start + sizeof(ZipLocalFileHeader) + header.filename_length + header.extra_length;
+    return data_offset <= limit;
+}
+
+// ============================================================================
+// MappedArchive
+// ============================================================================
+
+MappedArchive::~MappedArchive() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+}
+
+int MappedArchive::open(const char* filename, bool sequential) {
+    const int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return ZIPBOMB_ERROR_FILE_READ;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return ZIPBOMB_ERROR_FILE_READ;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return ZIPBOMB_ERROR_MALFORMED;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (sequential) flags |= MAP_POPULATE;  // 一次系统调用建立所有页表项，避免逐页缺页
+#endif
+    void* mapped = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return ZIPBOMB_ERROR_FILE_READ;
+    if (sequential) madvise(mapped, size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = size;
+    return ZIPBOMB_SUCCESS;
+}
+
+} // namespace ZipBombGenerator
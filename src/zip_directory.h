@@ -0,0 +1,134 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 中央目录读取
+ *
+ * 功能: 在内存中的归档里定位结束记录和中央目录，逐条解析中央目录记录
+ *       （含ZIP64扩展字段）；供归档检查、一致性扫描和解压验证共用
+ * 说明: 归档文件以只读方式映射，所有字段按小端序原地读取，不复制中央目录
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_ZIP_DIRECTORY_H
+#define ZIPBOMB_ZIP_DIRECTORY_H
+
+#include "zip_format.h"
+#include <cstddef>
+#include <cstring>
+
+namespace ZipBombGenerator {
+
+/** 读取未对齐的小端字段 */
+template <typename T>
+inline T load(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t saturating_add(uint64_t a, uint64_t b) {
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+/**
+ * 中央目录的位置
+ */
+struct DirectoryLocation {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t entries = 0;
+    bool zip64 = false;
+};
+
+/**
+ * 中央目录中一个条目声明的信息
+ */
+struct EntryInfo {
+    const uint8_t* name;
+    uint16_t name_length;
+    uint16_t flags;
+    uint16_t compression;
+    uint32_t crc32;
+    uint64_t compressed_size;
+    uint64_t uncompressed_size;
+    uint64_t local_header_offset;
+};
+
+/**
+ * 由结束记录（及ZIP64结束记录）确定中央目录的位置
+ *
+ * 结束记录从文件末尾向前查找，注释长度必须与位置吻合；不支持分卷
+ *
+ * @return 成功返回0，结构损坏返回ZIPBOMB_ERROR_MALFORMED
+ */
+int locate_central_directory(const uint8_t* data, uint64_t size, DirectoryLocation& location);
+
+/**
+ * 解析一条中央目录记录
+ *
+ * @param record 记录起点
+ * @param available 到中央目录末尾的字节数
+ * @param length 输出的记录长度
+ */
+bool parse_record(const uint8_t* record, uint64_t available, EntryInfo& entry, uint64_t& length);
+
+/**
+ * 依次解析中央目录的每条记录
+ *
+ * @return 所有记录都完整时返回true
+ */
+template <typename Visitor>
+bool walk_directory(const uint8_t* data, const DirectoryLocation& location, Visitor visit) {
+    const uint8_t* record = data + location.offset;
+    uint64_t remaining = location.size;
+    EntryInfo entry;
+    for (uint64_t i = 0; i < location.entries; i++) {
+        uint64_t length;
+        if (!parse_record(record, remaining, entry, length)) return false;
+        visit(i, entry);
+        record += length;
+        remaining -= length;
+    }
+    return true;
+}
+
+/**
+ * 由本地头求条目数据的起点
+ *
+ * @param limit 数据区终点（中央目录起点），本地头不能越过
+ * @param data_offset 输出的数据起点
+ * @return 本地头签名正确且完整时返回true
+ */
+bool locate_entry_data(const uint8_t* data, uint64_t limit, const EntryInfo& entry, uint64_t& data_offset);
+
+/**
+ * 只读映射的归档文件，析构时解除映射
+ */
+class MappedArchive {
+public:
+    MappedArchive() = default;
+    ~MappedArchive();
+
+    MappedArchive(const MappedArchive&) = delete;
+    MappedArchive& operator=(const MappedArchive&) = delete;
+
+    /**
+     * 映射文件
+     *
+     * @param filename 文件名
+     * @param sequential 为true时预先读入所有页面并提示顺序访问，用于要扫描全部数据的场合
+     * @return 成功返回0，无法打开或不是普通文件返回ZIPBOMB_ERROR_FILE_READ，
+     *         空文件返回ZIPBOMB_ERROR_MALFORMED
+     */
+    int open(const char* filename, bool sequential = false);
+
+    const uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+};
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_ZIP_DIRECTORY_H */
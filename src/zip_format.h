@@ -0,0 +1,140 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - ZIP文件格式定义
+ *
+ * 功能: ZIP/ZIP64各记录的紧密打包结构体及常量 (PKWARE APPNOTE 6.3)
+ * 说明: 所有多字节字段均为小端序
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_ZIP_FORMAT_H
+#define ZIPBOMB_ZIP_FORMAT_H
+
+#include <cstdint>
+
+namespace ZipBombGenerator {
+
+// ============================================================================
+// ZIP文件格式结构体
+// ============================================================================
+
+#pragma pack(push, 1)  // 确保结构体紧密打包
+
+/** ZIP文件本地文件头 */
+struct ZipLocalFileHeader {
+    uint32_t signature;          // 0x04034b50
+    uint16_t version;            // 版本
+    uint16_t flags;              // 通用标志
+    uint16_t compression;        // 压缩方法
+    uint16_t mod_time;           // 修改时间
+    uint16_t mod_date;           // 修改日期
+    uint32_t crc32;              // CRC-32
+    uint32_t compressed_size;    // 压缩后大小
+    uint32_t uncompressed_size;  // 原始大小
+    uint16_t filename_length;    // 文件名长度
+    uint16_t extra_length;       // 额外字段长度
+};
+
+/** ZIP中央目录文件头 */
+struct ZipCentralDirHeader {
+    uint32_t signature;          // 0x02014b50
+    uint16_t version_made;       // 制作版本
+    uint16_t version_needed;     // 需要版本
+    uint16_t flags;              // 通用标志
+    uint16_t compression;        // 压缩方法
+    uint16_t mod_time;           // 修改时间
+    uint16_t mod_date;           // 修改日期
+    uint32_t crc32;              // CRC-32
+    uint32_t compressed_size;    // 压缩后大小
+    uint32_t uncompressed_size;  // 原始大小
+    uint16_t filename_length;    // 文件名长度
+    uint16_t extra_length;       // 额外字段长度
+    uint16_t comment_length;     // 注释长度
+    uint16_t disk_start;         // 开始磁盘号
+    uint16_t internal_attr;      // 内部属性
+    uint32_t external_attr;      // 外部属性
+    uint32_t local_header_offset; // 本地头偏移
+};
+
+/** 数据描述符（通用标志第3位置位时跟在压缩数据之后） */
+struct ZipDataDescriptor {
+    uint32_t signature;          // 0x08074b50
+    uint32_t crc32;              // CRC-32
+    uint32_t compressed_size;    // 压缩后大小
+    uint32_t uncompressed_size;  // 原始大小
+};
+
+/** ZIP64数据描述符，本地头带ZIP64扩展字段时使用 */
+struct ZipDataDescriptor64 {
+    uint32_t signature;          // 0x08074b50
+    uint32_t crc32;              // CRC-32
+    uint64_t compressed_size;    // 压缩后大小
+    uint64_t uncompressed_size;  // 原始大小
+};
+
+/** ZIP64扩展信息额外字段头 (后跟若干64位值) */
+struct ZipExtraFieldHeader {
+    uint16_t header_id;          // 0x0001 = ZIP64扩展信息
+    uint16_t data_size;          // 数据长度
+};
+
+/** ZIP64中央目录结束记录 */
+struct Zip64EndOfCentralDir {
+    uint32_t signature;          // 0x06064b50
+    uint64_t record_size;        // 本记录剩余部分大小
+    uint16_t version_made;       // 制作版本
+    uint16_t version_needed;     // 需要版本
+    uint32_t disk_number;        // 磁盘号
+    uint32_t disk_start;         // 中央目录开始磁盘
+    uint64_t entries_on_disk;    // 本磁盘条目数
+    uint64_t total_entries;      // 总条目数
+    uint64_t central_dir_size;   // 中央目录大小
+    uint64_t central_dir_offset; // 中央目录偏移
+};
+
+/** ZIP64中央目录结束记录定位器 */
+struct Zip64EndOfCentralDirLocator {
+    uint32_t signature;          // 0x07064b50
+    uint32_t disk_start;         // ZIP64结束记录所在磁盘
+    uint64_t eocd64_offset;      // ZIP64结束记录偏移
+    uint32_t total_disks;        // 磁盘总数
+};
+
+/** ZIP文件结束记录 */
+struct ZipEndOfCentralDir {
+    uint32_t signature;          // 0x06054b50
+    uint16_t disk_number;        // 磁盘号
+    uint16_t disk_start;         // 中央目录开始磁盘
+    uint16_t entries_on_disk;    // 本磁盘条目数
+    uint16_t total_entries;      // 总条目数
+    uint32_t central_dir_size;   // 中央目录大小
+    uint32_t central_dir_offset; // 中央目录偏移
+    uint16_t comment_length;     // 注释长度
+};
+
+#pragma pack(pop)
+
+/** 32位/16位字段的溢出标记值，超出时改用ZIP64字段 */
+constexpr uint64_t ZIP64_LIMIT_32 = 0xFFFFFFFFu;
+constexpr uint64_t ZIP64_LIMIT_16 = 0xFFFFu;
+constexpr uint16_t ZIP64_EXTRA_ID = 0x0001;
+constexpr uint16_t ZIP_VERSION_DEFAULT = 20;   // 2.0: deflate
+constexpr uint16_t ZIP_VERSION_ZIP64 = 45;     // 4.5: ZIP64
+
+/** 记录签名 */
+constexpr uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+constexpr uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+constexpr uint32_t ZIP64_EOCD_SIG = 0x06064b50;
+constexpr uint32_t ZIP64_EOCD_LOCATOR_SIG = 0x07064b50;
+constexpr uint32_t ZIP_EOCD_SIG = 0x06054b50;
+constexpr uint32_t ZIP_DATA_DESCRIPTOR_SIG = 0x08074b50;
+
+/** 通用标志第0位：条目已加密 */
+constexpr uint16_t ZIP_FLAG_ENCRYPTED = 0x0001;
+
+/** 通用标志第3位：CRC和大小在数据之后的数据描述符中给出 */
+constexpr uint16_t ZIP_FLAG_DATA_DESCRIPTOR = 0x0008;
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_ZIP_FORMAT_H */
@@ -0,0 +1,441 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 本地头与中央目录一致性扫描
+ *
+ * 说明: 中央目录条目按本地头偏移排序（通常已经有序，不需要排序）。
+ *       签名查找按块顺序推进，块内得到的签名位置有序；扫描位置越过某个
+ *       条目的起点时才核对它的本地头并算出它实际占用的范围，因此条目
+ *       核对、范围合并和签名分类在同一次顺序读取中完成，本地头读取时
+ *       通常已在缓存中。
+ *       向量查找对每个位置比较其后4个字节：'P'、'K'之后第3字节为1或3、
+ *       第4字节比第3字节大1，恰好是中央目录签名或本地头签名，不需要
+ *       逐个确认；两个签名至少相隔4字节，块内找到的位置数有上限
+ * ============================================================================
+ */
+
+#include "zipbomb_inspect.h"
+#include "zip_directory.h"
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZIPBOMB_SCAN_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ZIPBOMB_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ZipBombGenerator {
+
+namespace {
+
+/** 每次查找的块大小及块内签名数上限 */
+constexpr uint32_t SCAN_BLOCK = 32 * 1024;
+constexpr uint32_t MAX_BLOCK_HITS = SCAN_BLOCK / 4;
+
+constexpr uint64_t SIGNATURE_LENGTH = 4;
+
+// ============================================================================
+// 签名查找
+// ============================================================================
+
+/**
+ * 查找[begin, end)中开始的签名，调用方保证end之后还有3字节可读
+ *
+ * @param hits 输出的签名位置（相对begin），至少能容纳(end - begin) / 4 + 1个
+ * @return 找到的个数
+ */
+using FindSignaturesFn = uint32_t (*)(const uint8_t* begin, const uint8_t* end, uint32_t* hits);
+
+/** 是否为本地头或中央目录签名 */
+inline bool is_signature(const uint8_t* p) {
+    return p[0] == 'P' && p[1] == 'K' && (p[2] | 2) == 3 && p[3] == p[2] + 1;
+}
+
+uint32_t find_signatures_scalar(const uint8_t* begin, const uint8_t* end, uint32_t* hits) {
+    uint32_t count = 0;
+    const uint8_t* p = begin;
+    while (p < end) {
+        p = static_cast<const uint8_t*>(std::memchr(p, 'P', static_cast<size_t>(end - p)));
+        if (!p) break;
+        if (is_signature(p)) hits[count++] = static_cast<uint32_t>(p - begin);
+        p++;
+    }
+    return count;
+}
+
+#if ZIPBOMB_SCAN_X86
+
+__attribute__((target("avx2")))
+uint32_t find_signatures_avx2(const uint8_t* begin, const uint8_t* end, uint32_t* hits) {
+    const __m256i p = _mm256_set1_epi8('P');
+    const __m256i k = _mm256_set1_epi8('K');
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+    const __m256i three = _mm256_set1_epi8(3);
+
+    uint32_t count = 0;
+    const uint8_t* s = begin;
+    for (; end - s >= 64; s += 64) {
+        // 先只比较'P'、'K'，64字节中都没有时跳过其余比较
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 1));
+        const __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+        const __m256i c1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 33));
+        const __m256i pk0 = _mm256_and_si256(_mm256_cmpeq_epi8(b0, p), _mm256_cmpeq_epi8(b1, k));
+        const __m256i pk1 = _mm256_and_si256(_mm256_cmpeq_epi8(c0, p), _mm256_cmpeq_epi8(c1, k));
+        if (_mm256_testz_si256(_mm256_or_si256(pk0, pk1), _mm256_or_si256(pk0, pk1))) continue;
+        for (int half = 0; half < 2; half++) {
+            const uint8_t* h = s + 32 * half;
+            const __m256i pk = half ? pk1 : pk0;
+            const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + 2));
+            const __m256i b3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + 3));
+            const __m256i kind = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(b2, two), three),
+                                                  _mm256_cmpeq_epi8(b3, _mm256_add_epi8(b2, one)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(pk, kind)));
+            while (mask) {
+                hits[count++] = static_cast<uint32_t>(h - begin) + static_cast<uint32_t>(__builtin_ctz(mask));
+                mask &= mask - 1;
+            }
+        }
+    }
+    for (; s < end; s++) {
+        if (is_signature(s)) hits[count++] = static_cast<uint32_t>(s - begin);
+    }
+    return count;
+}
+
+#elif ZIPBOMB_SCAN_NEON
+
+uint32_t find_signatures_neon(const uint8_t* begin, const uint8_t* end, uint32_t* hits) {
+    const uint8x16_t p = vdupq_n_u8('P');
+    const uint8x16_t k = vdupq_n_u8('K');
+    const uint8x16_t one = vdupq_n_u8(1);
+    const uint8x16_t two = vdupq_n_u8(2);
+    const uint8x16_t three = vdupq_n_u8(3);
+
+    uint32_t count = 0;
+    const uint8_t* s = begin;
+    for (; end - s >= 16; s += 16) {
+        const uint8x16_t b2 = vld1q_u8(s + 2);
+        const uint8x16_t pk = vandq_u8(vceqq_u8(vld1q_u8(s), p), vceqq_u8(vld1q_u8(s + 1), k));
+        const uint8x16_t kind = vandq_u8(vceqq_u8(vorrq_u8(b2, two), three),
+                                         vceqq_u8(vld1q_u8(s + 3), vaddq_u8(b2, one)));
+        // 每字节收窄为4位，只保留每组的最高位
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(vandq_u8(pk, kind)), 4)), 0) & 0x8888888888888888ULL;
+        while (mask) {
+            hits[count++] = static_cast<uint32_t>(s - begin) + static_cast<uint32_t>(__builtin_ctzll(mask) >> 2);
+            mask &= mask - 1;
+        }
+    }
+    for (; s < end; s++) {
+        if (is_signature(s)) hits[count++] = static_cast<uint32_t>(s - begin);
+    }
+    return count;
+}
+
+#endif
+
+struct SignatureKernel {
+    FindSignaturesFn find;
+    const char* name;
+};
+
+SignatureKernel select_signature_kernel() {
+#if ZIPBOMB_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {find_signatures_avx2, "avx2"};
+#elif ZIPBOMB_SCAN_NEON
+    return {find_signatures_neon, "neon"};
+#endif
+    return {find_signatures_scalar, "scalar"};
+}
+
+/** 运行时选择的实现（首次使用时检测一次） */
+const SignatureKernel& signature_kernel() {
+    static const SignatureKernel kernel = select_signature_kernel();
+    return kernel;
+}
+
+// ============================================================================
+// 本地头核对
+// ============================================================================
+
+/**
+ * 一个条目的本地头核对结果
+ */
+struct LocalCheck {
+    bool present;       // 本地头完整存在
+    uint32_t fields;    // 不一致的字段(ZIPBOMB_SCAN_FIELD_*)
+    uint64_t end;       // 条目实际占用范围的终点（含数据描述符）
+};
+
+/**
+ * 读取本地头ZIP64扩展字段中的大小
+ *
+ * 按规范本地头的ZIP64字段同时包含原始大小和压缩后大小；
+ * 不足16字节时按只含溢出值的顺序读取
+ *
+ * @return 是否带ZIP64扩展字段（决定数据描述符中大小的宽度）
+ */
+bool load_local_zip64(const uint8_t* extra, uint16_t extra_length, uint64_t& uncompressed, uint64_t& compressed) {
+    const uint8_t* extra_end = extra + extra_length;
+    while (extra_end - extra >= static_cast<ptrdiff_t>(sizeof(ZipExtraFieldHeader))) {
+        const ZipExtraFieldHeader field = load<ZipExtraFieldHeader>(extra);
+        const uint8_t* value = extra + sizeof(ZipExtraFieldHeader);
+        if (field.data_size > extra_end - value) return false;
+        if (field.header_id == ZIP64_EXTRA_ID) {
+            const bool need_uncompressed = uncompressed == ZIP64_LIMIT_32;
+            const bool need_compressed = compressed == ZIP64_LIMIT_32;
+            if (field.data_size >= 2 * sizeof(uint64_t)) {
+                if (need_uncompressed) uncompressed = load<uint64_t>(value);
+                if (need_compressed) compressed = load<uint64_t>(value + sizeof(uint64_t));
+            } else if (field.data_size >= sizeof(uint64_t)) {
+                if (need_uncompressed) {
+                    uncompressed = load<uint64_t>(value);
+                } else if (need_compressed) {
+                    compressed = load<uint64_t>(value);
+                }
+            }
+            return true;
+        }
+        extra = value + field.data_size;
+    }
+    return false;
+}
+
+/**
+ * 核对一个条目的本地头（及数据描述符）与中央目录记录
+ *
+ * @param limit 数据区终点（中央目录起点），本地头和数据描述符不能越过
+ */
+LocalCheck check_local_header(const uint8_t* data, uint64_t limit, const EntryInfo& entry) {
+    const uint64_t start = entry.local_header_offset;
+    // 没有本地头时按中央目录声明的文件名和压缩大小估计范围
+    LocalCheck check = {false, 0, saturating_add(saturating_add(start, sizeof(ZipLocalFileHeader) + entry.name_length),
+                                                 entry.compressed_size)};
+    if (start > limit || limit - start < sizeof(ZipLocalFileHeader)) return check;
+    const ZipLocalFileHeader header = load<ZipLocalFileHeader>(data + start);
+    const uint64_t header_end = start + sizeof(ZipLocalFileHeader) + header.filename_length + header.extra_length;
+    if (header.signature != ZIP_LOCAL_HEADER_SIG || header_end > limit) return check;
+    check.present = true;
+
+    const uint8_t* name = data + start + sizeof(ZipLocalFileHeader);
+    if (header.filename_length != entry.name_length || std::memcmp(name, entry.name, entry.name_length) != 0) {
+        check.fields |= ZIPBOMB_SCAN_FIELD_NAME;
+    }
+    if (header.compression != entry.compression) check.fields |= ZIPBOMB_SCAN_FIELD_METHOD;
+    if ((header.flags ^ entry.flags) & (ZIP_FLAG_ENCRYPTED | ZIP_FLAG_DATA_DESCRIPTOR)) {
+        check.fields |= ZIPBOMB_SCAN_FIELD_FLAGS;
+    }
+
+    uint64_t uncompressed = header.uncompressed_size;
+    uint64_t compressed = header.compressed_size;
+    const bool zip64 = load_local_zip64(name + header.filename_length, header.extra_length, uncompressed, compressed);
+    const uint64_t data_end = saturating_add(header_end, entry.compressed_size);
+    check.end = data_end;
+
+    if (!(header.flags & ZIP_FLAG_DATA_DESCRIPTOR)) {
+        if (header.crc32 != entry.crc32) check.fields |= ZIPBOMB_SCAN_FIELD_CRC;
+        if (compressed != entry.compressed_size || uncompressed != entry.uncompressed_size) {
+            check.fields |= ZIPBOMB_SCAN_FIELD_SIZE;
+        }
+        return check;
+    }
+
+    // 使用数据描述符时本地头中的值应为0，不为0时同样必须一致
+    if (header.crc32 && header.crc32 != entry.crc32) check.fields |= ZIPBOMB_SCAN_FIELD_CRC;
+    if ((compressed && compressed != entry.compressed_size) ||
+        (uncompressed && uncompressed != entry.uncompressed_size)) {
+        check.fields |= ZIPBOMB_SCAN_FIELD_SIZE;
+    }
+
+    // 描述符的签名可省略；本地头带ZIP64扩展字段时大小为64位
+    uint64_t pos = data_end;
+    if (pos <= limit && limit - pos >= SIGNATURE_LENGTH && load<uint32_t>(data + pos) == ZIP_DATA_DESCRIPTOR_SIG) {
+        pos += SIGNATURE_LENGTH;
+    }
+    const uint64_t width = zip64 ? sizeof(uint64_t) : sizeof(uint32_t);
+    const uint64_t length = sizeof(uint32_t) + 2 * width;
+    if (pos > limit || limit - pos < length) {
+        check.fields |= ZIPBOMB_SCAN_FIELD_DESCRIPTOR;
+        return check;
+    }
+    const uint8_t* descriptor = data + pos;
+    const uint64_t descriptor_compressed = zip64 ? load<uint64_t>(descriptor + 4) : load<uint32_t>(descriptor + 4);
+    const uint64_t descriptor_uncompressed = zip64 ? load<uint64_t>(descriptor + 12) : load<uint32_t>(descriptor + 8);
+    if (load<uint32_t>(descriptor) != entry.crc32) check.fields |= ZIPBOMB_SCAN_FIELD_CRC;
+    if (descriptor_compressed != entry.compressed_size || descriptor_uncompressed != entry.uncompressed_size) {
+        check.fields |= ZIPBOMB_SCAN_FIELD_SIZE;
+    }
+    check.end = pos + length;
+    return check;
+}
+
+// ============================================================================
+// 扫描
+// ============================================================================
+
+/**
+ * 随扫描位置推进的条目核对和签名分类
+ */
+class ConsistencyScanner {
+public:
+    ConsistencyScanner(const uint8_t* data, const DirectoryLocation& location,
+                       const std::vector<EntryInfo>& entries, zipbomb_scan_report_t& report)
+        : data_(data), location_(location), entries_(entries), report_(report) {}
+
+    /** 核对起点在position之前的所有条目 */
+    void advance(uint64_t position) {
+        while (next_ < entries_.size() && entries_[next_].local_header_offset < position) check_next();
+    }
+
+    /** 核对剩下的所有条目（起点在数据区之外的） */
+    void finish() {
+        while (next_ < entries_.size()) check_next();
+    }
+
+    /** 对position处的签名分类 */
+    void classify(uint64_t position) {
+        advance(position);
+        bool at_entry = false;
+        while (next_ < entries_.size() && entries_[next_].local_header_offset == position) {
+            at_entry = true;
+            check_next();
+        }
+
+        const bool local = data_[position + 2] == 3;
+        if (local) {
+            report_.local_signatures++;
+            if (at_entry) return;
+        } else {
+            report_.central_signatures++;
+        }
+        if (position < covered_) {
+            report_.embedded_signatures++;
+        } else if (local) {
+            report_.stray_local_headers++;
+        } else {
+            report_.stray_central_headers++;
+        }
+    }
+
+private:
+    void check_next() {
+        const EntryInfo& entry = entries_[next_];
+        const LocalCheck check = check_local_header(data_, location_.offset, entry);
+        if (!check.present) {
+            report_.missing_local++;
+        } else if (check.fields) {
+            report_.mismatched_entries++;
+            report_.mismatched_fields |= check.fields;
+        }
+
+        const uint64_t start = entry.local_header_offset;
+        const bool shared = next_ > 0 && start == entries_[next_ - 1].local_header_offset;
+        if (shared) report_.shared_entries++;
+        if ((!shared && start < covered_) || check.end > location_.offset) report_.overlapping_entries++;
+        covered_ = std::max(covered_, check.end);
+        next_++;
+    }
+
+    const uint8_t* data_;
+    const DirectoryLocation& location_;
+    const std::vector<EntryInfo>& entries_;
+    zipbomb_scan_report_t& report_;
+    size_t next_ = 0;
+    uint64_t covered_ = 0;   // 已核对条目范围的最远终点
+};
+
+} // namespace
+
+/**
+ * 扫描内存中的归档
+ */
+int scan_archive(const uint8_t* data, uint64_t size, zipbomb_scan_report_t& report) {
+    report = zipbomb_scan_report_t();
+    report.archive_size = size;
+
+    DirectoryLocation location;
+    const int result = locate_central_directory(data, size, location);
+    if (result != ZIPBOMB_SUCCESS) return result;
+    report.entry_count = location.entries;
+
+    std::vector<EntryInfo> entries;
+    try {
+        entries.reserve(static_cast<size_t>(location.entries));
+        const bool complete = walk_directory(data, location, [&](uint64_t, const EntryInfo& entry) {
+            entries.push_back(entry);
+        });
+        if (!complete) return ZIPBOMB_ERROR_MALFORMED;
+        auto by_offset = [](const EntryInfo& a, const EntryInfo& b) {
+            return a.local_header_offset < b.local_header_offset;
+        };
+        if (!std::is_sorted(entries.begin(), entries.end(), by_offset)) {
+            std::stable_sort(entries.begin(), entries.end(), by_offset);
+        }
+    } catch (const std::bad_alloc&) {
+        return ZIPBOMB_ERROR_MEMORY_ALLOC;
+    }
+
+    // 中央目录本身不查找；结束记录所在的尾部仍要查找（注释里可能藏有记录）
+    ConsistencyScanner scanner(data, location, entries, report);
+    const FindSignaturesFn find = signature_kernel().find;
+    uint32_t hits[MAX_BLOCK_HITS + 1];
+    const uint64_t last = size - (SIGNATURE_LENGTH - 1);
+    const uint64_t ranges[2][2] = {
+        {0, std::min(location.offset, last)},
+        {location.offset + location.size, last}
+    };
+    for (const auto& range : ranges) {
+        for (uint64_t block = range[0]; block < range[1]; block += SCAN_BLOCK) {
+            const uint64_t block_end = std::min(range[1], block + SCAN_BLOCK);
+            const uint32_t count = find(data + block, data + block_end, hits);
+            for (uint32_t i = 0; i < count; i++) scanner.classify(block + hits[i]);
+            scanner.advance(block_end);
+        }
+    }
+    scanner.finish();
+
+    if (report.missing_local) report.findings |= ZIPBOMB_SCAN_MISSING_LOCAL;
+    if (report.mismatched_entries) report.findings |= ZIPBOMB_SCAN_MISMATCH;
+    if (report.overlapping_entries) report.findings |= ZIPBOMB_SCAN_OVERLAP;
+    if (report.shared_entries) report.findings |= ZIPBOMB_SCAN_SHARED;
+    if (report.stray_local_headers) report.findings |= ZIPBOMB_SCAN_STRAY_LOCAL;
+    if (report.stray_central_headers) report.findings |= ZIPBOMB_SCAN_STRAY_CENTRAL;
+    return ZIPBOMB_SUCCESS;
+}
+
+} // namespace ZipBombGenerator
+
+// ============================================================================
+// C接口实现
+// ============================================================================
+
+extern "C" {
+
+int zipbomb_scan_buffer(const uint8_t* data, size_t size, zipbomb_scan_report_t* report) {
+    if ((!data && size > 0) || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+    return ZipBombGenerator::scan_archive(data, size, *report);
+}
+
+int zipbomb_scan_file(const char* filename, zipbomb_scan_report_t* report) {
+    if (!filename || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+
+    ZipBombGenerator::MappedArchive archive;
+    const int result = archive.open(filename, true);
+    if (result != ZIPBOMB_SUCCESS) {
+        *report = zipbomb_scan_report_t();
+        return result;
+    }
+    return zipbomb_scan_buffer(archive.data(), static_cast<size_t>(archive.size()), report);
+}
+
+const char* zipbomb_scan_implementation(void) {
+    return ZipBombGenerator::signature_kernel().name;
+}
+
+} // extern "C"
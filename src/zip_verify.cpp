@@ -0,0 +1,301 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 解压验证实现
+ *
+ * 说明: 每个工作线程有自己的解码器（输出窗口和码表复用），从共享的
+ *       序号中依次领取条目，耗时不均时负载仍然均衡。解压输出交给
+ *       VerifySink，边计算CRC边计数：超出声明的大小、单条目预算或
+ *       膨胀比时中止该条目；总字节数或时间超出时置共享的停止标志，
+ *       其他线程在下一次输出时随之停止
+ * ============================================================================
+ */
+
+#include "zipbomb_inspect.h"
+#include "zip_directory.h"
+#include "inflate.h"
+#include "crc32.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <vector>
+
+namespace ZipBombGenerator {
+
+namespace {
+
+/** 默认预算 */
+constexpr uint64_t BUDGET_VERIFY_TOTAL_BYTES = 16ULL << 30;
+constexpr double BUDGET_VERIFY_SECONDS = 60.0;
+
+/** 存储方式的条目每次交给输出端的字节数 */
+constexpr size_t STORED_CHUNK = 256 * 1024;
+
+constexpr uint16_t METHOD_STORED = 0;
+constexpr uint16_t METHOD_DEFLATE = 8;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * 所有工作线程共享的验证状态
+ */
+struct VerifyShared {
+    const uint8_t* data;
+    DirectoryLocation location;
+    zipbomb_verify_budget_t budget;
+    Clock::time_point deadline;
+    bool has_deadline = false;
+    std::atomic<uint64_t> bytes_out{0};
+    std::atomic<uint32_t> stop_reason{0};   // 非0时所有线程停止（ZIPBOMB_VERIFY_*_BUDGET）
+    std::atomic<bool> out_of_memory{false};
+};
+
+/**
+ * 一个条目的验证结果
+ */
+struct EntryResult {
+    uint32_t failures = 0;
+    bool skipped = false;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+};
+
+/**
+ * 一个条目的解压输出：计算CRC、计数并检查预算
+ */
+class VerifySink : public ByteSink {
+public:
+    VerifySink(VerifyShared& shared, const EntryInfo& entry) : shared_(shared), entry_(entry) {
+        if (shared.budget.max_ratio > 0.0) {
+            const double limit = shared.budget.max_ratio * static_cast<double>(std::max<uint64_t>(entry.compressed_size, 1));
+            ratio_limit_ = limit >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(limit);
+        }
+    }
+
+    bool write(const uint8_t* data, size_t len) override {
+        crc_ = crc32_update(crc_, data, len);
+        bytes_ += len;
+        if (bytes_ > entry_.uncompressed_size) return fail(ZIPBOMB_VERIFY_SIZE);  // 已经与声明不符，不必再解
+        if (shared_.budget.max_entry_bytes && bytes_ > shared_.budget.max_entry_bytes) {
+            return fail(ZIPBOMB_VERIFY_BYTE_BUDGET);
+        }
+        if (bytes_ > ratio_limit_) return fail(ZIPBOMB_VERIFY_RATIO_BUDGET);
+
+        const uint64_t total = shared_.bytes_out.fetch_add(len, std::memory_order_relaxed) + len;
+        if (shared_.budget.max_total_bytes && total > shared_.budget.max_total_bytes) {
+            return stop_all(ZIPBOMB_VERIFY_BYTE_BUDGET);
+        }
+        if (shared_.has_deadline && Clock::now() > shared_.deadline) return stop_all(ZIPBOMB_VERIFY_TIME_BUDGET);
+        const uint32_t reason = shared_.stop_reason.load(std::memory_order_relaxed);
+        return reason ? fail(reason) : true;
+    }
+
+    uint32_t crc() const { return crc_; }
+    uint64_t bytes() const { return bytes_; }
+    uint32_t failure() const { return failure_; }
+
+private:
+    bool fail(uint32_t reason) {
+        failure_ = reason;
+        return false;
+    }
+
+    bool stop_all(uint32_t reason) {
+        uint32_t expected = 0;
+        shared_.stop_reason.compare_exchange_strong(expected, reason, std::memory_order_relaxed);
+        return fail(reason);
+    }
+
+    VerifyShared& shared_;
+    const EntryInfo& entry_;
+    uint64_t ratio_limit_ = UINT64_MAX;
+    uint32_t crc_ = 0;
+    uint64_t bytes_ = 0;
+    uint32_t failure_ = 0;
+};
+
+/**
+ * 解压并核对一个条目
+ */
+EntryResult verify_entry(VerifyShared& shared, InflateDecoder& decoder, const EntryInfo& entry) {
+    EntryResult result;
+    if (shared.has_deadline && Clock::now() > shared.deadline) {
+        uint32_t expected = 0;
+        shared.stop_reason.compare_exchange_strong(expected, ZIPBOMB_VERIFY_TIME_BUDGET, std::memory_order_relaxed);
+    }
+    const uint32_t reason = shared.stop_reason.load(std::memory_order_relaxed);
+    if (reason) {
+        result.failures = reason;
+        result.skipped = true;
+        return result;
+    }
+    if ((entry.flags & ZIP_FLAG_ENCRYPTED) ||
+        (entry.compression != METHOD_STORED && entry.compression != METHOD_DEFLATE)) {
+        result.failures = ZIPBOMB_VERIFY_UNSUPPORTED;
+        return result;
+    }
+    uint64_t offset;
+    const uint64_t limit = shared.location.offset;
+    if (!locate_entry_data(shared.data, limit, entry, offset) || entry.compressed_size > limit - offset) {
+        result.failures = ZIPBOMB_VERIFY_CORRUPT;
+        return result;
+    }
+
+    const uint8_t* in = shared.data + offset;
+    const size_t in_len = static_cast<size_t>(entry.compressed_size);
+    VerifySink sink(shared, entry);
+    result.bytes_in = in_len;
+    if (entry.compression == METHOD_STORED) {
+        for (size_t pos = 0; pos < in_len; pos += STORED_CHUNK) {
+            if (!sink.write(in + pos, std::min(STORED_CHUNK, in_len - pos))) break;
+        }
+    } else {
+        switch (decoder.inflate(in, in_len, sink)) {
+        case InflateDecoder::Status::Ok:
+            // 压缩流在声明的压缩大小之前结束
+            if (decoder.total_in() != in_len) result.failures |= ZIPBOMB_VERIFY_SIZE;
+            break;
+        case InflateDecoder::Status::Stopped:
+            break;
+        default:
+            result.failures |= ZIPBOMB_VERIFY_CORRUPT;
+            break;
+        }
+    }
+    result.bytes_out = sink.bytes();
+    result.failures |= sink.failure();
+    if (!result.failures) {
+        if (sink.bytes() != entry.uncompressed_size) result.failures |= ZIPBOMB_VERIFY_SIZE;
+        if (sink.crc() != entry.crc32) result.failures |= ZIPBOMB_VERIFY_CRC;
+    }
+    return result;
+}
+
+inline double mb_per_sec(uint64_t bytes, uint64_t ns) {
+    return ns ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (static_cast<double>(ns) / 1e9) : 0.0;
+}
+
+} // namespace
+
+/**
+ * 解压验证内存中的归档
+ */
+int verify_archive(const uint8_t* data, uint64_t size, const zipbomb_verify_budget_t& budget,
+                   zipbomb_verify_report_t& report) {
+    report = zipbomb_verify_report_t();
+    const Clock::time_point start = Clock::now();
+
+    VerifyShared shared;
+    shared.data = data;
+    shared.budget = budget;
+    if (budget.max_seconds > 0.0) {
+        shared.has_deadline = true;
+        shared.deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(budget.max_seconds));
+    }
+    const int located = locate_central_directory(data, size, shared.location);
+    if (located != ZIPBOMB_SUCCESS) return located;
+    report.entry_count = shared.location.entries;
+
+    std::vector<EntryInfo> entries;
+    std::vector<EntryResult> results;
+    try {
+        entries.reserve(static_cast<size_t>(shared.location.entries));
+        const bool complete = walk_directory(data, shared.location, [&](uint64_t, const EntryInfo& entry) {
+            entries.push_back(entry);
+        });
+        if (!complete) return ZIPBOMB_ERROR_MALFORMED;
+        results.resize(entries.size());
+    } catch (const std::bad_alloc&) {
+        return ZIPBOMB_ERROR_MEMORY_ALLOC;
+    }
+
+    const unsigned threads = static_cast<unsigned>(
+        std::min<uint64_t>(resolve_thread_count(budget.thread_count), std::max<size_t>(entries.size(), 1)));
+    std::atomic<uint64_t> next(0);
+    auto worker = [&] {
+        try {
+            InflateDecoder decoder;
+            for (uint64_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < entries.size();) {
+                results[static_cast<size_t>(i)] = verify_entry(shared, decoder, entries[static_cast<size_t>(i)]);
+            }
+        } catch (const std::bad_alloc&) {
+            shared.out_of_memory = true;
+        }
+    };
+    if (threads == 1) {
+        worker();
+    } else {
+        ThreadPool pool(threads);
+        for (unsigned t = 0; t < threads; t++) pool.submit(worker);
+        pool.wait_idle();
+    }
+    if (shared.out_of_memory) return ZIPBOMB_ERROR_MEMORY_ALLOC;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const EntryResult& result = results[i];
+        report.failures |= result.failures;
+        if (result.skipped) {
+            report.skipped_entries++;
+        } else if (result.failures) {
+            if (!report.failed_entries) report.first_failed_entry = i;
+            report.failed_entries++;
+        } else {
+            report.verified_entries++;
+        }
+        report.bytes_in += result.bytes_in;
+        report.bytes_out += result.bytes_out;
+        report.max_entry_bytes = std::max(report.max_entry_bytes, result.bytes_out);
+        const double ratio = static_cast<double>(result.bytes_out) /
+                             static_cast<double>(std::max<uint64_t>(entries[i].compressed_size, 1));
+        report.max_ratio = std::max(report.max_ratio, ratio);
+    }
+
+    report.wall_time_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    report.mb_in_per_sec = mb_per_sec(report.bytes_in, report.wall_time_ns);
+    report.mb_out_per_sec = mb_per_sec(report.bytes_out, report.wall_time_ns);
+    report.threads = threads;
+    return ZIPBOMB_SUCCESS;
+}
+
+} // namespace ZipBombGenerator
+
+// ============================================================================
+// C接口实现
+// ============================================================================
+
+extern "C" {
+
+zipbomb_verify_budget_t zipbomb_verify_default_budget(void) {
+    zipbomb_verify_budget_t budget = {};
+    budget.max_total_bytes = ZipBombGenerator::BUDGET_VERIFY_TOTAL_BYTES;
+    budget.max_entry_bytes = 0;
+    budget.max_ratio = 0.0;
+    budget.max_seconds = ZipBombGenerator::BUDGET_VERIFY_SECONDS;
+    budget.thread_count = 0;
+    return budget;
+}
+
+int zipbomb_verify_buffer(const uint8_t* data, size_t size, const zipbomb_verify_budget_t* budget,
+                          zipbomb_verify_report_t* report) {
+    if ((!data && size > 0) || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+    const zipbomb_verify_budget_t limits = budget ? *budget : zipbomb_verify_default_budget();
+    return ZipBombGenerator::verify_archive(data, size, limits, *report);
+}
+
+int zipbomb_verify_file(const char* filename, const zipbomb_verify_budget_t* budget,
+                        zipbomb_verify_report_t* report) {
+    if (!filename || !report) return ZIPBOMB_ERROR_INVALID_PARAM;
+
+    ZipBombGenerator::MappedArchive archive;
+    const int result = archive.open(filename, true);
+    if (result != ZIPBOMB_SUCCESS) {
+        *report = zipbomb_verify_report_t();
+        return result;
+    }
+    return zipbomb_verify_buffer(archive.data(), static_cast<size_t>(archive.size()), budget, report);
+}
+
+} // extern "C"
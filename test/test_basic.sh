@@ -162,6 +162,203 @@ fi
 
 echo
 
+# ============================================================================
+# 生成模式测试
+# ============================================================================
+
+log_info "开始生成模式测试（每种模式生成后校验，任何一项失败即退出）..."
+
+GEN="$BUILD_DIR/bin/zipbomb_gen"
+INSPECT="$BUILD_DIR/bin/zipbomb_inspect"
+MODE_DIR="$TEST_DIR/output/modes"
+INSPECT_LIMITS="--max-size 0 --max-entry-size 0 --max-ratio 0 --max-entry-ratio 0"
+mkdir -p "$MODE_DIR"
+
+if ! check_command "unzip"; then
+    log_error "生成模式测试需要 unzip 作为独立的解压和CRC参照: apt install unzip (Linux)"
+    exit 1
+fi
+
+fail_mode() {
+    log_error "$1"
+    exit 1
+}
+
+# 用unzip逐条目解压核对CRC和大小，再用检查工具做一致性扫描和内存解压验证
+# 参数: 测试名称 归档文件
+verify_archive() {
+    if ! unzip -tq "$2" >/dev/null; then
+        fail_mode "$1: unzip -t 校验失败"
+    fi
+    if ! "$INSPECT" --scan --verify --verify-seconds 0 --quiet $INSPECT_LIMITS "$2"; then
+        fail_mode "$1: zipbomb_inspect --scan --verify 校验失败"
+    fi
+    log_success "$1"
+}
+
+# 生成归档并校验，生成工具的统计行保存在 $MODE_DIR/stats.txt
+# 参数: 测试名称 生成参数...
+check_mode() {
+    local name="$1"
+    shift
+    rm -f "$MODE_DIR/mode.zip"
+    if ! "$GEN" --stats "$@" "$MODE_DIR/mode.zip" 2>"$MODE_DIR/stats.txt"; then
+        cat "$MODE_DIR/stats.txt"
+        fail_mode "$name: 生成失败"
+    fi
+    verify_archive "$name" "$MODE_DIR/mode.zip"
+}
+
+# 核对上一次生成使用的输出后端
+# 参数: 测试名称 后端名称的正则
+check_backend() {
+    if ! grep -Eq "输出后端: ($2)," "$MODE_DIR/stats.txt"; then
+        cat "$MODE_DIR/stats.txt"
+        fail_mode "$1: 输出后端不符，期望 $2"
+    fi
+}
+
+# DEFLATE往返：默认模式，以及超过流式压缩阈值(8MB)、边压缩边写出的大条目
+check_mode "DEFLATE 往返" --size 8M --entries 16
+check_mode "DEFLATE 流式大条目" --pattern mixed --variants 0 --size 40M --entries 2
+
+# CRC：两种实现生成的归档必须逐字节相同，unzip作为独立的CRC参照
+check_mode "CRC 默认实现" --pattern random --variants 0 --size 6M --entries 7
+mv "$MODE_DIR/mode.zip" "$MODE_DIR/crc_default.zip"
+log_info "$(cat "$MODE_DIR/stats.txt")"
+ZIPBOMB_CRC32=slice-by-8 check_mode "CRC slice-by-8" --pattern random --variants 0 --size 6M --entries 7
+if ! grep -q "CRC实现: slice-by-8" "$MODE_DIR/stats.txt"; then
+    fail_mode "CRC slice-by-8: 环境变量 ZIPBOMB_CRC32 未生效"
+fi
+if ! cmp -s "$MODE_DIR/crc_default.zip" "$MODE_DIR/mode.zip"; then
+    fail_mode "CRC: 不同实现生成的归档不一致"
+fi
+log_success "CRC 各实现结果一致"
+
+# 条目缓存：多份内容循环使用
+check_mode "多份内容循环使用" --pattern random --variants 3 --size 8M --entries 30
+
+# ZIP64：单个条目超过4GB（unzip -t 完整解压约5GB，耗时较长）
+if ! "$GEN" --pattern constant --size 5G --entries 1 "$MODE_DIR/zip64_entry.zip"; then
+    fail_mode "ZIP64 单个5GB条目: 生成失败"
+fi
+verify_archive "ZIP64 单个5GB条目" "$MODE_DIR/zip64_entry.zip"
+rm -f "$MODE_DIR/zip64_entry.zip"
+
+# ZIP64：本地头偏移超过4GB，归档本身约4.3GB；只扫描结构并解压最后一个条目
+MODE_SPACE=$(df -k "$MODE_DIR" | tail -1 | awk '{print $4}')
+if [ "$MODE_SPACE" -gt $((6 * 1024 * 1024)) ]; then
+    if ! "$GEN" --pattern constant --size 4400G --entries 4400 "$MODE_DIR/zip64_offset.zip"; then
+        fail_mode "ZIP64 偏移超过4GB: 生成失败"
+    fi
+    if ! "$INSPECT" --scan --quiet $INSPECT_LIMITS "$MODE_DIR/zip64_offset.zip"; then
+        fail_mode "ZIP64 偏移超过4GB: zipbomb_inspect --scan 发现问题"
+    fi
+    if ! unzip -tq "$MODE_DIR/zip64_offset.zip" bomb_data_4399.txt >/dev/null; then
+        fail_mode "ZIP64 偏移超过4GB: unzip -t 最后一个条目失败"
+    fi
+    rm -f "$MODE_DIR/zip64_offset.zip"
+    log_success "ZIP64 偏移超过4GB"
+else
+    log_warning "可用磁盘空间不足6GB，跳过 ZIP64 偏移超过4GB 的测试"
+fi
+
+# 中央目录：条目数超过65535，需要ZIP64目录结尾记录
+check_mode "ZIP64 70000个条目" --size 70000K --entries 70000
+rm -f "$MODE_DIR/mode.zip"
+
+# 同步聚集写
+check_mode "同步聚集写" --output-mode sync --size 32M --entries 300
+check_backend "同步聚集写" "sync"
+
+# 异步写：优先io_uring，不可用时为线程池
+check_mode "异步写" --output-mode async --size 32M --entries 300
+check_backend "异步写" "io_uring|threads"
+log_info "$(cat "$MODE_DIR/stats.txt")"
+check_mode "异步写（O_DIRECT，队列深度4）" --output-mode async --direct-io --queue-depth 4 --pattern random --size 32M --entries 3
+check_backend "异步写（O_DIRECT，队列深度4）" "io_uring|threads"
+check_mode "线程池写" --output-mode threads --pattern random --variants 0 --size 16M --entries 100
+check_backend "线程池写" "threads"
+
+# 内存映射写；条目内容各不相同或边压缩边写出时布局无法预先确定，按文档退回同步写
+check_mode "内存映射写" --output-mode mmap --pattern random --size 16M --entries 100
+check_backend "内存映射写" "mmap"
+check_mode "内存映射写（布局未知）" --output-mode mmap --pattern random --variants 0 --size 16M --entries 100
+check_backend "内存映射写（布局未知）" "sync"
+check_mode "内存映射写（流式大条目）" --output-mode mmap --pattern mixed --variants 0 --size 40M --entries 2
+check_backend "内存映射写（流式大条目）" "sync"
+
+# 每个条目内容不同，在线程池上并行压缩后按顺序写出
+check_mode "每个条目内容不同（并行压缩）" --pattern random --variants 0 --size 8M --entries 64
+check_mode "每个条目内容不同（4个线程）" --pattern mixed --variants 0 --threads 4 --size 8M --entries 64
+
+# 嵌套：逐层取出内层归档并校验，最内层是普通条目
+check_mode "嵌套3层" --nested 3 --pattern random --size 20M --entries 2
+LEVEL_ARCHIVE="$MODE_DIR/mode.zip"
+for level in 2 1; do
+    unzip -p "$LEVEL_ARCHIVE" "bomb_level_$level.zip" > "$MODE_DIR/level_$level.zip"
+    LEVEL_ARCHIVE="$MODE_DIR/level_$level.zip"
+    verify_archive "嵌套第${level}层" "$LEVEL_ARCHIVE"
+done
+if [ "$(unzip -Z1 "$LEVEL_ARCHIVE" | wc -l)" -ne 2 ]; then
+    fail_mode "嵌套: 最内层条目数不对"
+fi
+
+# 各内容模式，包括周期超过32KB窗口的周期文本
+for pattern in marked constant periodic random mixed; do
+    check_mode "内容模式 $pattern" --pattern $pattern --size 8M --entries 16
+done
+check_mode "长周期文本（周期超过32KB窗口）" --pattern periodic --period 100K --size 4M --entries 4
+
+# 各压缩级别对应的匹配策略
+for level in 1 2 4 6 9; do
+    check_mode "压缩级别$level" --level $level --pattern mixed --size 8M --entries 16
+    check_mode "压缩级别$level 流式大条目" --level $level --pattern periodic --period 50K --variants 0 --size 40M --entries 2
+done
+
+# 常量条目直接编码：大小不是块长度整数倍的条目，以及各压缩级别
+for level in 1 9; do
+    check_mode "常量条目 级别$level" --level $level --pattern constant --size 50000001 --entries 3
+done
+
+# 分块并行压缩
+check_mode "分块并行压缩" --pattern random --chunk 1M --size 24M --entries 2
+check_mode "分块并行压缩（流式）" --pattern mixed --variants 0 --chunk 2M --size 40M --entries 2
+check_mode "内存映射写（分块并行压缩）" --output-mode mmap --pattern mixed --chunk 1M --size 16M --entries 4
+check_backend "内存映射写（分块并行压缩）" "mmap"
+
+# 内存缓冲区和回调输出端
+check_mode "内存缓冲区" --sink buffer --pattern random --variants 0 --size 8M --entries 50
+check_backend "内存缓冲区" "memory"
+check_mode "回调" --sink callback --pattern mixed --size 40M --entries 2
+check_backend "回调" "callback"
+
+# 数据描述符：写到管道（不可回写本地头），包括单遍流式压缩的大条目
+for variants in 1 0; do
+    rm -f "$MODE_DIR/pipe.zip"
+    "$GEN" --data-descriptor --pattern random --variants $variants --size 40M --entries 2 - | cat > "$MODE_DIR/pipe.zip"
+    if [ "${PIPESTATUS[0]}" -ne 0 ]; then
+        fail_mode "数据描述符 variants=$variants: 写到管道失败"
+    fi
+    verify_archive "数据描述符 variants=$variants（写到管道）" "$MODE_DIR/pipe.zip"
+done
+check_mode "数据描述符（普通文件）" --data-descriptor --pattern random --variants 0 --size 8M --entries 16
+check_mode "数据描述符（回调）" --data-descriptor --sink callback --pattern random --size 40M --entries 2
+
+# 上下文接口：文件、内存缓冲区和回调
+check_mode "上下文接口写文件" --context --data-descriptor --size 8M --entries 100
+check_mode "上下文接口写文件（映射）" --context --output-mode mmap --pattern random --size 8M --entries 100
+check_backend "上下文接口写文件（映射）" "mmap"
+check_mode "上下文接口内存缓冲区" --context --sink buffer --pattern random --variants 0 --size 8M --entries 50
+check_backend "上下文接口内存缓冲区" "memory"
+check_mode "上下文接口回调" --context --sink callback --pattern mixed --size 40M --entries 2
+check_backend "上下文接口回调" "callback"
+
+rm -rf "$MODE_DIR"
+log_success "生成模式测试全部通过"
+
+echo
+
 # ============================================================================
 # 功能测试
 # ============================================================================
@@ -226,6 +423,21 @@ log_info "进行安全测试..."
 AVAILABLE_SPACE=$(df . | tail -1 | awk '{print $4}')
 log_info "当前可用磁盘空间: $AVAILABLE_SPACE KB"
 
+# 在内存中解压验证（不写磁盘），核对每个条目的CRC和大小
+if [ -x "$BUILD_DIR/bin/zipbomb_inspect" ]; then
+    log_info "解压验证（只在内存中解压）:"
+    if "$BUILD_DIR/bin/zipbomb_inspect" --verify --verify-seconds 0 --max-ratio 0 --max-entry-ratio 0 \
+        --max-size 0 --max-entry-size 0 bomb.zip; then
+        log_success "解压验证通过"
+    else
+        log_error "解压验证失败"
+        exit 1
+    fi
+else
+    log_error "未找到检查工具: bin/zipbomb_inspect"
+    exit 1
+fi
+
 # 警告用户关于解压测试
 log_warning "⚠️  解压测试警告 ⚠️"
 echo "  解压此文件将占用大约 10GB 磁盘空间"
@@ -291,6 +503,7 @@ log_success "==== 测试总结 ===="
 echo "✅ 编译环境检查通过"
 echo "✅ 项目结构完整"
 echo "✅ 编译成功"
+echo "✅ 各生成模式校验通过"
 echo "✅ ZIP炸弹生成功能正常"
 echo "✅ 文件格式正确"
 
@@ -0,0 +1,45 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 命令行工具共用的参数解析
+ *
+ * 功能: zipbomb_inspect、zipbomb_stress和zipbomb_gen解析大小、比值等
+ *       选项取值时共用的函数
+ * ============================================================================
+ */
+
+#ifndef ZIPBOMB_CLI_ARGS_H
+#define ZIPBOMB_CLI_ARGS_H
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace ZipBombGenerator {
+
+/** 解析带K/M/G/T后缀（1024进制）的大小 */
+inline bool parse_size(const char* text, uint64_t& value) {
+    char* end;
+    const unsigned long long number = std::strtoull(text, &end, 10);
+    if (end == text) return false;
+    unsigned shift = 0;
+    switch (*end) {
+    case 'K': case 'k': shift = 10; end++; break;
+    case 'M': case 'm': shift = 20; end++; break;
+    case 'G': case 'g': shift = 30; end++; break;
+    case 'T': case 't': shift = 40; end++; break;
+    default: break;
+    }
+    if (*end != '\0' || (shift && number > (UINT64_MAX >> shift))) return false;
+    value = static_cast<uint64_t>(number) << shift;
+    return true;
+}
+
+/** 解析非负小数（比值、秒数） */
+inline bool parse_non_negative(const char* text, double& value) {
+    char* end;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && value >= 0.0;
+}
+
+} // namespace ZipBombGenerator
+
+#endif /* ZIPBOMB_CLI_ARGS_H */
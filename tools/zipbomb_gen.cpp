@@ -0,0 +1,253 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 非交互式生成命令行工具
+ *
+ * 功能: 按命令行给出的配置生成归档，可选择文件、内存缓冲区或回调三种输出端，
+ *       以及旧的全局接口或上下文接口；供测试脚本覆盖各种生成模式
+ * 用法: zipbomb_gen [选项] 输出文件
+ *         --size 大小              目标解压大小（可带K/M/G/T后缀，默认10M）
+ *         --entries 数量           条目数（默认1000），每个条目大小为 大小/数量
+ *         --level 级别             压缩级别1-9（默认6）
+ *         --pattern 模式           marked/constant/periodic/random/mixed（默认marked）
+ *         --period 大小            周期文本的周期
+ *         --seed 数值              伪随机种子
+ *         --variants 数量          不同条目内容的份数（默认1，0表示各不相同）
+ *         --chunk 大小             分块并行压缩的块大小（0不分块）
+ *         --nested 层数            嵌套层数（1不嵌套）
+ *         --data-descriptor        本地头之后用数据描述符给出CRC和大小
+ *         --output-mode 模式       sync/async/threads/mmap（默认sync）
+ *         --queue-depth 数量       异步写的队列深度
+ *         --direct-io              异步写使用O_DIRECT
+ *         --threads 数量           工作线程数（0使用全部硬件线程）
+ *         --sink 输出端            file/buffer/callback（默认file）；后两种由本工具写入输出文件
+ *         --context                使用上下文接口而不是全局接口
+ *         --stats                  向标准错误输出一行统计（输出后端、CRC实现、大小）
+ *       输出文件为"-"时写到标准输出
+ * 退出状态: 0成功，1生成失败，2参数错误
+ * ============================================================================
+ */
+
+#include "cli_args.h"
+#include "zipbomb.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using ZipBombGenerator::parse_size;
+
+/** 内容模式名称，与ZIPBOMB_PATTERN_*一一对应 */
+const char* const PATTERN_NAMES[] = {"marked", "constant", "periodic", "random", "mixed"};
+
+/** 输出模式名称，与ZIPBOMB_OUTPUT_*一一对应 */
+const char* const OUTPUT_MODE_NAMES[] = {"sync", "async", "threads", "mmap"};
+
+enum class SinkKind { File, Buffer, Callback };
+
+/** 在名称表中查找，返回下标，找不到返回-1 */
+template <size_t N>
+int find_name(const char* const (&names)[N], const char* text) {
+    for (size_t i = 0; i < N; i++) {
+        if (std::strcmp(names[i], text) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+/** 回调输出端：直接写入打开的文件 */
+int write_to_file(const uint8_t* data, size_t len, void* user_data) {
+    return std::fwrite(data, 1, len, static_cast<FILE*>(user_data)) == len ? 0 : 1;
+}
+
+/** 把内存缓冲区写到输出文件 */
+bool save_buffer(const zipbomb_buffer_t& buffer, FILE* out) {
+    const size_t size = static_cast<size_t>(buffer.size);
+    return std::fwrite(buffer.data, 1, size, out) == size;
+}
+
+FILE* open_output(const char* filename) {
+    return std::strcmp(filename, "-") == 0 ? stdout : std::fopen(filename, "wb");
+}
+
+bool close_output(FILE* out) {
+    return out == stdout ? std::fflush(out) == 0 : std::fclose(out) == 0;
+}
+
+/**
+ * 通过全局接口生成
+ */
+int generate_global(const char* filename, const zipbomb_config_t& config, SinkKind sink, zipbomb_stats_t& stats) {
+    int result;
+    if (sink == SinkKind::File) {
+        result = create_zipbomb_with_config(filename, &config);
+    } else {
+        FILE* out = open_output(filename);
+        if (!out) return ZIPBOMB_ERROR_FILE_CREATE;
+        if (sink == SinkKind::Buffer) {
+            zipbomb_buffer_t buffer = {};
+            result = create_zipbomb_to_buffer(&config, &buffer);
+            if (result == ZIPBOMB_SUCCESS && !save_buffer(buffer, out)) result = ZIPBOMB_ERROR_WRITE_FAILED;
+            zipbomb_buffer_free(&buffer);
+        } else {
+            result = create_zipbomb_to_callback(&config, write_to_file, out);
+        }
+        if (!close_output(out) && result == ZIPBOMB_SUCCESS) result = ZIPBOMB_ERROR_WRITE_FAILED;
+    }
+    get_performance_stats(&stats);
+    return result;
+}
+
+/**
+ * 通过上下文接口生成
+ */
+int generate_with_context(const char* filename, const zipbomb_config_t& config, SinkKind sink,
+                          zipbomb_stats_t& stats) {
+    zipbomb_ctx_t* ctx = zipbomb_ctx_create();
+    if (!ctx) return ZIPBOMB_ERROR_MEMORY_ALLOC;
+    int result = zipbomb_ctx_configure(ctx, &config);
+    if (result == ZIPBOMB_SUCCESS && sink == SinkKind::File) {
+        result = zipbomb_ctx_generate(ctx, filename);
+    } else if (result == ZIPBOMB_SUCCESS) {
+        FILE* out = open_output(filename);
+        if (!out) {
+            result = ZIPBOMB_ERROR_FILE_CREATE;
+        } else {
+            if (sink == SinkKind::Buffer) {
+                zipbomb_buffer_t buffer = {};
+                result = zipbomb_ctx_generate_to_buffer(ctx, &buffer);
+                if (result == ZIPBOMB_SUCCESS && !save_buffer(buffer, out)) result = ZIPBOMB_ERROR_WRITE_FAILED;
+                zipbomb_buffer_free(&buffer);
+            } else {
+                result = zipbomb_ctx_generate_to_callback(ctx, write_to_file, out);
+            }
+            if (!close_output(out) && result == ZIPBOMB_SUCCESS) result = ZIPBOMB_ERROR_WRITE_FAILED;
+        }
+    }
+    zipbomb_ctx_get_stats(ctx, &stats);
+    zipbomb_ctx_destroy(ctx);
+    return result;
+}
+
+void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "用法: %s [--size 大小] [--entries 数量] [--level 级别] [--pattern 模式]\n"
+                 "          [--period 大小] [--seed 数值] [--variants 数量] [--chunk 大小]\n"
+                 "          [--nested 层数] [--data-descriptor] [--output-mode 模式]\n"
+                 "          [--queue-depth 数量] [--direct-io] [--threads 数量]\n"
+                 "          [--sink file|buffer|callback] [--context] [--stats] 输出文件\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    zipbomb_config_t config = get_default_config();
+    config.target_size_bytes = 10 * 1024 * 1024;
+    uint64_t entries = 1000;
+    SinkKind sink = SinkKind::File;
+    bool use_context = false;
+    bool stats_line = false;
+    const char* filename = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        uint64_t number = 0;
+        bool ok = true;
+        if (std::strcmp(arg, "--data-descriptor") == 0) {
+            config.use_data_descriptor = true;
+            continue;
+        } else if (std::strcmp(arg, "--direct-io") == 0) {
+            config.use_direct_io = true;
+            continue;
+        } else if (std::strcmp(arg, "--context") == 0) {
+            use_context = true;
+            continue;
+        } else if (std::strcmp(arg, "--stats") == 0) {
+            stats_line = true;
+            continue;
+        } else if (arg[0] != '-' || std::strcmp(arg, "-") == 0) {
+            ok = !filename;
+            filename = arg;
+            if (ok) continue;
+        } else if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--size") == 0) {
+            ok = parse_size(value, number) && number > 0 && number <= static_cast<uint64_t>(MAX_TARGET_SIZE_BYTES);
+            config.target_size_bytes = static_cast<int64_t>(number);
+        } else if (std::strcmp(arg, "--entries") == 0) {
+            ok = parse_size(value, entries) && entries > 0;
+        } else if (std::strcmp(arg, "--level") == 0) {
+            ok = parse_size(value, number) && number >= 1 && number <= 9;
+            config.compression_level = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--pattern") == 0) {
+            config.pattern_kind = find_name(PATTERN_NAMES, value);
+            ok = config.pattern_kind >= 0;
+        } else if (std::strcmp(arg, "--period") == 0) {
+            ok = parse_size(value, number) && number <= INT64_MAX;
+            config.pattern_period = static_cast<int64_t>(number);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            ok = parse_size(value, config.pattern_seed);
+        } else if (std::strcmp(arg, "--variants") == 0) {
+            ok = parse_size(value, number) && number <= INT64_MAX;
+            config.pattern_variants = static_cast<int64_t>(number);
+        } else if (std::strcmp(arg, "--chunk") == 0) {
+            ok = parse_size(value, number) && number <= INT64_MAX;
+            config.deflate_chunk_size = static_cast<int64_t>(number);
+        } else if (std::strcmp(arg, "--nested") == 0) {
+            ok = parse_size(value, number) && number >= 1 && number <= MAX_NESTED_LEVELS;
+            config.use_nested_compression = number > 1;
+            config.nested_levels = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--output-mode") == 0) {
+            config.output_mode = find_name(OUTPUT_MODE_NAMES, value);
+            ok = config.output_mode >= 0;
+        } else if (std::strcmp(arg, "--queue-depth") == 0) {
+            ok = parse_size(value, number) && number <= MAX_IO_QUEUE_DEPTH;
+            config.io_queue_depth = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            ok = parse_size(value, number) && number <= MAX_THREAD_COUNT;
+            config.thread_count = static_cast<int>(number);
+        } else if (std::strcmp(arg, "--sink") == 0) {
+            if (std::strcmp(value, "file") == 0) {
+                sink = SinkKind::File;
+            } else if (std::strcmp(value, "buffer") == 0) {
+                sink = SinkKind::Buffer;
+            } else if (std::strcmp(value, "callback") == 0) {
+                sink = SinkKind::Callback;
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (!filename) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    // 条目数即max_entries，每个条目的大小由库按目标大小平均分配
+    const uint64_t target = static_cast<uint64_t>(config.target_size_bytes);
+    config.max_entries = static_cast<int64_t>(entries);
+    config.pattern_size = static_cast<int>(std::min<uint64_t>(std::max<uint64_t>(target / entries, 1), INT32_MAX));
+
+    set_verbose_logging(0);
+    zipbomb_stats_t stats = {};
+    const int result = use_context ? generate_with_context(filename, config, sink, stats)
+                                   : generate_global(filename, config, sink, stats);
+    if (result != ZIPBOMB_SUCCESS) {
+        std::fprintf(stderr, "生成失败: %s (%d)\n", get_error_description(result), result);
+        return 1;
+    }
+    if (stats_line) {
+        std::fprintf(stderr, "输出后端: %s, CRC实现: %s, 归档 %lld 字节, 缓冲区内存峰值 %llu 字节\n",
+                     stats.io.backend, zipbomb_crc32_impl(), (long long)stats.archive_size,
+                     (unsigned long long)stats.peak_buffer_bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 归档快速检查命令行工具
+ *
+ * 功能: 对每个文件只读取中央目录，报告声明的解压大小、膨胀比、条目数和
+ *       嵌套归档迹象，并按预算判定是否拒绝；可选地再扫描全部数据，
+ *       核对本地头与中央目录是否一致，或在内存中实际解压核对CRC和大小
+ * 用法: zipbomb_inspect [选项] 文件...
+ *         --max-size 大小          总解压大小上限（可带K/M/G/T后缀，0不限）
+ *         --max-entry-size 大小    单个条目解压大小上限
+ *         --max-ratio 比值         整体膨胀比上限
+ *         --max-entry-ratio 比值   单个条目膨胀比上限
+ *         --max-entries 数量       条目数上限
+ *         --max-nested 数量        嵌套归档迹象上限
+ *         --scan                   同时做一致性扫描，发现问题即拒绝
+ *         --verify                 同时解压验证，发现问题或超出验证预算即拒绝
+ *         --verify-bytes 大小      验证时全部条目解压字节数上限（默认16G，0不限）
+ *         --verify-entry-bytes 大小  验证时单个条目解压字节数上限
+ *         --verify-ratio 比值      验证时单个条目实际膨胀比上限
+ *         --verify-seconds 秒数    验证时间上限（默认60，0不限）
+ *         --threads 数量           验证使用的线程数（0使用全部硬件线程）
+ *         --json                   每个文件输出一行JSON
+ *         --quiet                  只用退出状态报告结果
+ *         --repeat 次数            重复检查，向标准错误报告每秒检查的归档数和扫描吞吐量
+ * 退出状态: 0全部在预算内，1有文件超出预算或扫描、验证发现问题，2有文件无法读取或结构损坏
+ * ============================================================================
+ */
+
+#include "cli_args.h"
+#include "zipbomb_inspect.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" const char* get_error_description(int error_code);
+
+namespace {
+
+using ZipBombGenerator::parse_size;
+using ZipBombGenerator::parse_non_negative;
+
+/** 超出预算的项目名称，与ZIPBOMB_INSPECT_*的位一一对应 */
+const char* const VIOLATION_NAMES[] = {
+    "total_size", "entry_size", "ratio", "entry_ratio", "entry_count", "nested", "overlap"
+};
+
+/** 一致性扫描发现的问题名称，与ZIPBOMB_SCAN_*的位一一对应 */
+const char* const FINDING_NAMES[] = {
+    "missing_local", "mismatch", "overlap", "shared", "stray_local", "stray_central"
+};
+
+/** 不一致的字段名称，与ZIPBOMB_SCAN_FIELD_*的位一一对应 */
+const char* const FIELD_NAMES[] = {
+    "name", "method", "flags", "crc", "size", "descriptor"
+};
+
+/** 解压验证发现的问题名称，与ZIPBOMB_VERIFY_*的位一一对应 */
+const char* const VERIFY_NAMES[] = {
+    "crc", "size", "corrupt", "unsupported", "byte_budget", "ratio_budget", "time_budget"
+};
+
+/** 按位列出名称 */
+template <size_t N>
+std::string bit_list(const char* const (&names)[N], uint32_t bits, const char* separator) {
+    std::string list;
+    for (unsigned bit = 0; bit < N; bit++) {
+        if (!(bits & (1u << bit))) continue;
+        if (!list.empty()) list += separator;
+        list += names[bit];
+    }
+    return list;
+}
+
+/** JSON字符串数组的内容 */
+template <size_t N>
+std::string json_list(const char* const (&names)[N], uint32_t bits) {
+    return bits ? "\"" + bit_list(names, bits, "\", \"") + "\"" : std::string();
+}
+
+/** JSON字符串转义（文件名可能含引号或控制字符） */
+std::string json_escape(const char* text) {
+    std::string out;
+    for (const char* p = text; *p; p++) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+void print_report(const char* filename, int result, const zipbomb_inspect_report_t& report,
+                  const zipbomb_scan_report_t* scan, const zipbomb_verify_report_t* verify, bool json) {
+    if (json) {
+        if (result != ZIPBOMB_SUCCESS) {
+            std::printf("{\"file\": \"%s\", \"error\": %d}\n", json_escape(filename).c_str(), result);
+            return;
+        }
+        const bool accepted = !report.violations && !(scan && scan->findings) && !(verify && verify->failures);
+        std::printf("{\"file\": \"%s\", \"accepted\": %s, \"violations\": [%s], \"archive_size\": %llu, "
+                    "\"entries\": %llu, \"total_uncompressed\": %llu, \"total_compressed\": %llu, "
+                    "\"max_entry_uncompressed\": %llu, \"ratio\": %.3f, \"max_entry_ratio\": %.3f, "
+                    "\"max_ratio_entry\": %llu, \"nested_archives\": %llu, \"overlapping_entries\": %llu, "
+                    "\"zip64\": %s",
+                    json_escape(filename).c_str(), accepted ? "true" : "false",
+                    json_list(VIOLATION_NAMES, report.violations).c_str(),
+                    (unsigned long long)report.archive_size, (unsigned long long)report.entry_count,
+                    (unsigned long long)report.total_uncompressed, (unsigned long long)report.total_compressed,
+                    (unsigned long long)report.max_entry_uncompressed, report.ratio, report.max_entry_ratio,
+                    (unsigned long long)report.max_ratio_entry, (unsigned long long)report.nested_archives,
+                    (unsigned long long)report.overlapping_entries, report.zip64 ? "true" : "false");
+        if (scan) {
+            std::printf(", \"scan\": {\"findings\": [%s], \"mismatched_fields\": [%s], "
+                        "\"local_signatures\": %llu, \"central_signatures\": %llu, \"missing_local\": %llu, "
+                        "\"mismatched_entries\": %llu, \"overlapping_entries\": %llu, \"shared_entries\": %llu, "
+                        "\"embedded_signatures\": %llu, \"stray_local_headers\": %llu, "
+                        "\"stray_central_headers\": %llu}",
+                        json_list(FINDING_NAMES, scan->findings).c_str(),
+                        json_list(FIELD_NAMES, scan->mismatched_fields).c_str(),
+                        (unsigned long long)scan->local_signatures, (unsigned long long)scan->central_signatures,
+                        (unsigned long long)scan->missing_local, (unsigned long long)scan->mismatched_entries,
+                        (unsigned long long)scan->overlapping_entries, (unsigned long long)scan->shared_entries,
+                        (unsigned long long)scan->embedded_signatures, (unsigned long long)scan->stray_local_headers,
+                        (unsigned long long)scan->stray_central_headers);
+        }
+        if (verify) {
+            std::printf(", \"verify\": {\"failures\": [%s], \"verified_entries\": %llu, \"failed_entries\": %llu, "
+                        "\"skipped_entries\": %llu, \"first_failed_entry\": %llu, \"bytes_in\": %llu, "
+                        "\"bytes_out\": %llu, \"max_entry_bytes\": %llu, \"max_ratio\": %.3f, "
+                        "\"wall_time_ns\": %llu, \"mb_in_per_sec\": %.1f, \"mb_out_per_sec\": %.1f, \"threads\": %u}",
+                        json_list(VERIFY_NAMES, verify->failures).c_str(),
+                        (unsigned long long)verify->verified_entries, (unsigned long long)verify->failed_entries,
+                        (unsigned long long)verify->skipped_entries, (unsigned long long)verify->first_failed_entry,
+                        (unsigned long long)verify->bytes_in, (unsigned long long)verify->bytes_out,
+                        (unsigned long long)verify->max_entry_bytes, verify->max_ratio,
+                        (unsigned long long)verify->wall_time_ns, verify->mb_in_per_sec, verify->mb_out_per_sec,
+                        verify->threads);
+        }
+        std::printf("}\n");
+        return;
+    }
+
+    if (result != ZIPBOMB_SUCCESS) {
+        std::printf("%s: 错误 %d (%s)\n", filename, result, get_error_description(result));
+        return;
+    }
+    std::printf("%s: %s 条目 %llu, 声明解压 %llu 字节, 归档 %llu 字节, 膨胀比 %.1f, "
+                "单条目最大膨胀比 %.1f (#%llu), 嵌套归档 %llu, 重叠条目 %llu%s",
+                filename,
+                (report.violations || (scan && scan->findings) || (verify && verify->failures)) ? "拒绝" : "通过",
+                (unsigned long long)report.entry_count, (unsigned long long)report.total_uncompressed,
+                (unsigned long long)report.archive_size, report.ratio, report.max_entry_ratio,
+                (unsigned long long)report.max_ratio_entry, (unsigned long long)report.nested_archives,
+                (unsigned long long)report.overlapping_entries, report.zip64 ? ", ZIP64" : "");
+    if (report.violations) std::printf(" [超出: %s]", bit_list(VIOLATION_NAMES, report.violations, ", ").c_str());
+    std::printf("\n");
+    if (scan) {
+        std::printf("  一致性: 缺失本地头 %llu, 不一致 %llu, 重叠 %llu, 共用本地头 %llu, "
+                    "游离本地头签名 %llu, 游离中央目录签名 %llu, 数据内签名 %llu",
+                    (unsigned long long)scan->missing_local, (unsigned long long)scan->mismatched_entries,
+                    (unsigned long long)scan->overlapping_entries, (unsigned long long)scan->shared_entries,
+                    (unsigned long long)scan->stray_local_headers, (unsigned long long)scan->stray_central_headers,
+                    (unsigned long long)scan->embedded_signatures);
+        if (scan->mismatched_fields) {
+            std::printf(" [不一致字段: %s]", bit_list(FIELD_NAMES, scan->mismatched_fields, ", ").c_str());
+        }
+        if (scan->findings) std::printf(" [问题: %s]", bit_list(FINDING_NAMES, scan->findings, ", ").c_str());
+        std::printf("\n");
+    }
+    if (verify) {
+        std::printf("  解压验证: 通过 %llu, 失败 %llu, 未开始 %llu, 解压 %llu 字节, 单条目最大 %llu 字节, "
+                    "实际膨胀比最大 %.1f, %.3f 秒 (%.1f MB/s, %u 线程)",
+                    (unsigned long long)verify->verified_entries, (unsigned long long)verify->failed_entries,
+                    (unsigned long long)verify->skipped_entries, (unsigned long long)verify->bytes_out,
+                    (unsigned long long)verify->max_entry_bytes, verify->max_ratio,
+                    static_cast<double>(verify->wall_time_ns) / 1e9, verify->mb_out_per_sec, verify->threads);
+        if (verify->failures) {
+            std::printf(" [问题: %s, 首个 #%llu]", bit_list(VERIFY_NAMES, verify->failures, ", ").c_str(),
+                        (unsigned long long)verify->first_failed_entry);
+        }
+        std::printf("\n");
+    }
+}
+
+void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "用法: %s [--max-size 大小] [--max-entry-size 大小] [--max-ratio 比值]\n"
+                 "          [--max-entry-ratio 比值] [--max-entries 数量] [--max-nested 数量]\n"
+                 "          [--scan] [--verify] [--verify-bytes 大小] [--verify-entry-bytes 大小]\n"
+                 "          [--verify-ratio 比值] [--verify-seconds 秒数] [--threads 数量]\n"
+                 "          [--json] [--quiet] [--repeat 次数] 文件...\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    zipbomb_inspect_budget_t budget = zipbomb_inspect_default_budget();
+    bool json = false;
+    bool quiet = false;
+    bool scan = false;
+    bool verify = false;
+    zipbomb_verify_budget_t verify_budget = zipbomb_verify_default_budget();
+    uint64_t repeat = 1;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (std::strcmp(arg, "--json") == 0) {
+            json = true;
+            continue;
+        } else if (std::strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+            continue;
+        } else if (std::strcmp(arg, "--scan") == 0) {
+            scan = true;
+            continue;
+        } else if (std::strcmp(arg, "--verify") == 0) {
+            verify = true;
+            continue;
+        } else if (arg[0] != '-' || std::strcmp(arg, "-") == 0) {
+            files.push_back(arg);
+            continue;
+        } else if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--max-size") == 0) {
+            ok = parse_size(value, budget.max_total_uncompressed);
+        } else if (std::strcmp(arg, "--max-entry-size") == 0) {
+            ok = parse_size(value, budget.max_entry_uncompressed);
+        } else if (std::strcmp(arg, "--max-ratio") == 0) {
+            ok = parse_non_negative(value, budget.max_ratio);
+        } else if (std::strcmp(arg, "--max-entry-ratio") == 0) {
+            ok = parse_non_negative(value, budget.max_entry_ratio);
+        } else if (std::strcmp(arg, "--max-entries") == 0) {
+            ok = parse_size(value, budget.max_entries);
+        } else if (std::strcmp(arg, "--max-nested") == 0) {
+            ok = parse_size(value, budget.max_nested_archives);
+        } else if (std::strcmp(arg, "--verify-bytes") == 0) {
+            ok = parse_size(value, verify_budget.max_total_bytes);
+        } else if (std::strcmp(arg, "--verify-entry-bytes") == 0) {
+            ok = parse_size(value, verify_budget.max_entry_bytes);
+        } else if (std::strcmp(arg, "--verify-ratio") == 0) {
+            ok = parse_non_negative(value, verify_budget.max_ratio);
+        } else if (std::strcmp(arg, "--verify-seconds") == 0) {
+            ok = parse_non_negative(value, verify_budget.max_seconds);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            uint64_t threads;
+            ok = parse_size(value, threads) && threads <= 1024;
+            verify_budget.thread_count = static_cast<int>(threads);
+        } else if (std::strcmp(arg, "--repeat") == 0) {
+            ok = parse_size(value, repeat) && repeat > 0;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (files.empty()) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    uint64_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t round = 0; round < repeat; round++) {
+        for (const char* file : files) {
+            zipbomb_inspect_report_t report;
+            zipbomb_scan_report_t scan_report = {};
+            zipbomb_verify_report_t verify_report = {};
+            int result = zipbomb_inspect_file(file, &budget, &report);
+            if (scan && result == ZIPBOMB_SUCCESS) result = zipbomb_scan_file(file, &scan_report);
+            if (verify && result == ZIPBOMB_SUCCESS) result = zipbomb_verify_file(file, &verify_budget, &verify_report);
+            bytes += report.archive_size;
+            if (round > 0) continue;
+            if (result != ZIPBOMB_SUCCESS) {
+                status = 2;
+            } else if ((report.violations || scan_report.findings || verify_report.failures) && status == 0) {
+                status = 1;
+            }
+            if (!quiet) {
+                print_report(file, result, report, scan ? &scan_report : nullptr, verify ? &verify_report : nullptr,
+                             json);
+            }
+        }
+    }
+    if (repeat > 1) {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double archives = static_cast<double>(repeat) * static_cast<double>(files.size());
+        std::fprintf(stderr, "检查 %.0f 个归档用时 %.3f 秒，%.0f 个/秒", archives, seconds, archives / seconds);
+        if (scan) {
+            std::fprintf(stderr, "，扫描 %.1f MB/s (%s)", static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds,
+                         zipbomb_scan_implementation());
+        }
+        std::fprintf(stderr, "\n");
+    }
+    return status;
+}
@@ -0,0 +1,650 @@
+/**
+ * ============================================================================
+ * Fortran ZIP炸弹项目 - 解压工具压力测试
+ *
+ * 功能: 生成（或指定）测试归档，在资源受限的环境中逐个运行解压命令，
+ *       测量各命令的墙钟时间、CPU时间、峰值RSS和写出的字节数，超出预算
+ *       即杀掉；结果输出为表格和JSON，生成归档的统计附在一起
+ * 用法: zipbomb_stress [选项] [归档...]
+ *         --generate 大小[:条目数]  生成测试归档（可重复），如 1G:1000
+ *         --command 命令            解压命令（可重复），{}替换为归档路径；命令按空白
+ *                                   切分后直接执行，不经过shell
+ *         --memory 大小             地址空间上限(RLIMIT_AS)，RSS超过时也杀掉（默认1G，0不限）
+ *         --cpu 秒数                CPU时间上限(RLIMIT_CPU，默认10，0不限)
+ *         --file-size 大小          单个文件大小上限(RLIMIT_FSIZE，默认1G，0不限)
+ *         --write-bytes 大小        写出字节数（/proc/<pid>/io的wchar）上限（默认4G，0不限）
+ *         --wall 秒数               墙钟时间上限（默认30，0不限）
+ *         --interval 毫秒           采样间隔（默认10）
+ *         --workdir 目录            工作目录的上级目录（默认/dev/shm，不可用时为$TMPDIR或/tmp）
+ *         --json 文件               把结果以JSON写入文件（"-"为标准输出）
+ *         --quiet                   不输出表格
+ * 说明: 每次运行都在新建的私有目录（权限0700）中进行，运行后删除；以root
+ *       运行时在该目录上挂载大小受限的tmpfs，否则使用上级目录所在的文件
+ *       系统（/dev/shm通常就是tmpfs）。命令放在单独的进程组里，超出预算时
+ *       整组杀掉；采样只统计命令进程本身，CPU时间和峰值RSS取自wait4，
+ *       包含其已回收的子进程
+ * 退出状态: 0所有命令都在预算内结束，1有命令超出预算被杀或因资源限制终止，
+ *           2参数错误、无法生成归档或无法建立工作目录
+ * ============================================================================
+ */
+
+#include "cli_args.h"
+#include "zipbomb.h"
+#include "perf_stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <ftw.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using ZipBombGenerator::parse_size;
+using ZipBombGenerator::parse_non_negative;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr long TMPFS_MAGIC_NUMBER = 0x01021994;
+
+/** 执行失败时子进程的退出状态，与shell相同 */
+constexpr int EXIT_EXEC_FAILED = 127;
+
+/** nftw回调的统计结果（回调不能带用户数据） */
+uint64_t g_usage_bytes = 0;
+uint64_t g_usage_files = 0;
+
+/** 预算 */
+struct Limits {
+    uint64_t memory = 1ULL << 30;
+    uint64_t cpu_seconds = 10;
+    uint64_t file_size = 1ULL << 30;
+    uint64_t write_bytes = 4ULL << 30;
+    double wall_seconds = 30.0;
+    uint64_t interval_ms = 10;
+};
+
+/** 测试归档：已有文件或按大小和条目数生成 */
+struct Fixture {
+    std::string path;
+    uint64_t target = 0;        // 非0时生成
+    uint64_t entries = 1;
+    bool generated = false;
+    zipbomb_stats_t stats = {};
+    uint64_t archive_size = 0;
+};
+
+/** 一次运行的测量结果 */
+struct RunResult {
+    std::string command;
+    const char* status = "ok";  // ok、exit、signal、killed、not_found、error
+    const char* killed_by = ""; // 超出的预算：wall、memory、write_bytes、cpu、file_size
+    int exit_code = 0;
+    int signal = 0;
+    uint64_t wall_ns = 0;
+    uint64_t user_ns = 0;
+    uint64_t system_ns = 0;
+    uint64_t peak_rss_bytes = 0;
+    uint64_t bytes_written = 0;
+    uint64_t disk_bytes = 0;    // 运行结束时工作目录中文件占用的空间
+    uint64_t files = 0;
+    uint64_t samples = 0;
+};
+
+/** 解析"大小[:条目数]" */
+bool parse_fixture(const char* text, Fixture& fixture) {
+    std::string spec(text);
+    const size_t colon = spec.find(':');
+    if (!parse_size(spec.substr(0, colon).c_str(), fixture.target) || fixture.target == 0) return false;
+    if (colon == std::string::npos) return true;
+    return parse_size(spec.c_str() + colon + 1, fixture.entries) && fixture.entries > 0;
+}
+
+/** JSON字符串转义 */
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (const char ch : text) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+/** 把命令模板按空白切分，{}替换为归档路径 */
+std::vector<std::string> expand_command(const std::string& command, const std::string& fixture) {
+    std::vector<std::string> args;
+    std::istringstream words(command);
+    std::string word;
+    while (words >> word) {
+        for (size_t pos; (pos = word.find("{}")) != std::string::npos;) word.replace(pos, 2, fixture);
+        args.push_back(word);
+    }
+    return args;
+}
+
+/**
+ * 按PATH查找可执行文件；含'/'的相对路径改为绝对路径（命令在工作目录中执行）
+ */
+bool find_executable(std::string& name) {
+    if (name.find('/') != std::string::npos) {
+        char resolved[PATH_MAX];
+        if (!realpath(name.c_str(), resolved) || access(resolved, X_OK) != 0) return false;
+        name = resolved;
+        return true;
+    }
+    const char* path = std::getenv("PATH");
+    std::istringstream dirs(path ? path : "/usr/bin:/bin");
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        if (access(((dir.empty() ? "." : dir) + "/" + name).c_str(), X_OK) == 0) return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// 工作目录
+// ============================================================================
+
+/** 默认的上级目录：/dev/shm可写时用它，否则$TMPDIR或/tmp */
+std::string default_workdir_base() {
+    if (access("/dev/shm", W_OK | X_OK) == 0) return "/dev/shm";
+    const char* tmp = std::getenv("TMPDIR");
+    return tmp && *tmp ? tmp : "/tmp";
+}
+
+/**
+ * 私有工作目录，析构时删除其中所有内容
+ */
+class WorkDir {
+public:
+    WorkDir() = default;
+    ~WorkDir() { remove(); }
+
+    WorkDir(const WorkDir&) = delete;
+    WorkDir& operator=(const WorkDir&) = delete;
+
+    /**
+     * 新建目录；以root运行时尝试挂载大小为size_limit的tmpfs
+     */
+    bool create(const std::string& base, uint64_t size_limit) {
+        std::string pattern = base + "/zipbomb_stress.XXXXXX";
+        if (!mkdtemp(&pattern[0])) return false;  // mkdtemp创建的目录权限为0700
+        path_ = pattern;
+#ifdef __linux__
+        if (geteuid() == 0) {
+            const std::string options = "mode=0700" + (size_limit ? ",size=" + std::to_string(size_limit) : "");
+            mounted_ = mount("tmpfs", path_.c_str(), "tmpfs", MS_NOSUID | MS_NODEV, options.c_str()) == 0;
+        }
+#else
+        (void)size_limit;
+#endif
+        struct statfs fs;
+        tmpfs_ = statfs(path_.c_str(), &fs) == 0 && static_cast<long>(fs.f_type) == TMPFS_MAGIC_NUMBER;
+        return true;
+    }
+
+    /** 统计目录中文件占用的空间 */
+    void usage(uint64_t& bytes, uint64_t& files) const {
+        g_usage_bytes = 0;
+        g_usage_files = 0;
+        nftw(path_.c_str(), count_entry, 16, FTW_PHYS);
+        bytes = g_usage_bytes;
+        files = g_usage_files;
+    }
+
+    /** 删除目录中的内容，保留目录本身供下一次运行 */
+    void clear() {
+        if (path_.empty()) return;
+        nftw(path_.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+        mkdir(path_.c_str(), 0700);
+    }
+
+    void remove() {
+        if (path_.empty()) return;
+#ifdef __linux__
+        if (mounted_) umount2(path_.c_str(), MNT_DETACH);
+#endif
+        nftw(path_.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+        path_.clear();
+    }
+
+    const std::string& path() const { return path_; }
+    const char* filesystem() const { return mounted_ ? "tmpfs(private)" : tmpfs_ ? "tmpfs" : "other"; }
+
+private:
+    static int count_entry(const char*, const struct stat* st, int type, struct FTW*) {
+        if (type == FTW_F) {
+            g_usage_bytes += static_cast<uint64_t>(st->st_blocks) * 512;
+            g_usage_files++;
+        }
+        return 0;
+    }
+
+    static int remove_entry(const char* path, const struct stat*, int, struct FTW*) {
+        ::remove(path);
+        return 0;
+    }
+
+    std::string path_;
+    bool mounted_ = false;
+    bool tmpfs_ = false;
+};
+
+// ============================================================================
+// 运行与采样
+// ============================================================================
+
+/** 读取/proc/<pid>/下的一个文件 */
+std::string read_proc(pid_t pid, const char* name) {
+    std::ifstream file("/proc/" + std::to_string(pid) + "/" + name);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+/** 取"键: 值"格式中某个键的数值 */
+uint64_t proc_field(const std::string& text, const char* key) {
+    const size_t pos = text.find(key);
+    if (pos == std::string::npos) return 0;
+    return std::strtoull(text.c_str() + pos + std::strlen(key), nullptr, 10);
+}
+
+/** 采样一次：峰值RSS和写出的字节数 */
+void sample(pid_t pid, RunResult& result) {
+    const uint64_t peak = proc_field(read_proc(pid, "status"), "VmHWM:") * 1024;
+    if (peak > result.peak_rss_bytes) result.peak_rss_bytes = peak;
+    const uint64_t written = proc_field(read_proc(pid, "io"), "wchar:");
+    if (written > result.bytes_written) result.bytes_written = written;
+    result.samples++;
+}
+
+/** 设置资源限制，0表示不限 */
+void set_limit(int resource, uint64_t soft, uint64_t hard) {
+    struct rlimit limit;
+    limit.rlim_cur = soft ? static_cast<rlim_t>(soft) : RLIM_INFINITY;
+    limit.rlim_max = hard ? static_cast<rlim_t>(hard) : RLIM_INFINITY;
+    setrlimit(resource, &limit);
+}
+
+/**
+ * fork之后在子进程中设置限制并执行命令，只调用异步信号安全的函数
+ *
+ * @param error_fd exec失败时把errno写入其中（exec成功时随O_CLOEXEC关闭）
+ */
+[[noreturn]] void exec_child(char* const* argv, const char* workdir, const Limits& limits, int error_fd) {
+    setpgid(0, 0);
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGKILL);  // 测试程序异常退出时不留下失控的命令
+#endif
+    int error = 0;
+    if (chdir(workdir) != 0) {
+        error = errno;
+        (void)!write(error_fd, &error, sizeof(error));
+        _exit(EXIT_EXEC_FAILED);
+    }
+    const int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (null_fd > STDERR_FILENO) close(null_fd);
+    }
+    set_limit(RLIMIT_AS, limits.memory, limits.memory);
+    // 软限制先发SIGXCPU，硬限制多给1秒后SIGKILL
+    set_limit(RLIMIT_CPU, limits.cpu_seconds, limits.cpu_seconds ? limits.cpu_seconds + 1 : 0);
+    set_limit(RLIMIT_FSIZE, limits.file_size, limits.file_size);
+    const struct rlimit no_core = {0, 0};
+    setrlimit(RLIMIT_CORE, &no_core);
+    execvp(argv[0], argv);
+    error = errno;
+    (void)!write(error_fd, &error, sizeof(error));
+    _exit(EXIT_EXEC_FAILED);
+}
+
+inline uint64_t timeval_ns(const struct timeval& tv) {
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000000ULL + static_cast<uint64_t>(tv.tv_usec) * 1000ULL;
+}
+
+/**
+ * 在工作目录中运行一条命令，按间隔采样，超出预算时杀掉整个进程组
+ */
+RunResult run_command(const std::string& command, const std::string& fixture, const WorkDir& workdir,
+                      const Limits& limits) {
+    RunResult result;
+    result.command = command;
+    std::vector<std::string> args = expand_command(command, fixture);
+    if (args.empty() || !find_executable(args[0])) {
+        result.status = "not_found";
+        return result;
+    }
+    std::vector<char*> argv;
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    int error_pipe[2];
+    if (pipe2(error_pipe, O_CLOEXEC) != 0) {
+        result.status = "error";
+        return result;
+    }
+    const Clock::time_point start = Clock::now();
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(error_pipe[0]);
+        close(error_pipe[1]);
+        result.status = "error";
+        return result;
+    }
+    if (pid == 0) exec_child(argv.data(), workdir.path().c_str(), limits, error_pipe[1]);
+    setpgid(pid, pid);  // 与子进程中的调用竞争，保证kill(-pid)之前进程组已经存在
+    close(error_pipe[1]);
+    int exec_error = 0;
+    ssize_t got;
+    while ((got = read(error_pipe[0], &exec_error, sizeof(exec_error))) < 0 && errno == EINTR) {}
+    close(error_pipe[0]);
+
+    const struct timespec interval = {
+        static_cast<time_t>(limits.interval_ms / 1000), static_cast<long>(limits.interval_ms % 1000) * 1000000L
+    };
+    for (;;) {
+        // WNOWAIT让结束的进程保持僵尸状态，还能从/proc读最后一次
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOHANG | WNOWAIT) != 0) break;
+        sample(pid, result);
+        if (info.si_pid == pid) break;
+
+        const char* exceeded = nullptr;
+        if (limits.wall_seconds > 0.0 &&
+            std::chrono::duration<double>(Clock::now() - start).count() > limits.wall_seconds) {
+            exceeded = "wall";
+        } else if (limits.memory && result.peak_rss_bytes > limits.memory) {
+            exceeded = "memory";
+        } else if (limits.write_bytes && result.bytes_written > limits.write_bytes) {
+            exceeded = "write_bytes";
+        }
+        if (exceeded && !*result.killed_by) {
+            result.killed_by = exceeded;
+            kill(-pid, SIGKILL);
+            kill(pid, SIGKILL);
+        }
+        nanosleep(&interval, nullptr);
+    }
+    kill(-pid, SIGKILL);  // 命令自己结束后留下的后台子进程
+
+    int status = 0;
+    struct rusage usage = {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+    result.wall_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    result.user_ns = timeval_ns(usage.ru_utime);
+    result.system_ns = timeval_ns(usage.ru_stime);
+    const uint64_t max_rss = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    if (max_rss > result.peak_rss_bytes) result.peak_rss_bytes = max_rss;
+    workdir.usage(result.disk_bytes, result.files);
+
+    if (got > 0) {
+        result.status = "error";  // 没能执行命令
+        result.exit_code = exec_error;
+    } else if (WIFEXITED(status)) {
+        result.exit_code = WEXITSTATUS(status);
+        if (result.exit_code != 0) result.status = "exit";
+    } else if (WIFSIGNALED(status)) {
+        result.signal = WTERMSIG(status);
+        result.status = "signal";
+        // 资源限制：CPU软限制发SIGXCPU，到硬限制时内核直接SIGKILL；超出文件大小发SIGXFSZ
+        if (!*result.killed_by && (result.signal == SIGXCPU ||
+                   (result.signal == SIGKILL && limits.cpu_seconds &&
+                    (result.user_ns + result.system_ns) / 1000000000ULL >= limits.cpu_seconds))) {
+            result.killed_by = "cpu";
+        } else if (!*result.killed_by && result.signal == SIGXFSZ) {
+            result.killed_by = "file_size";
+        }
+    }
+    if (*result.killed_by) result.status = "killed";  // 包括杀掉之前恰好自己退出的情况
+    return result;
+}
+
+// ============================================================================
+// 输出
+// ============================================================================
+
+inline double mb(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+/** 按显示宽度补齐表头（汉字占3字节、显示2列） */
+std::string column(const char* text, size_t width, bool left) {
+    size_t display = 0;
+    for (const char* p = text; *p; p++) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if ((c & 0xC0) != 0x80) display += c >= 0xE0 ? 2 : 1;
+    }
+    const std::string padding(display < width ? width - display : 0, ' ');
+    return left ? text + padding : padding + text;
+}
+
+void print_table(const Fixture& fixture, const std::vector<RunResult>& runs) {
+    std::printf("归档: %s (%llu 字节)\n", fixture.path.c_str(), (unsigned long long)fixture.archive_size);
+    if (fixture.generated) print_performance_stats();
+    std::printf("%s %s %s %s %s %s %s %s\n", column("命令", 40, true).c_str(), column("结果", 18, true).c_str(),
+                column("墙钟(秒)", 10, false).c_str(), column("CPU(秒)", 10, false).c_str(),
+                column("峰值RSS(MB)", 12, false).c_str(), column("写出(MB)", 12, false).c_str(),
+                column("占用(MB)", 12, false).c_str(), column("文件数", 8, false).c_str());
+    for (const RunResult& run : runs) {
+        std::string outcome = run.status;
+        if (*run.killed_by) {
+            outcome += std::string("(") + run.killed_by + ")";
+        } else if (run.signal) {
+            outcome += "(" + std::to_string(run.signal) + ")";
+        } else if (run.exit_code) {
+            outcome += "(" + std::to_string(run.exit_code) + ")";
+        }
+        const std::string command = run.command.size() > 40 ? "..." + run.command.substr(run.command.size() - 37)
+                                                            : run.command;
+        std::printf("%-40s %-18s %10.3f %10.3f %12.1f %12.1f %12.1f %8llu\n",
+                    command.c_str(), outcome.c_str(), static_cast<double>(run.wall_ns) / 1e9,
+                    static_cast<double>(run.user_ns + run.system_ns) / 1e9, mb(run.peak_rss_bytes),
+                    mb(run.bytes_written), mb(run.disk_bytes), (unsigned long long)run.files);
+    }
+    std::printf("\n");
+}
+
+std::string format_json(const Limits& limits, const char* filesystem, const std::vector<Fixture>& fixtures,
+                        const std::vector<std::vector<RunResult>>& runs) {
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"limits\": {\"memory\": " << limits.memory << ", \"cpu_seconds\": " << limits.cpu_seconds
+        << ", \"file_size\": " << limits.file_size << ", \"write_bytes\": " << limits.write_bytes
+        << ", \"wall_seconds\": " << limits.wall_seconds << ", \"interval_ms\": " << limits.interval_ms << "},\n"
+        << "  \"workdir_filesystem\": \"" << filesystem << "\",\n"
+        << "  \"fixtures\": [\n";
+    for (size_t f = 0; f < fixtures.size(); f++) {
+        const Fixture& fixture = fixtures[f];
+        out << "    {\"fixture\": \"" << json_escape(fixture.path) << "\", \"archive_size\": " << fixture.archive_size;
+        if (fixture.generated) {
+            std::string generation = ZipBombGenerator::format_stats(fixture.stats, ZIPBOMB_STATS_JSON);
+            if (!generation.empty() && generation.back() == '\n') generation.pop_back();
+            out << ", \"target_size\": " << fixture.target << ", \"entries\": " << fixture.entries
+                << ", \"generation\": " << generation;
+        }
+        out << ", \"runs\": [\n";
+        for (size_t r = 0; r < runs[f].size(); r++) {
+            const RunResult& run = runs[f][r];
+            out << "      {\"command\": \"" << json_escape(run.command) << "\", \"status\": \"" << run.status
+                << "\", \"killed_by\": \"" << run.killed_by << "\", \"exit_code\": " << run.exit_code
+                << ", \"signal\": " << run.signal << ", \"wall_ns\": " << run.wall_ns
+                << ", \"user_ns\": " << run.user_ns << ", \"system_ns\": " << run.system_ns
+                << ", \"peak_rss_bytes\": " << run.peak_rss_bytes << ", \"bytes_written\": " << run.bytes_written
+                << ", \"disk_bytes\": " << run.disk_bytes << ", \"files\": " << run.files
+                << ", \"samples\": " << run.samples << "}" << (r + 1 < runs[f].size() ? ",\n" : "\n");
+        }
+        out << "    ]}" << (f + 1 < fixtures.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n"
+        << "}\n";
+    return out.str();
+}
+
+void print_usage(const char* program) {
+    std::fprintf(stderr,
+                 "用法: %s [--generate 大小[:条目数]] [--command 命令] [--memory 大小] [--cpu 秒数]\n"
+                 "          [--file-size 大小] [--write-bytes 大小] [--wall 秒数] [--interval 毫秒]\n"
+                 "          [--workdir 目录] [--json 文件] [--quiet] [归档...]\n",
+                 program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Limits limits;
+    std::vector<Fixture> fixtures;
+    std::vector<std::string> commands;
+    std::string workdir_base = default_workdir_base();
+    std::string json_file;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (std::strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+            continue;
+        } else if (arg[0] != '-') {
+            Fixture fixture;
+            fixture.path = arg;
+            fixtures.push_back(fixture);
+            continue;
+        } else if (!value) {
+            ok = false;
+        } else if (std::strcmp(arg, "--generate") == 0) {
+            Fixture fixture;
+            ok = parse_fixture(value, fixture);
+            fixtures.push_back(fixture);
+        } else if (std::strcmp(arg, "--command") == 0) {
+            commands.push_back(value);
+        } else if (std::strcmp(arg, "--memory") == 0) {
+            ok = parse_size(value, limits.memory);
+        } else if (std::strcmp(arg, "--cpu") == 0) {
+            ok = parse_size(value, limits.cpu_seconds);
+        } else if (std::strcmp(arg, "--file-size") == 0) {
+            ok = parse_size(value, limits.file_size);
+        } else if (std::strcmp(arg, "--write-bytes") == 0) {
+            ok = parse_size(value, limits.write_bytes);
+        } else if (std::strcmp(arg, "--wall") == 0) {
+            ok = parse_non_negative(value, limits.wall_seconds);
+        } else if (std::strcmp(arg, "--interval") == 0) {
+            ok = parse_size(value, limits.interval_ms) && limits.interval_ms > 0;
+        } else if (std::strcmp(arg, "--workdir") == 0) {
+            workdir_base = value;
+        } else if (std::strcmp(arg, "--json") == 0) {
+            json_file = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (fixtures.empty()) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (commands.empty()) {
+        // 默认：常见的解压工具和本项目的检查工具（与本程序在同一目录）
+        const std::string self(argv[0]);
+        const size_t slash = self.rfind('/');
+        const std::string bindir = slash == std::string::npos ? "." : self.substr(0, slash);
+        commands = {"unzip -qq -o {}", "bsdtar -xf {}", bindir + "/zipbomb_inspect --quiet --scan --verify {}"};
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // 生成的归档放在单独的目录里，与解压命令的工作目录分开
+    WorkDir fixture_dir;
+    WorkDir run_dir;
+    if (!fixture_dir.create(workdir_base, 0) || !run_dir.create(workdir_base, limits.file_size)) {
+        std::fprintf(stderr, "无法在 %s 下建立工作目录: %s\n", workdir_base.c_str(), std::strerror(errno));
+        return 2;
+    }
+
+    set_verbose_logging(0);
+    int status = 0;
+    std::vector<std::vector<RunResult>> runs(fixtures.size());
+    for (size_t f = 0; f < fixtures.size(); f++) {
+        Fixture& fixture = fixtures[f];
+        if (fixture.target) {
+            zipbomb_config_t config = get_default_config();
+            config.target_size_bytes = static_cast<int64_t>(fixture.target);
+            config.max_entries = 0;
+            config.pattern_size = static_cast<int>(std::min<uint64_t>(fixture.target / fixture.entries, INT32_MAX));
+            fixture.path = fixture_dir.path() + "/fixture" + std::to_string(f) + "_" +
+                           std::to_string(fixture.target) + "_" + std::to_string(fixture.entries) + ".zip";
+            const int result = create_zipbomb_with_config(fixture.path.c_str(), &config);
+            if (result != ZIPBOMB_SUCCESS) {
+                std::fprintf(stderr, "生成归档失败: %s (%d)\n", fixture.path.c_str(), result);
+                return 2;
+            }
+            fixture.generated = true;
+            get_performance_stats(&fixture.stats);
+        } else {
+            char resolved[PATH_MAX];
+            if (!realpath(fixture.path.c_str(), resolved)) {
+                std::fprintf(stderr, "无法读取归档: %s\n", fixture.path.c_str());
+                return 2;
+            }
+            fixture.path = resolved;  // 命令在工作目录中运行，需要绝对路径
+        }
+        struct stat st;
+        fixture.archive_size = stat(fixture.path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+
+        for (const std::string& command : commands) {
+            runs[f].push_back(run_command(command, fixture.path, run_dir, limits));
+            run_dir.clear();
+            if (std::strcmp(runs[f].back().status, "killed") == 0) status = 1;
+        }
+        if (!quiet) print_table(fixture, runs[f]);
+    }
+
+    if (!json_file.empty()) {
+        const std::string json = format_json(limits, run_dir.filesystem(), fixtures, runs);
+        if (json_file == "-") {
+            std::cout << json << std::flush;
+        } else {
+            std::ofstream out(json_file);
+            out << json;
+            if (!out.flush()) {
+                std::fprintf(stderr, "无法写入结果文件: %s\n", json_file.c_str());
+                return 2;
+            }
+        }
+    }
+    return status;
+}